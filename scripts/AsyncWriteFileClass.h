@@ -0,0 +1,277 @@
+#ifndef TT_INCLUDE_ASYNCWRITEFILECLASS_H
+#define TT_INCLUDE_ASYNCWRITEFILECLASS_H
+
+#include "RawFileClass.h"
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// When opened for writing, writes are queued and written to disk in order by a background thread, so the writing thread
+// only waits on the disk when more than buffer_size * buffer_count bytes are queued.
+// Small writes are copied into buffer_size buffers. Write_Buffer hands over a whole buffer instead (ChunkSaveClass does
+// this with each top level chunk), so one that is bigger than the queue goes to disk while the next one is being built
+// rather than holding up the writing thread until most of it has been copied.
+// Any other mode behaves exactly like RawFileClass.
+// A failed background write makes every later Write return 0. Flush waits for everything queued so far and returns
+// false if anything failed; Close waits as well and the result stays available from Has_Failed until the next Open.
+class AsyncWriteFileClass : public RawFileClass
+{
+	static constexpr int DefaultBufferSize = 65536;
+	static constexpr int DefaultBufferCount = 4;
+	typedef std::vector<unsigned char> BufferType;
+	int BufferSize = DefaultBufferSize;
+	int BufferCount = DefaultBufferCount;
+	BufferType Current;           // buffer being filled by Write
+	std::vector<BufferType> Free; // written buffers kept around so their memory can be used again
+	std::deque<BufferType> Pending; // buffers waiting for the background thread, in file order
+	size_t PendingBytes = 0;      // bytes in Pending plus the buffer being written
+	bool Writing = false;         // background thread is writing a buffer it has taken off Pending
+	bool Stopping = false;
+	bool Failed = false;
+	int FileOffset = 0;
+	std::thread Writer;
+	std::mutex Mutex;
+	std::condition_variable Queued;   // a buffer was added to Pending or Stopping was set
+	std::condition_variable Released; // a buffer was written
+
+public:
+
+	AsyncWriteFileClass(const char* filename, int buffer_size = DefaultBufferSize, int buffer_count = DefaultBufferCount) : RawFileClass(filename), BufferSize(buffer_size), BufferCount(max(buffer_count, 2))
+	{
+	}
+
+	~AsyncWriteFileClass()
+	{
+		Close();
+	}
+
+private:
+
+	bool Is_Async()
+	{
+		return Writer.joinable();
+	}
+
+	void Write_Thread()
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		for (;;)
+		{
+			Queued.wait(lock, [this] { return !Pending.empty() || Stopping; });
+			if (Pending.empty())
+			{
+				return;
+			}
+			BufferType buffer = std::move(Pending.front());
+			Pending.pop_front();
+			Writing = true;
+			bool failed = Failed;
+			lock.unlock();
+			// NOTE: once something has failed the rest is dropped, it can't go anywhere sensible after a hole in the file
+			if (!failed)
+			{
+				failed = RawFileClass::Write(buffer.data(), (int)buffer.size()) != (int)buffer.size();
+			}
+			lock.lock();
+			Writing = false;
+			Failed |= failed;
+			PendingBytes -= buffer.size();
+			if ((int)Free.size() < BufferCount)
+			{
+				buffer.clear();
+				Free.push_back(std::move(buffer));
+			}
+			Released.notify_all();
+		}
+	}
+
+	// Moves buffer onto the queue once there is room for it and leaves an empty one in its place. Anything fits when
+	// the queue is empty, so a single buffer can be bigger than the limit.
+	bool Queue_Buffer(BufferType& buffer)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			size_t limit = (size_t)BufferSize * BufferCount;
+			Released.wait(lock, [&] { return !PendingBytes || PendingBytes + buffer.size() <= limit || Failed; });
+			if (Failed)
+			{
+				buffer.clear();
+				return false;
+			}
+			PendingBytes += buffer.size();
+			Pending.push_back(std::move(buffer));
+			buffer.clear();
+			if (!Free.empty())
+			{
+				buffer.swap(Free.back());
+				Free.pop_back();
+			}
+		}
+		Queued.notify_one();
+		return true;
+	}
+
+	void Start()
+	{
+		Current.clear();
+		Current.reserve(BufferSize);
+		Writer = std::thread(&AsyncWriteFileClass::Write_Thread, this);
+	}
+
+	void Stop()
+	{
+		Flush();
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			Stopping = true;
+		}
+		Queued.notify_one();
+		Writer.join();
+		Stopping = false;
+		Current.clear();
+		Free.clear();
+	}
+
+public:
+
+	int Open(const char* name, int mode = 1) final
+	{
+		Set_Name(name);
+		return Open(mode);
+	}
+	int Open(int mode = 1) final
+	{
+		int result = RawFileClass::Open(mode);
+		Failed = false;
+		FileOffset = 0;
+		if (result && (mode & 3) == OPEN_WRITE && !(mode & OPEN_OVERLAPPED_FLAG))
+		{
+			Start();
+		}
+		return result;
+	}
+
+	// Waits until everything written so far is on disk (or has failed). Returns false if any write failed.
+	bool Flush()
+	{
+		if (!Is_Async())
+		{
+			return !Failed;
+		}
+		if (!Current.empty())
+		{
+			Queue_Buffer(Current);
+		}
+		std::unique_lock<std::mutex> lock(Mutex);
+		Released.wait(lock, [this] { return Pending.empty() && !Writing; });
+		return !Failed;
+	}
+
+	bool Has_Failed() const
+	{
+		return Failed;
+	}
+
+	int Write(const void* buffer, int size) final
+	{
+		TT_ASSERT(size >= 0);
+		if (!Is_Async())
+		{
+			int result = RawFileClass::Write(buffer, size);
+			Failed |= result != size;
+			return result;
+		}
+
+		int result = 0;
+		while (size > 0)
+		{
+			if (Current.capacity() < (size_t)BufferSize)
+			{
+				Current.reserve(BufferSize);
+			}
+			int write_count = min(size, BufferSize - (int)Current.size());
+			Current.insert(Current.end(), (const unsigned char*)buffer, (const unsigned char*)buffer + write_count);
+			buffer = (const char*)buffer + write_count;
+			size -= write_count;
+			result += write_count;
+			if ((int)Current.size() == BufferSize && !Queue_Buffer(Current))
+			{
+				break;
+			}
+		}
+		FileOffset += result;
+		return result;
+	}
+
+	// Writes all of buffer, taking its contents instead of copying them when that is worth it. buffer is left empty
+	// (but not necessarily without memory) either way. Returns false if anything written so far has failed.
+	bool Write_Buffer(BufferType& buffer)
+	{
+		int size = (int)buffer.size();
+		if (!Is_Async() || size < BufferSize)
+		{
+			bool result = Write(buffer.data(), size) == size;
+			buffer.clear();
+			return result;
+		}
+		if (!Current.empty() && !Queue_Buffer(Current))
+		{
+			buffer.clear();
+			return false;
+		}
+		if (!Queue_Buffer(buffer))
+		{
+			return false;
+		}
+		FileOffset += size;
+		return true;
+	}
+
+	int Seek(int offset, int origin) final
+	{
+		if (!Is_Async())
+		{
+			return RawFileClass::Seek(offset, origin);
+		}
+		if (origin == ORIGIN_CURRENT && offset == 0)
+		{
+			return FileOffset;
+		}
+		// NOTE: anything other than appending has to wait for the queue to drain, nothing in the tools needs that on a hot path
+		Flush();
+		FileOffset = RawFileClass::Seek(offset, origin);
+		return FileOffset;
+	}
+
+	int Tell() final
+	{
+		if (!Is_Async())
+		{
+			return RawFileClass::Tell();
+		}
+		return FileOffset;
+	}
+
+	int Size() final
+	{
+		if (Is_Async())
+		{
+			Flush();
+		}
+		return RawFileClass::Size();
+	}
+
+	void Close() final
+	{
+		if (Is_Async())
+		{
+			Stop();
+		}
+		RawFileClass::Close();
+		FileOffset = 0;
+	}
+};
+
+#endif
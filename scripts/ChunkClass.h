@@ -1,8 +1,11 @@
 #ifndef TT_INCLUDE_CHUNKCLASS_H
 #define TT_INCLUDE_CHUNKCLASS_H
 #include "iostruct.h"
+#include "LZCompress.h"
+#include <vector>
 
 class FileClass;
+class AsyncWriteFileClass;
 class StringClass;
 
 struct ChunkHeader {
@@ -15,6 +18,17 @@ struct MicroChunkHeader {
 	unsigned char ChunkSize;
 };
 
+// A top level chunk saved with ChunkSaveClass::Set_Compressed is stored as a COMPRESSED_CHUNK_ID chunk holding a
+// CompressedChunkHeader followed by the original payload as an LZ block stream (see LZCompress.h).
+// Both loaders put the original chunk back when it is opened so nothing reading the file can tell the difference.
+#define COMPRESSED_CHUNK_ID 0x435A4C57
+
+struct CompressedChunkHeader {
+	unsigned long ChunkType; // of the chunk that was compressed
+	unsigned long ChunkSize;
+	unsigned long BlockSize;
+};
+
 class SCRIPTS_API ChunkLoadClass
 {
 	FileClass* File;
@@ -24,6 +38,10 @@ class SCRIPTS_API ChunkLoadClass
 	bool InMicroChunk;
 	int MicroChunkPosition;
 	MicroChunkHeader MCHeader;
+	LZBlockReaderClass Inflate; // active while a compressed top level chunk is open, reads go through it instead of File
+	bool Open_Compressed_Chunk();
+	int Read_Source(void *buf, unsigned long nbytes);
+	bool Skip_Source(unsigned long nbytes);
 public:
 	ChunkLoadClass(FileClass *file);
 	bool Open_Chunk();
@@ -56,21 +74,134 @@ public:
 	}
 };
 
+// Read only view of an array that lives in someone else's memory
+template<typename T> struct ChunkSpan
+{
+	const T* Data;
+	int Count;
+	const T* begin() const { return Data; }
+	const T* end() const { return Data + Count; }
+	const T& operator[](int i) const { return Data[i]; }
+	int Size() const { return Count; }
+	bool Empty() const { return !Count; }
+};
+
+// Same interface as ChunkLoadClass but walks chunks that are already in memory (e.g. a MappedFileClass) so payloads
+// can be looked at in place through Read_Data and the spans instead of being copied out.
+// The memory has to stay valid for as long as anything returned from here is in use.
+// A compressed top level chunk is decompressed into a buffer of its own when it's opened, anything pointing into it is
+// only valid until that chunk is closed.
+class SCRIPTS_API MappedChunkLoadClass
+{
+	const unsigned char* Data; // either Source or Inflated
+	unsigned long Size;
+	unsigned long Position; // offset in Data of the next byte to read
+	const unsigned char* Source;
+	unsigned long SourceSize;
+	std::vector<unsigned char> Inflated; // header and payload of the open compressed top level chunk
+	unsigned long CompressedOffset; // offset in Source of the open compressed chunk
+	unsigned long CompressedSize; // bytes it takes up there, header included
+	int StackIndex;
+	unsigned long PositionStack[256];
+	unsigned long StartStack[256]; // offset in Data of each open chunk's payload
+	ChunkHeader HeaderStack[256];
+	bool InMicroChunk;
+	int MicroChunkPosition;
+	MicroChunkHeader MCHeader;
+	bool Can_Read(unsigned long nbytes);
+	void Advance(unsigned long nbytes);
+	bool Open_Compressed_Chunk();
+public:
+	MappedChunkLoadClass(const void *data, unsigned long size);
+	bool Open_Chunk();
+	bool Peek_Next_Chunk(unsigned int *id, unsigned int *length);
+	bool Close_Chunk();
+	unsigned long Cur_Chunk_ID();
+	unsigned long Cur_Chunk_Length();
+	int Cur_Chunk_Depth();
+	int Contains_Chunks();
+	const void* Cur_Chunk_Data();
+	// True while the open top level chunk was compressed in the file.
+	bool Is_Compressed();
+	// Offset of the current chunk's header in the data, or in the decompressed top level chunk for chunks inside a
+	// compressed one. A compressed top level chunk itself gives its offset in the data.
+	unsigned long Cur_Chunk_Offset();
+	// Bytes the current chunk takes up where Cur_Chunk_Offset points, header included.
+	unsigned long Cur_Chunk_Stored_Size();
+	bool Open_Micro_Chunk();
+	bool Close_Micro_Chunk();
+	unsigned long Cur_Micro_Chunk_ID();
+	unsigned long Cur_Micro_Chunk_Length();
+	long Seek(unsigned long nbytes);
+	long Read(void *buf, unsigned long nbytes);
+	long Read(IOVector2Struct *v);
+	long Read(IOVector3Struct *v);
+	long Read(IOVector4Struct *v);
+	long Read(IOQuaternionStruct *q);
+	long Read(StringClass& string);
+
+	// Returns the next nbytes of the current chunk and skips over them, or nullptr if there aren't that many left.
+	const void* Read_Data(unsigned long nbytes);
+
+	template <typename T>
+	TT_INLINE std::enable_if_t<std::is_enum_v<T>, bool> Is_Cur_Chunk_ID(T id);
+
+	template<typename T> TT_INLINE long SimpleRead(T& buf)
+	{
+		int length = Read(&buf, sizeof(T));
+		TT_ASSERT(length == sizeof(T))
+		return length;
+	}
+
+	template<typename T> const T* Read_Struct()
+	{
+		return (const T*)Read_Data(sizeof(T));
+	}
+
+	template<typename T> ChunkSpan<T> Read_Span(int count)
+	{
+		const T* data = (const T*)Read_Data(count * sizeof(T));
+		return ChunkSpan<T> { data, data ? count : 0 };
+	}
+
+	// The whole payload of the current chunk viewed as an array of T, any partial element at the end is left off.
+	// Doesn't move the read position.
+	template<typename T> ChunkSpan<T> Cur_Chunk_Span()
+	{
+		return ChunkSpan<T> { (const T*)Cur_Chunk_Data(), (int)(Cur_Chunk_Length() / sizeof(T)) };
+	}
+};
+
+// Each top level chunk is built up in Buffer, where the headers are patched in place once their sizes are known,
+// and goes to the file in a single write when it ends. Nothing ever seeks the file.
 class SCRIPTS_API ChunkSaveClass {
 	FileClass* File;
+	AsyncWriteFileClass* AsyncFile; // File if it is one, finished top level chunks are then handed over instead of copied
 	int StackIndex;
-	int PositionStack[256];
+	int PositionStack[256]; // offsets of the open chunk headers in Buffer
 	ChunkHeader HeaderStack[256];
 	bool InMicroChunk;
 	int MicroChunkPosition;
 	MicroChunkHeader MCHeader;
+	std::vector<unsigned char> Buffer;
+	bool Compress; // compress the open top level chunk when it ends
+	std::vector<unsigned char> Packed;
 public:
 	ChunkSaveClass(FileClass *file);
+	ChunkSaveClass(AsyncWriteFileClass *file);
 	void Set_Contains_Chunks()
 	{
 		HeaderStack[StackIndex-1].ChunkSize |= 0x80000000;
 	}
 
+	// Stores the open top level chunk compressed unless that doesn't make it any smaller.
+	// Only readers built with this ChunkClass understand compressed chunks.
+	void Set_Compressed()
+	{
+		TT_ASSERT(StackIndex == 1);
+		Compress = StackIndex == 1;
+	}
+
 	template <typename T>
 	TT_INLINE std::enable_if_t<std::is_enum_v<T>, bool> Begin_Chunk(T id);
 
@@ -92,6 +223,27 @@ public:
 	unsigned long Write(const IOQuaternionStruct& q);
 	unsigned long Write(const StringClass& sting);
 
+	template<typename T, typename = std::enable_if_t<!std::is_pointer_v<T>>> // NOTE: never write pointers straight to disk! always use the pointer remapper!
+	unsigned long Write_Array(const T* values, int count)
+	{
+		return Write_Internal(values, count * sizeof(T));
+	}
+
+	// Appends a complete chunk, header included, that was saved separately (e.g. by a ChunkSaveClass writing to memory).
+	// Outside of any chunk it goes to the file right away, otherwise it becomes a child of the open chunk.
+	// chunk is left empty. Returns false if the write failed.
+	bool Write_Chunk(std::vector<unsigned char>& chunk);
+
+	// Appends nbytes to the current chunk and returns where they go so they can be filled in place.
+	// Only valid inside a chunk. The pointer is only valid until the next call that writes to this ChunkSaveClass.
+	void* Reserve(unsigned long nbytes);
+
+	template<typename T, typename = std::enable_if_t<!std::is_pointer_v<T>>>
+	T* Reserve_Array(int count)
+	{
+		return (T*)Reserve(count * sizeof(T));
+	}
+
 	template<typename T, typename = std::enable_if_t<!std::is_pointer_v<T>>> // NOTE: never write pointers straight to disk! always use the pointer remapper!
 	TT_INLINE long SimpleWrite(const T& buf)
 	{
@@ -102,6 +254,7 @@ public:
 
 private:
 	unsigned long Write_Internal(const void* buf, unsigned long nbytes);
+	bool Write_Top_Level(std::vector<unsigned char>& buffer); // writes buffer to File and leaves it empty
 };
 
 #include "ChunkClass.inl"
@@ -7,6 +7,12 @@ std::enable_if_t<std::is_enum_v<T>, bool> ChunkLoadClass::Is_Cur_Chunk_ID(T id)
 	return Cur_Chunk_ID() == enum_to_value(id);
 }
 
+template <typename T>
+std::enable_if_t<std::is_enum_v<T>, bool> MappedChunkLoadClass::Is_Cur_Chunk_ID(T id)
+{
+	return Cur_Chunk_ID() == enum_to_value(id);
+}
+
 template <typename T>
 std::enable_if_t<std::is_enum_v<T>, bool> ChunkSaveClass::Begin_Chunk(T id)
 {
@@ -1,5 +1,6 @@
 #include "General.h"
 #include "ChunkClass.h"
+#include "AsyncWriteFileClass.h"
 #include "fileclass.h"
 #include "engine_string.h"
 ChunkLoadClass::ChunkLoadClass(FileClass *file)
@@ -13,12 +14,58 @@ ChunkLoadClass::ChunkLoadClass(FileClass *file)
 	MCHeader.ChunkType = 0;
 }
 
+int ChunkLoadClass::Read_Source(void *buf, unsigned long nbytes)
+{
+	if (Inflate.Is_Active())
+	{
+		return Inflate.Read(buf,nbytes);
+	}
+	return File->Read(buf,nbytes);
+}
+
+bool ChunkLoadClass::Skip_Source(unsigned long nbytes)
+{
+	if (Inflate.Is_Active())
+	{
+		return Inflate.Skip(nbytes) == (int)nbytes;
+	}
+	int pos = File->Tell();
+	int seek = File->Seek(nbytes,1);
+	return (seek - pos) == (int)nbytes;
+}
+
+bool ChunkLoadClass::Open_Compressed_Chunk()
+{
+	CompressedChunkHeader header;
+	unsigned long size = HeaderStack[0].ChunkSize & 0x7FFFFFFF;
+	if ((size < sizeof(header)) || (File->Read(&header,sizeof(header)) != sizeof(header)))
+	{
+		return false;
+	}
+	if ((header.BlockSize == 0) || (header.BlockSize > LZ_MAX_BLOCK_SIZE))
+	{
+		return false;
+	}
+	HeaderStack[0].ChunkType = header.ChunkType;
+	HeaderStack[0].ChunkSize = header.ChunkSize;
+	Inflate.Begin(File,size - sizeof(header),header.ChunkSize & 0x7FFFFFFF,header.BlockSize);
+	return true;
+}
+
 bool ChunkLoadClass::Open_Chunk()
 {
+	if (StackIndex >= 256)
+	{
+		return false;
+	}
 	if ((StackIndex <= 0) || (PositionStack[StackIndex-1] != (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF)))
 	{
-		if (File->Read(&HeaderStack[StackIndex],8) == 8)
+		if (Read_Source(&HeaderStack[StackIndex],8) == 8)
 		{
+			if ((StackIndex == 0) && (HeaderStack[0].ChunkType == COMPRESSED_CHUNK_ID) && !Open_Compressed_Chunk())
+			{
+				return false;
+			}
 			PositionStack[StackIndex] = 0;
 			StackIndex++;
 			return true;
@@ -32,9 +79,25 @@ bool ChunkLoadClass::Peek_Next_Chunk(unsigned int *id, unsigned int *length)
 	ChunkHeader h;
 	if ((StackIndex <= 0) || (PositionStack[StackIndex-1] != (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF)))
 	{
-		if (File->Read(&h,8) == 8)
+		bool peeked = false;
+		if (Inflate.Is_Active())
+		{
+			peeked = Inflate.Peek(&h,8) == 8;
+		}
+		else if (File->Read(&h,8) == 8)
 		{
+			peeked = true;
+			CompressedChunkHeader header;
+			if ((StackIndex == 0) && (h.ChunkType == COMPRESSED_CHUNK_ID) && (File->Read(&header,sizeof(header)) == sizeof(header)))
+			{
+				File->Seek(-(int)sizeof(header),1);
+				h.ChunkType = header.ChunkType;
+				h.ChunkSize = header.ChunkSize;
+			}
 			File->Seek(-8,1);
+		}
+		if (peeked)
+		{
 			if (length)
 			{
 				*length = h.ChunkSize;
@@ -53,9 +116,14 @@ bool ChunkLoadClass::Close_Chunk()
 {
 	TT_ASSERT(!InMicroChunk);
 	unsigned int x = HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF;
-	if (PositionStack[StackIndex-1] < (x))
+	if ((StackIndex == 1) && Inflate.Is_Active())
+	{
+		// NOTE: whatever wasn't read of a compressed chunk is skipped in the file without decompressing it
+		Inflate.End();
+	}
+	else if (PositionStack[StackIndex-1] < (x))
 	{
-		File->Seek((x) - PositionStack[StackIndex-1],1);
+		Skip_Source((x) - PositionStack[StackIndex-1]);
 	}
 	StackIndex--;
 	if (StackIndex > 0)
@@ -103,7 +171,7 @@ bool ChunkLoadClass::Close_Micro_Chunk()
 	InMicroChunk = false;
 	if (MicroChunkPosition < MCHeader.ChunkSize)
 	{
-		File->Seek(MCHeader.ChunkSize - MicroChunkPosition,1);
+		Skip_Source(MCHeader.ChunkSize - MicroChunkPosition);
 		if (StackIndex > 0)
 		{
 			PositionStack[StackIndex-1] += MCHeader.ChunkSize - MicroChunkPosition;
@@ -129,9 +197,7 @@ long ChunkLoadClass::Seek(unsigned long nbytes)
 	{
 		if ((!InMicroChunk) || ((MicroChunkPosition + nbytes) <= MCHeader.ChunkSize))
 		{
-			int pos = File->Tell();
-			int seek = File->Seek(nbytes,1);
-			if ((seek - pos) == (int)nbytes)
+			if (Skip_Source(nbytes))
 			{
 				PositionStack[StackIndex-1] += nbytes;
 				if (InMicroChunk)
@@ -152,7 +218,7 @@ long ChunkLoadClass::Read(void *buf, unsigned long nbytes)
 	{
 		if ((!InMicroChunk) || ((MicroChunkPosition + nbytes) <= MCHeader.ChunkSize))
 		{
-			int read = File->Read(buf,nbytes);
+			int read = Read_Source(buf,nbytes);
 			if (read == (int)nbytes)
 			{
 				PositionStack[StackIndex-1] += nbytes;
@@ -197,15 +263,328 @@ long ChunkLoadClass::Read(StringClass& string)
 	return result;
 }
 
+MappedChunkLoadClass::MappedChunkLoadClass(const void *data, unsigned long size)
+{
+	Data = (const unsigned char *)data;
+	Size = size;
+	Position = 0;
+	Source = Data;
+	SourceSize = Size;
+	CompressedOffset = 0;
+	CompressedSize = 0;
+	StackIndex = 0;
+	memset(HeaderStack,0,sizeof(HeaderStack));
+	memset(PositionStack,0,sizeof(PositionStack));
+	memset(StartStack,0,sizeof(StartStack));
+	InMicroChunk = false;
+	MicroChunkPosition = 0;
+	MCHeader.ChunkType = 0;
+}
+
+bool MappedChunkLoadClass::Open_Compressed_Chunk()
+{
+	ChunkHeader h;
+	CompressedChunkHeader header;
+	memcpy(&h,Data + Position,8);
+	unsigned long stored = h.ChunkSize & 0x7FFFFFFF;
+	if (stored < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header,Data + Position + 8,sizeof(header));
+	unsigned long size = header.ChunkSize & 0x7FFFFFFF;
+	// NOTE: nothing decompresses to more than 255 times its size, don't allocate whatever a corrupt header asks for
+	if ((header.BlockSize == 0) || (header.BlockSize > LZ_MAX_BLOCK_SIZE) || (size > 0x7FFFFFFF - 8) || (size / 255 > stored))
+	{
+		return false;
+	}
+	// NOTE: the header goes back in front of the payload so everything past Open_Chunk works the same as for any other chunk
+	h.ChunkType = header.ChunkType;
+	h.ChunkSize = header.ChunkSize;
+	Inflated.resize(size + 8);
+	memcpy(Inflated.data(),&h,8);
+	if (!LZ_Decompress_Blocks(Data + Position + 8 + sizeof(header),stored - sizeof(header),header.BlockSize,Inflated.data() + 8,size))
+	{
+		Inflated.clear();
+		return false;
+	}
+	CompressedOffset = Position;
+	CompressedSize = stored + 8;
+	Data = Inflated.data();
+	Size = size + 8;
+	Position = 0;
+	return true;
+}
+
+bool MappedChunkLoadClass::Open_Chunk()
+{
+	if (StackIndex >= 256)
+	{
+		return false;
+	}
+	unsigned long left = Size - Position;
+	if (StackIndex > 0)
+	{
+		left = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) - PositionStack[StackIndex-1];
+	}
+	if (left < 8)
+	{
+		return false;
+	}
+	ChunkHeader h;
+	memcpy(&h,Data + Position,8);
+	// NOTE: a chunk that claims to be bigger than what contains it is truncated or corrupt, don't let anyone look past the end of it
+	if ((h.ChunkSize & 0x7FFFFFFF) > left - 8)
+	{
+		return false;
+	}
+	if ((StackIndex == 0) && (h.ChunkType == COMPRESSED_CHUNK_ID))
+	{
+		if (!Open_Compressed_Chunk())
+		{
+			return false;
+		}
+		memcpy(&h,Data,8);
+	}
+	HeaderStack[StackIndex] = h;
+	Position += 8;
+	StartStack[StackIndex] = Position;
+	PositionStack[StackIndex] = 0;
+	StackIndex++;
+	return true;
+}
+
+bool MappedChunkLoadClass::Peek_Next_Chunk(unsigned int *id, unsigned int *length)
+{
+	unsigned long left = Size - Position;
+	if (StackIndex > 0)
+	{
+		left = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) - PositionStack[StackIndex-1];
+	}
+	if (left < 8)
+	{
+		return false;
+	}
+	ChunkHeader h;
+	memcpy(&h,Data + Position,8);
+	CompressedChunkHeader header;
+	if ((StackIndex == 0) && (h.ChunkType == COMPRESSED_CHUNK_ID) && (left >= 8 + sizeof(header)))
+	{
+		memcpy(&header,Data + Position + 8,sizeof(header));
+		h.ChunkType = header.ChunkType;
+		h.ChunkSize = header.ChunkSize;
+	}
+	if (length)
+	{
+		*length = h.ChunkSize;
+	}
+	if (id)
+	{
+		*id = h.ChunkType & 0x7FFFFFFF;
+	}
+	return true;
+}
+
+bool MappedChunkLoadClass::Close_Chunk()
+{
+	TT_ASSERT(!InMicroChunk);
+	unsigned int x = HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF;
+	Position = StartStack[StackIndex-1] + x;
+	StackIndex--;
+	if ((StackIndex == 0) && (Data != Source))
+	{
+		Data = Source;
+		Size = SourceSize;
+		Position = CompressedOffset + CompressedSize;
+		Inflated.clear();
+	}
+	if (StackIndex > 0)
+	{
+		PositionStack[StackIndex-1] += (x);
+		PositionStack[StackIndex-1] += 8;
+	}
+	return true;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Chunk_ID()
+{
+	return HeaderStack[StackIndex-1].ChunkType;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Chunk_Length()
+{
+	return HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF;
+}
+
+int MappedChunkLoadClass::Cur_Chunk_Depth()
+{
+	return StackIndex;
+}
+
+int MappedChunkLoadClass::Contains_Chunks()
+{
+	return HeaderStack[StackIndex-1].ChunkSize & 0x80000000;
+}
+
+const void* MappedChunkLoadClass::Cur_Chunk_Data()
+{
+	return Data + StartStack[StackIndex-1];
+}
+
+bool MappedChunkLoadClass::Is_Compressed()
+{
+	return Data != Source;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Chunk_Offset()
+{
+	if ((StackIndex == 1) && Is_Compressed())
+	{
+		return CompressedOffset;
+	}
+	return StartStack[StackIndex-1] - 8;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Chunk_Stored_Size()
+{
+	if ((StackIndex == 1) && Is_Compressed())
+	{
+		return CompressedSize;
+	}
+	return Cur_Chunk_Length() + 8;
+}
+
+bool MappedChunkLoadClass::Open_Micro_Chunk()
+{
+	int bytesread = Read(&MCHeader,sizeof(MCHeader));
+	if (bytesread == sizeof(MCHeader))
+	{
+		MicroChunkPosition = 0;
+		InMicroChunk = true;
+		return true;
+	}
+	return false;
+}
+
+bool MappedChunkLoadClass::Close_Micro_Chunk()
+{
+	InMicroChunk = false;
+	if (MicroChunkPosition < MCHeader.ChunkSize)
+	{
+		unsigned long skip = MCHeader.ChunkSize - MicroChunkPosition;
+		unsigned long left = Cur_Chunk_Length() - PositionStack[StackIndex-1];
+		Advance(skip < left ? skip : left);
+	}
+	return true;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Micro_Chunk_ID()
+{
+	return MCHeader.ChunkType;
+}
+
+unsigned long MappedChunkLoadClass::Cur_Micro_Chunk_Length()
+{
+	return MCHeader.ChunkSize;
+}
+
+bool MappedChunkLoadClass::Can_Read(unsigned long nbytes)
+{
+	if ((StackIndex > 0) && (nbytes <= (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) - PositionStack[StackIndex-1]))
+	{
+		return (!InMicroChunk) || ((MicroChunkPosition + nbytes) <= MCHeader.ChunkSize);
+	}
+	return false;
+}
+
+void MappedChunkLoadClass::Advance(unsigned long nbytes)
+{
+	Position += nbytes;
+	PositionStack[StackIndex-1] += nbytes;
+	if (InMicroChunk)
+	{
+		MicroChunkPosition += nbytes;
+	}
+}
+
+long MappedChunkLoadClass::Seek(unsigned long nbytes)
+{
+	if (Can_Read(nbytes))
+	{
+		Advance(nbytes);
+		return nbytes;
+	}
+	return 0;
+}
+
+long MappedChunkLoadClass::Read(void *buf, unsigned long nbytes)
+{
+	if (Can_Read(nbytes))
+	{
+		memcpy(buf,Data + Position,nbytes);
+		Advance(nbytes);
+		return nbytes;
+	}
+	return 0;
+}
+
+const void* MappedChunkLoadClass::Read_Data(unsigned long nbytes)
+{
+	if (Can_Read(nbytes))
+	{
+		const void *data = Data + Position;
+		Advance(nbytes);
+		return data;
+	}
+	return nullptr;
+}
+
+long MappedChunkLoadClass::Read(IOVector2Struct *v)
+{
+	return Read(v,sizeof(IOVector2Struct));
+}
+
+long MappedChunkLoadClass::Read(IOVector3Struct *v)
+{
+	return Read(v,sizeof(IOVector3Struct));
+}
+
+long MappedChunkLoadClass::Read(IOVector4Struct *v)
+{
+	return Read(v,sizeof(IOVector4Struct));
+}
+
+long MappedChunkLoadClass::Read(IOQuaternionStruct *q)
+{
+	return Read(q,sizeof(IOQuaternionStruct));
+}
+
+long MappedChunkLoadClass::Read(StringClass& string)
+{
+	uint16 length;
+	int result = SimpleRead(length);
+	result += Read(string.Get_Buffer(length+1), length);
+	string[length] = '\0';
+	TT_ASSERT(result == (int)sizeof(uint16) + (int)length);
+	return result;
+}
+
 ChunkSaveClass::ChunkSaveClass(FileClass *file)
 {
 	File = file;
+	AsyncFile = nullptr;
 	StackIndex = 0;
 	memset(HeaderStack,0,sizeof(HeaderStack));
 	memset(PositionStack,0,sizeof(PositionStack));
 	InMicroChunk = false;
 	MicroChunkPosition = 0;
 	MCHeader.ChunkType = 0;
+	Compress = false;
+}
+
+ChunkSaveClass::ChunkSaveClass(AsyncWriteFileClass *file) : ChunkSaveClass((FileClass *)file)
+{
+	AsyncFile = file;
 }
 
 bool ChunkSaveClass::Begin_Chunk(unsigned long id)
@@ -218,40 +597,79 @@ bool ChunkSaveClass::Begin_Chunk(unsigned long id)
 	}
 	chunkh.ChunkType = id;
 	chunkh.ChunkSize &= 0x80000000;
-	PositionStack[StackIndex] = File->Seek(0,1);
+	PositionStack[StackIndex] = (int)Buffer.size();
 	HeaderStack[StackIndex].ChunkType = chunkh.ChunkType;
 	HeaderStack[StackIndex].ChunkSize = chunkh.ChunkSize;
 	StackIndex++;
-	if (File->Write(&chunkh,sizeof(chunkh)) == sizeof(chunkh))
-	{
-		return true;
-	}
-	return false;
+	Buffer.insert(Buffer.end(), (unsigned char*)&chunkh, (unsigned char*)&chunkh + sizeof(chunkh));
+	return true;
 }
 
 bool ChunkSaveClass::End_Chunk()
 {
 	ChunkHeader chunkh;
-	int temp = File->Seek(0,1);
 	StackIndex--;
 	chunkh.ChunkType = HeaderStack[StackIndex].ChunkType;
 	chunkh.ChunkSize = HeaderStack[StackIndex].ChunkSize;
-	File->Seek(PositionStack[StackIndex],0);
-	if (File->Write(&chunkh,sizeof(chunkh)) == sizeof(chunkh))
+	memcpy(&Buffer[PositionStack[StackIndex]], &chunkh, sizeof(chunkh));
+	if ((StackIndex) && (StackIndex < 256))
 	{
-		if ((StackIndex) && (StackIndex < 256))
+		int temp2 = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) + (chunkh.ChunkSize & 0x7FFFFFFF) + 8;
+		if (HeaderStack[StackIndex-1].ChunkSize & 0x80000000)
 		{
-			int temp2 = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) + (chunkh.ChunkSize & 0x7FFFFFFF) + 8;
-			if (HeaderStack[StackIndex-1].ChunkSize & 0x80000000)
-			{
-				temp2 |= 0x80000000;
-			}
-			HeaderStack[StackIndex-1].ChunkSize = temp2;
+			temp2 |= 0x80000000;
 		}
-		File->Seek(temp,0);
+		HeaderStack[StackIndex-1].ChunkSize = temp2;
 		return true;
 	}
-	return false;
+	if (Compress)
+	{
+		Compress = false;
+		CompressedChunkHeader header;
+		header.ChunkType = chunkh.ChunkType;
+		header.ChunkSize = chunkh.ChunkSize;
+		header.BlockSize = LZ_BLOCK_SIZE;
+		Packed.resize(sizeof(ChunkHeader) + sizeof(header));
+		LZ_Compress_Blocks(Buffer.data() + sizeof(ChunkHeader), (int)Buffer.size() - (int)sizeof(ChunkHeader), LZ_BLOCK_SIZE, Packed);
+		if (Packed.size() < Buffer.size())
+		{
+			ChunkHeader envelope;
+			envelope.ChunkType = COMPRESSED_CHUNK_ID;
+			envelope.ChunkSize = (unsigned long)Packed.size() - sizeof(ChunkHeader);
+			memcpy(Packed.data(), &envelope, sizeof(envelope));
+			memcpy(Packed.data() + sizeof(envelope), &header, sizeof(header));
+			Buffer.swap(Packed);
+		}
+		Packed.clear();
+	}
+	return Write_Top_Level(Buffer);
+}
+
+bool ChunkSaveClass::Write_Chunk(std::vector<unsigned char>& chunk)
+{
+	TT_ASSERT(chunk.size() >= sizeof(ChunkHeader));
+	TT_ASSERT(!InMicroChunk);
+	if (StackIndex > 0)
+	{
+		Set_Contains_Chunks();
+		bool result = Write_Internal(chunk.data(), (unsigned long)chunk.size()) == chunk.size();
+		chunk.clear();
+		return result;
+	}
+	return Write_Top_Level(chunk);
+}
+
+bool ChunkSaveClass::Write_Top_Level(std::vector<unsigned char>& buffer)
+{
+	TT_ASSERT(StackIndex == 0);
+	if (AsyncFile)
+	{
+		return AsyncFile->Write_Buffer(buffer);
+	}
+	int size = (int)buffer.size();
+	bool result = File->Write(buffer.data(), size) == size;
+	buffer.clear();
+	return result;
 }
 
 int ChunkSaveClass::Cur_Chunk_Depth()
@@ -266,8 +684,9 @@ unsigned int ChunkSaveClass::Cur_Chunk_Length()
 
 bool ChunkSaveClass::Begin_Micro_Chunk(unsigned long id)
 {
+	TT_ASSERT(StackIndex > 0);
 	MCHeader.ChunkType = (unsigned char)id;
-	MicroChunkPosition = File->Seek(0,1);
+	MicroChunkPosition = (int)Buffer.size();
 	MCHeader.ChunkSize = 0;
 	if (Write(&MCHeader,sizeof(MCHeader)) == sizeof(MCHeader))
 	{
@@ -280,36 +699,42 @@ bool ChunkSaveClass::Begin_Micro_Chunk(unsigned long id)
 bool ChunkSaveClass::End_Micro_Chunk()
 {
 	TT_ASSERT(InMicroChunk);
-	int temp = File->Seek(0,1);
-	File->Seek(MicroChunkPosition,0);
-	if (File->Write(&MCHeader,sizeof(MCHeader)) == sizeof(MCHeader))
+	memcpy(&Buffer[MicroChunkPosition], &MCHeader, sizeof(MCHeader));
+	InMicroChunk = false;
+	return true;
+}
+
+void* ChunkSaveClass::Reserve(unsigned long nbytes)
+{
+	TT_ASSERT(File->Is_Open());
+	TT_ASSERT(StackIndex > 0);
+	size_t pos = Buffer.size();
+	Buffer.resize(pos + nbytes);
+	int temp = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) + nbytes;
+	if (HeaderStack[StackIndex-1].ChunkSize & 0x80000000)
 	{
-		File->Seek(temp,0);
-		InMicroChunk = false;
-		return true;
+		temp |= 0x80000000;
 	}
-	return false;
+	HeaderStack[StackIndex-1].ChunkSize = temp;
+	if (InMicroChunk)
+	{
+		TT_ASSERT(((unsigned long)MCHeader.ChunkSize + nbytes) <= (unsigned long)UINT8_MAX);
+		MCHeader.ChunkSize = MCHeader.ChunkSize + (unsigned char)nbytes;
+	}
+	return Buffer.data() + pos;
 }
 
 unsigned long ChunkSaveClass::Write_Internal(const void* buf,unsigned long nbytes)
 {
-	TT_ASSERT(File->Is_Open());
-	if (File->Write(buf,nbytes) == (int)nbytes)
+	if (!StackIndex)
 	{
-		int temp = (HeaderStack[StackIndex-1].ChunkSize & 0x7FFFFFFF) + nbytes;
-		if (HeaderStack[StackIndex-1].ChunkSize & 0x80000000)
-		{
-			temp |= 0x80000000;
-		}
-		HeaderStack[StackIndex-1].ChunkSize = temp;
-		if (InMicroChunk)
-		{
-			TT_ASSERT(((unsigned long)MCHeader.ChunkSize + nbytes) <= (unsigned long)UINT8_MAX);
-			MCHeader.ChunkSize = MCHeader.ChunkSize + (unsigned char)nbytes;
-		}
-		return nbytes;
+		// NOTE: Buffer is empty between top level chunks, so bytes written outside of any chunk can go straight to the file
+		TT_ASSERT(Buffer.empty());
+		int result = File->Write(buf, (int)nbytes);
+		return result > 0 ? (unsigned long)result : 0;
 	}
-	return 0;
+	memcpy(Reserve(nbytes), buf, nbytes);
+	return nbytes;
 }
 
 unsigned long ChunkSaveClass::Write(const IOVector2Struct& v)
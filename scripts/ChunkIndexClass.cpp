@@ -0,0 +1,533 @@
+#include "General.h"
+#include "ChunkIndexClass.h"
+#include "ChunkClass.h"
+#include "MappedFileClass.h"
+#include "RawFileClass.h"
+#include "HashTemplateKeyClass.h"
+#include "w3d.h"
+#include "w3dobsolete.h"
+
+enum
+{
+	CHUNKID_INDEX_HEADER = 0x100,
+	CHUNKID_INDEX_ENTRIES,
+	CHUNKID_INDEX_NAMES,
+};
+
+#define CHUNK_INDEX_VERSION 3
+
+struct ChunkIndexHeaderStruct
+{
+	uint32 Version;
+	uint32 SourceSize;
+	uint64 SourceTime;
+	uint32 EntryCount;
+	uint32 NameCount;
+};
+
+static bool Get_Source_Info(const char *filename, uint32 &size, uint64 &time)
+{
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &info) || info.nFileSizeHigh)
+	{
+		return false;
+	}
+	size = info.nFileSizeLow;
+	time = ((uint64)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+bool ChunkIndexClass::Is_Container(uint32 id)
+{
+	switch (id)
+	{
+	case W3D_CHUNK_MESH:
+	case W3D_CHUNK_DAMAGE:
+	case W3D_CHUNK_MATERIALS3:
+	case W3D_CHUNK_MATERIAL3:
+	case W3D_CHUNK_MATERIAL3_DC_MAP:
+	case W3D_CHUNK_MATERIAL3_DI_MAP:
+	case W3D_CHUNK_MATERIAL3_SC_MAP:
+	case W3D_CHUNK_MATERIAL3_SI_MAP:
+	case W3D_CHUNK_PRELIT_UNLIT:
+	case W3D_CHUNK_PRELIT_VERTEX:
+	case W3D_CHUNK_PRELIT_LIGHTMAP_MULTI_PASS:
+	case W3D_CHUNK_PRELIT_LIGHTMAP_MULTI_TEXTURE:
+	case W3D_CHUNK_VERTEX_MATERIALS:
+	case W3D_CHUNK_VERTEX_MATERIAL:
+	case W3D_CHUNK_TEXTURES:
+	case W3D_CHUNK_TEXTURE:
+	case W3D_CHUNK_MATERIAL_PASS:
+	case W3D_CHUNK_TEXTURE_STAGE:
+	case W3D_CHUNK_FX_SHADERS:
+	case W3D_CHUNK_FX_SHADER:
+	case W3D_CHUNK_AABTREE:
+	case W3D_CHUNK_BONE_PALETTES:
+	case W3D_CHUNK_SHDMESH:
+	case W3D_CHUNK_SHDSUBMESH:
+	case W3D_CHUNK_SHDSUBMESH_SHADER:
+	case W3D_CHUNK_HIERARCHY:
+	case W3D_CHUNK_ANIMATION:
+	case W3D_CHUNK_COMPRESSED_ANIMATION:
+	case W3D_CHUNK_MORPH_ANIMATION:
+	case W3D_CHUNK_MORPHANIM_CHANNEL:
+	case W3D_CHUNK_HMODEL:
+	case W3D_CHUNK_LODMODEL:
+	case W3D_CHUNK_COLLECTION:
+	case W3D_CHUNK_LIGHT:
+	case W3D_CHUNK_EMITTER:
+	case W3D_CHUNK_AGGREGATE:
+	case W3D_CHUNK_HLOD:
+	case W3D_CHUNK_HLOD_LOD_ARRAY:
+	case W3D_CHUNK_HLOD_AGGREGATE_ARRAY:
+	case W3D_CHUNK_HLOD_PROXY_ARRAY:
+	case W3D_CHUNK_RING:
+	case W3D_CHUNK_SPHERE:
+	case W3D_CHUNK_LIGHTSCAPE:
+	case W3D_CHUNK_LIGHTSCAPE_LIGHT:
+	case W3D_CHUNK_DAZZLE:
+	case W3D_CHUNK_SOUNDROBJ:
+		return true;
+	}
+	return false;
+}
+
+// Names in W3D structs are fixed size and not always null terminated
+template<int N> static StringView Fixed_Name(const char (&name)[N])
+{
+	return StringView(name, strnlen(name, N));
+}
+
+static StringClass Qualified_Name(const StringView &prefix, const StringView &name)
+{
+	StringClass str(prefix);
+	if (!str.Is_Empty())
+	{
+		str += ".";
+	}
+	str += StringClass(name);
+	return str;
+}
+
+void ChunkIndexClass::Reset()
+{
+	Entries.clear();
+	Names.clear();
+	NameMap.clear();
+	SourceSize = 0;
+	SourceTime = 0;
+}
+
+void ChunkIndexClass::Add_Name(int entry, const StringClass &name)
+{
+	if (name.Is_Empty() || Entries[entry].Name >= 0)
+	{
+		return;
+	}
+	Entries[entry].Name = (int)Names.size();
+	Names.push_back(name);
+	NameMap.emplace(name, entry);
+}
+
+void ChunkIndexClass::Add_Header_Name(MappedChunkLoadClass &cload, int entry)
+{
+	// NOTE: boxes and null objects are named by their own chunk, everything else by a header chunk inside the object
+	if (Entries[entry].ID == W3D_CHUNK_BOX)
+	{
+		if (auto box = cload.Cur_Chunk_Span<W3dBoxStruct>(); box.Size())
+		{
+			Add_Name(entry, Fixed_Name(box[0].Name));
+		}
+		return;
+	}
+	if (Entries[entry].ID == W3D_CHUNK_NULL_OBJECT)
+	{
+		if (auto object = cload.Cur_Chunk_Span<W3dNullObjectStruct>(); object.Size())
+		{
+			Add_Name(entry, Fixed_Name(object[0].Name));
+		}
+		return;
+	}
+	int parent = Entries[entry].Parent;
+	if (parent < 0)
+	{
+		return;
+	}
+	switch (Entries[entry].ID)
+	{
+	case W3D_CHUNK_MESH_HEADER3:
+		if (auto header = cload.Cur_Chunk_Span<W3dMeshHeader3Struct>(); header.Size())
+		{
+			Add_Name(parent, Qualified_Name(Fixed_Name(header[0].ContainerName), Fixed_Name(header[0].MeshName)));
+		}
+		break;
+	case W3D_CHUNK_HIERARCHY_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dHierarchyStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_ANIMATION_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dAnimHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Qualified_Name(Fixed_Name(header[0].HierarchyName), Fixed_Name(header[0].Name)));
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_ANIMATION_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dCompressedAnimHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Qualified_Name(Fixed_Name(header[0].HierarchyName), Fixed_Name(header[0].Name)));
+		}
+		break;
+	case W3D_CHUNK_MORPHANIM_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dMorphAnimHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Qualified_Name(Fixed_Name(header[0].HierarchyName), Fixed_Name(header[0].Name)));
+		}
+		break;
+	case W3D_CHUNK_HMODEL_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dHModelHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_HLOD_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dHLodHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_COLLECTION_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dCollectionHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_EMITTER_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dEmitterHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_AGGREGATE_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dAggregateHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_SOUNDROBJ_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dSoundRObjHeaderStruct>(); header.Size())
+		{
+			Add_Name(parent, Fixed_Name(header[0].Name));
+		}
+		break;
+	case W3D_CHUNK_DAZZLE_NAME:
+		if (auto name = cload.Cur_Chunk_Span<char>(); name.Size())
+		{
+			Add_Name(parent, StringView(name.begin(), strnlen(name.begin(), name.Size())));
+		}
+		break;
+	case 1:
+		// NOTE: rings and spheres keep their definition in a chunk with id 1
+		if (Entries[parent].ID == W3D_CHUNK_RING)
+		{
+			if (auto ring = cload.Cur_Chunk_Span<W3dRingStruct>(); ring.Size())
+			{
+				Add_Name(parent, Fixed_Name(ring[0].Name));
+			}
+		}
+		else if (Entries[parent].ID == W3D_CHUNK_SPHERE)
+		{
+			if (auto sphere = cload.Cur_Chunk_Span<W3dSphereStruct>(); sphere.Size())
+			{
+				Add_Name(parent, Fixed_Name(sphere[0].Name));
+			}
+		}
+		break;
+	}
+}
+
+// NOTE: hashes are taken from what the loader hands out, so a chunk hashes the same whether or not it was stored compressed
+uint64 ChunkIndexClass::Hash_Children(const unsigned char *payload, int parent)
+{
+	const ChunkIndexEntry &entry = Entries[parent];
+	std::vector<uint64> hashes;
+	uint64 header;
+	memcpy(&header, payload - 8, sizeof(header));
+	hashes.push_back(header);
+	uint32 end = 0;
+	for (int i = First_Child(parent); i >= 0; i = Next_Sibling(i))
+	{
+		hashes.push_back(Entries[i].Hash);
+		end += Entries[i].Length + 8;
+	}
+	// NOTE: anything after the last chunk that isn't a chunk itself still has to count
+	if (end < entry.Length)
+	{
+		hashes.push_back(LargeByteHashFunc64(payload + end, entry.Length - end));
+	}
+	return LargeByteHashFunc64((const byte *)hashes.data(), hashes.size() * sizeof(uint64));
+}
+
+void ChunkIndexClass::Add_Chunks(MappedChunkLoadClass &cload, int parent)
+{
+	while (cload.Open_Chunk())
+	{
+		int index = (int)Entries.size();
+		const unsigned char *payload = (const unsigned char *)cload.Cur_Chunk_Data();
+		ChunkIndexEntry entry = {};
+		entry.ID = cload.Cur_Chunk_ID();
+		entry.Length = cload.Cur_Chunk_Length();
+		entry.Offset = cload.Cur_Chunk_Offset();
+		entry.Stored = cload.Cur_Chunk_Stored_Size();
+		entry.Depth = cload.Cur_Chunk_Depth() - 1;
+		entry.Parent = parent;
+		entry.Name = -1;
+		Entries.push_back(entry);
+		if (cload.Contains_Chunks() || Is_Container(entry.ID))
+		{
+			Add_Chunks(cload, index);
+			Entries[index].Hash = Hash_Children(payload, index);
+		}
+		else
+		{
+			Entries[index].Hash = LargeByteHashFunc64(payload - 8, entry.Length + 8);
+			Add_Header_Name(cload, index);
+		}
+		cload.Close_Chunk();
+	}
+}
+
+void ChunkIndexClass::Build(const void *data, unsigned long size)
+{
+	Reset();
+	SourceSize = size;
+	MappedChunkLoadClass cload(data, size);
+	Add_Chunks(cload, -1);
+}
+
+StringClass ChunkIndexClass::Get_Index_Filename(const char *filename)
+{
+	StringClass str = filename;
+	str += ".cidx";
+	return str;
+}
+
+bool ChunkIndexClass::Save(const char *filename)
+{
+	ChunkIndexHeaderStruct header;
+	header.Version = CHUNK_INDEX_VERSION;
+	if (!Get_Source_Info(filename, header.SourceSize, header.SourceTime) || header.SourceSize != SourceSize)
+	{
+		return false;
+	}
+	header.EntryCount = (uint32)Entries.size();
+	header.NameCount = (uint32)Names.size();
+	RawFileClass file(Get_Index_Filename(filename));
+	if (!file.Open(2))
+	{
+		return false;
+	}
+	ChunkSaveClass csave(&file);
+	unsigned long entrysize = (unsigned long)(Entries.size() * sizeof(ChunkIndexEntry));
+	bool result = csave.Begin_Chunk(CHUNKID_INDEX_HEADER) && csave.SimpleWrite(header) == (long)sizeof(header) && csave.End_Chunk()
+		&& csave.Begin_Chunk(CHUNKID_INDEX_ENTRIES) && csave.Write_Array(Entries.data(), (int)Entries.size()) == entrysize && csave.End_Chunk()
+		&& csave.Begin_Chunk(CHUNKID_INDEX_NAMES);
+	for (size_t i = 0; result && i < Names.size(); i++)
+	{
+		result = csave.Write(Names[i]) == sizeof(uint16) + (unsigned long)Names[i].Get_Length();
+	}
+	result = result && csave.End_Chunk();
+	if (!result)
+	{
+		// a partial index would only be thrown away by Load, don't leave it lying around
+		file.Delete();
+		return false;
+	}
+	file.Close();
+	SourceTime = header.SourceTime;
+	return true;
+}
+
+bool ChunkIndexClass::Load(const char *filename)
+{
+	Reset();
+	uint32 size;
+	uint64 time;
+	if (!Get_Source_Info(filename, size, time))
+	{
+		return false;
+	}
+	MappedFileClass file(Get_Index_Filename(filename));
+	MappedChunkLoadClass cload(file.Get_Data(), file.Get_Size());
+	const ChunkIndexHeaderStruct *header = nullptr;
+	while (cload.Open_Chunk())
+	{
+		switch (cload.Cur_Chunk_ID())
+		{
+		case CHUNKID_INDEX_HEADER:
+			header = cload.Read_Struct<ChunkIndexHeaderStruct>();
+			if (!header || header->Version != CHUNK_INDEX_VERSION || header->SourceSize != size || header->SourceTime != time)
+			{
+				Reset();
+				return false;
+			}
+			break;
+		case CHUNKID_INDEX_ENTRIES:
+			if (header)
+			{
+				ChunkSpan<ChunkIndexEntry> entries = cload.Read_Span<ChunkIndexEntry>(header->EntryCount);
+				Entries.assign(entries.begin(), entries.end());
+			}
+			break;
+		case CHUNKID_INDEX_NAMES:
+			if (header)
+			{
+				for (uint32 i = 0; i < header->NameCount; i++)
+				{
+					StringClass name;
+					cload.Read(name);
+					Names.push_back(name);
+				}
+			}
+			break;
+		}
+		cload.Close_Chunk();
+	}
+	if (!header || Entries.size() != header->EntryCount || Names.size() != header->NameCount)
+	{
+		Reset();
+		return false;
+	}
+	// NOTE: don't trust anything in the index that could send a lookup out of bounds
+	for (int i = 0; i < (int)Entries.size(); i++)
+	{
+		const ChunkIndexEntry &entry = Entries[i];
+		if (entry.Parent >= i || entry.Parent < -1 || entry.Name >= (int)Names.size())
+		{
+			Reset();
+			return false;
+		}
+		// NOTE: chunks inside a compressed chunk are bounded by its decompressed size rather than the file
+		int top = Get_Top_Level(i);
+		uint64 limit = size;
+		if (top != i)
+		{
+			if (entry.Stored != (uint64)entry.Length + 8)
+			{
+				Reset();
+				return false;
+			}
+			if (Is_Compressed(top))
+			{
+				limit = (uint64)Entries[top].Length + 8;
+			}
+		}
+		if ((uint64)entry.Offset + entry.Stored > limit)
+		{
+			Reset();
+			return false;
+		}
+		if (entry.Name >= 0)
+		{
+			NameMap.emplace(Names[entry.Name], i);
+		}
+	}
+	SourceSize = size;
+	SourceTime = time;
+	return true;
+}
+
+void ChunkIndexClass::Load_Or_Build(const char *filename, const void *data, unsigned long size)
+{
+	if (!Load(filename) || SourceSize != size)
+	{
+		Build(data, size);
+		Save(filename);
+	}
+}
+
+int ChunkIndexClass::Get_Top_Level(int index) const
+{
+	while (Entries[index].Parent >= 0)
+	{
+		index = Entries[index].Parent;
+	}
+	return index;
+}
+
+bool ChunkIndexClass::Is_Compressed(int index) const
+{
+	const ChunkIndexEntry &top = Entries[Get_Top_Level(index)];
+	return top.Stored != (uint64)top.Length + 8;
+}
+
+int ChunkIndexClass::Find_Name(const char *name) const
+{
+	auto iter = NameMap.find(StringClass(name));
+	if (iter == NameMap.end())
+	{
+		return -1;
+	}
+	return iter->second;
+}
+
+int ChunkIndexClass::Find_Path(const uint32 *path, int count, int after) const
+{
+	for (int i = after + 1; i < (int)Entries.size(); i++)
+	{
+		if (Entries[i].Depth != count - 1)
+		{
+			continue;
+		}
+		int entry = i;
+		int level = count - 1;
+		while (entry >= 0 && Entries[entry].ID == path[level])
+		{
+			entry = Entries[entry].Parent;
+			level--;
+		}
+		if (level < 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+int ChunkIndexClass::Find_Child(int parent, uint32 id, int after) const
+{
+	int depth = parent >= 0 ? Entries[parent].Depth : -1;
+	for (int i = (after > parent ? after : parent) + 1; i < (int)Entries.size() && Entries[i].Depth > depth; i++)
+	{
+		if (Entries[i].Parent == parent && Entries[i].ID == id)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+int ChunkIndexClass::First_Child(int parent) const
+{
+	int first = parent + 1;
+	if (first < (int)Entries.size() && Entries[first].Parent == parent)
+	{
+		return first;
+	}
+	return -1;
+}
+
+int ChunkIndexClass::Next_Sibling(int index) const
+{
+	int next = index + 1;
+	while (next < (int)Entries.size() && Entries[next].Depth > Entries[index].Depth)
+	{
+		next++;
+	}
+	if (next < (int)Entries.size() && Entries[next].Parent == Entries[index].Parent)
+	{
+		return next;
+	}
+	return -1;
+}
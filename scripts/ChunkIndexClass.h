@@ -0,0 +1,68 @@
+#pragma once
+#include "engine_string.h"
+#include <vector>
+#include <unordered_map>
+
+class MappedChunkLoadClass;
+
+struct ChunkIndexEntry
+{
+	uint32 ID;
+	uint32 Length; // payload length, not including the 8 byte header
+	uint32 Offset; // offset of the chunk header in the file, or in the decompressed top level chunk for chunks inside a compressed one
+	uint32 Stored; // bytes the chunk takes up at Offset, only differs from Length + 8 for compressed top level chunks
+	int Depth; // 0 for top level chunks
+	int Parent; // index of the containing chunk or -1
+	int Name; // index into the name table or -1
+	uint32 Reserved; // always 0, spells out the padding before Hash so saved indexes don't pick up whatever was in memory
+	uint64 Hash; // xxHash of the header and payload, chunks that contain other chunks hash the hashes of their children instead
+	uint32 Payload_Offset() const { return Offset + 8; }
+};
+
+// Table of every chunk in a file and the object names found in their header chunks so a single asset can be found
+// (and handed to a MappedChunkLoadClass over just that chunk) without walking the whole file.
+// Entries are in file order so a chunk's children always come after it and before its next sibling.
+// Each entry also has a hash of the chunk and everything in it, so two files can be compared a subtree at a time.
+class SCRIPTS_API ChunkIndexClass
+{
+	std::vector<ChunkIndexEntry> Entries;
+	std::vector<StringClass> Names;
+	std::unordered_map<StringClass, int, hash_istring, equals_istring> NameMap; // name -> first entry with that name
+	uint32 SourceSize;
+	uint64 SourceTime;
+	void Add_Name(int entry, const StringClass &name);
+	void Add_Header_Name(MappedChunkLoadClass &cload, int entry);
+	void Add_Chunks(MappedChunkLoadClass &cload, int parent);
+	uint64 Hash_Children(const unsigned char *payload, int parent);
+public:
+	ChunkIndexClass() : SourceSize(0), SourceTime(0) {}
+	void Reset();
+	// Indexes a whole file that is already in memory. Knows which W3D chunks contain other chunks and where their names are.
+	void Build(const void *data, unsigned long size);
+	// Saves to / loads from Get_Index_Filename(filename). Load fails if the index is missing or filename has changed since it was saved.
+	bool Save(const char *filename);
+	bool Load(const char *filename);
+	// Load if there is an up to date index, otherwise build it from data and save it for next time.
+	void Load_Or_Build(const char *filename, const void *data, unsigned long size);
+	static StringClass Get_Index_Filename(const char *filename);
+	// W3D doesn't reliably set the contains chunks bit so the chunks that hold other chunks have to be known up front
+	static bool Is_Container(uint32 id);
+
+	int Count() const { return (int)Entries.size(); }
+	const ChunkIndexEntry &Get(int index) const { return Entries[index]; }
+	const char *Get_Name(int index) const { return Entries[index].Name >= 0 ? Names[Entries[index].Name].Peek_Buffer() : nullptr; }
+	// Returns the top level chunk holding index (or index itself).
+	int Get_Top_Level(int index) const;
+	// True if index is a compressed top level chunk or inside one, its Offset then can't be used to read it straight out of the file.
+	bool Is_Compressed(int index) const;
+
+	// Returns the entry for the object with the given name (e.g. "container.mesh" or "hierarchy.animation") or -1.
+	int Find_Name(const char *name) const;
+	// Returns the first entry after "after" whose id and the ids of its parents match path[0] (top level) ... path[count-1], or -1.
+	int Find_Path(const uint32 *path, int count, int after = -1) const;
+	// Returns the first direct child of parent (-1 for the top level) after "after" with the given id, or -1.
+	int Find_Child(int parent, uint32 id, int after = -1) const;
+	// Walk the tree without going through every entry, a parent of -1 means the top level. Both return -1 when there are no more.
+	int First_Child(int parent) const;
+	int Next_Sibling(int index) const;
+};
@@ -29,7 +29,7 @@ typedef uint8 byte;
 typedef sint32 sint;
 typedef uint32 uint;
 
-#if (W3D_MAX_TOOLS) || (WWCONFIG) || (TDBEDIT) || (W3DSHADER) || (W3DLIB_EXPORTS) || (W3DMESHMENDER) || (W3DDEPENDS) || (W3DMAPPER) || (ACHASH) || (PACKAGEEDITOR) || (FIXPLANES) || (MERGELOD) || (MIXCHECK) || (MAKEMIX) || (ALTMAT) || (CHUNKDUMP)
+#if (W3D_MAX_TOOLS) || (WWCONFIG) || (TDBEDIT) || (W3DSHADER) || (W3DLIB_EXPORTS) || (W3DMESHMENDER) || (W3DDEPENDS) || (W3DMAPPER) || (ACHASH) || (PACKAGEEDITOR) || (FIXPLANES) || (MERGELOD) || (MIXCHECK) || (MAKEMIX) || (ALTMAT) || (CHUNKDUMP) || (W3DANIMBENCH) || (W3DDIFF) || (W3DVALIDATE) || (W3DSTATS)
 #define EXTERNAL 1
 #endif
 
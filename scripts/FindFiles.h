@@ -0,0 +1,61 @@
+#pragma once
+#include "engine_string.h"
+#include <vector>
+
+// Adds path to files if it is a file, or every file matching pattern (e.g. "*.w3d") in it and all of its subdirectories
+// if it is a directory. Returns false if path doesn't exist.
+inline bool Find_Files(const char* path, const char* pattern, std::vector<StringClass>& files)
+{
+	DWORD attributes = GetFileAttributesA(path);
+
+	if (attributes == INVALID_FILE_ATTRIBUTES)
+	{
+		return false;
+	}
+
+	if (!(attributes & FILE_ATTRIBUTE_DIRECTORY))
+	{
+		files.push_back(path);
+		return true;
+	}
+
+	StringClass dir = path;
+
+	if (!dir.Is_Empty() && dir[dir.Get_Length() - 1] != '\\' && dir[dir.Get_Length() - 1] != '/')
+	{
+		dir += "\\";
+	}
+
+	WIN32_FIND_DATAA data;
+	HANDLE h = FindFirstFileA(dir + pattern, &data);
+
+	if (h != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			{
+				files.push_back(dir + data.cFileName);
+			}
+		} while (FindNextFileA(h, &data));
+
+		FindClose(h);
+	}
+
+	h = FindFirstFileA(dir + "*", &data);
+
+	if (h != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && strcmp(data.cFileName, ".") && strcmp(data.cFileName, ".."))
+			{
+				Find_Files(dir + data.cFileName, pattern, files);
+			}
+		} while (FindNextFileA(h, &data));
+
+		FindClose(h);
+	}
+
+	return true;
+}
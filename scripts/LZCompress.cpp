@@ -0,0 +1,422 @@
+#include "General.h"
+#include "LZCompress.h"
+#include "fileclass.h"
+
+static const int LZMinMatch = 4;
+static const int LZLastLiterals = 5; // the format always ends on at least this many literals
+static const int LZMatchFindLimit = 12; // and no match starts closer than this to the end
+static const int LZMaxOffset = 65535;
+static const int LZHashLog = 12;
+
+static TT_INLINE uint32 LZ_Read32(const unsigned char *p)
+{
+	uint32 value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static TT_INLINE uint32 LZ_Hash(uint32 value)
+{
+	return (value * 2654435761u) >> (32 - LZHashLog);
+}
+
+static TT_INLINE unsigned char *LZ_Write_Length(unsigned char *op, int length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (unsigned char)length;
+	return op;
+}
+
+static TT_INLINE bool LZ_Read_Length(const unsigned char *&ip, const unsigned char *iend, int &length)
+{
+	unsigned char b;
+	do
+	{
+		if (ip >= iend || length > 0x7FFFFF00)
+		{
+			return false;
+		}
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+int LZ_Compress_Bound(int size)
+{
+	return size + size / 255 + 16;
+}
+
+int LZ_Compress(const void *source, int size, void *dest, int capacity)
+{
+	const unsigned char *src = (const unsigned char *)source;
+	const unsigned char *ip = src;
+	const unsigned char *anchor = src;
+	const unsigned char *iend = src + size;
+	unsigned char *op = (unsigned char *)dest;
+	unsigned char *oend = op + capacity;
+	if (size > LZMatchFindLimit)
+	{
+		const unsigned char *mflimit = iend - LZMatchFindLimit;
+		const unsigned char *matchlimit = iend - LZLastLiterals;
+		int table[1 << LZHashLog];
+		memset(table, 0, sizeof(table));
+		int misses = 0;
+		while (ip < mflimit)
+		{
+			uint32 sequence = LZ_Read32(ip);
+			uint32 hash = LZ_Hash(sequence);
+			const unsigned char *ref = src + table[hash];
+			table[hash] = (int)(ip - src);
+			if (ref >= ip || ip - ref > LZMaxOffset || LZ_Read32(ref) != sequence)
+			{
+				// NOTE: step further the longer it has been since the last match so incompressible data goes through quickly
+				int step = 1 + (misses++ >> 6);
+				if (step >= mflimit - ip)
+				{
+					break;
+				}
+				ip += step;
+				continue;
+			}
+			misses = 0;
+			while (ip > anchor && ref > src && ip[-1] == ref[-1])
+			{
+				ip--;
+				ref--;
+			}
+			const unsigned char *p = ip + LZMinMatch;
+			const unsigned char *q = ref + LZMinMatch;
+			while (p + 8 <= matchlimit && !memcmp(p, q, 8))
+			{
+				p += 8;
+				q += 8;
+			}
+			while (p < matchlimit && *p == *q)
+			{
+				p++;
+				q++;
+			}
+			int literals = (int)(ip - anchor);
+			int match = (int)(p - ip) - LZMinMatch;
+			if (oend - op < 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1)
+			{
+				return 0;
+			}
+			unsigned char *token = op++;
+			if (literals >= 15)
+			{
+				*token = 15 << 4;
+				op = LZ_Write_Length(op, literals - 15);
+			}
+			else
+			{
+				*token = (unsigned char)(literals << 4);
+			}
+			memcpy(op, anchor, literals);
+			op += literals;
+			int offset = (int)(ip - ref);
+			*op++ = (unsigned char)offset;
+			*op++ = (unsigned char)(offset >> 8);
+			if (match >= 15)
+			{
+				*token |= 15;
+				op = LZ_Write_Length(op, match - 15);
+			}
+			else
+			{
+				*token |= (unsigned char)match;
+			}
+			table[LZ_Hash(LZ_Read32(p - 2))] = (int)(p - 2 - src);
+			ip = p;
+			anchor = p;
+		}
+	}
+	int literals = (int)(iend - anchor);
+	if (oend - op < 1 + literals + literals / 255 + 1)
+	{
+		return 0;
+	}
+	if (literals >= 15)
+	{
+		*op++ = 15 << 4;
+		op = LZ_Write_Length(op, literals - 15);
+	}
+	else
+	{
+		*op++ = (unsigned char)(literals << 4);
+	}
+	memcpy(op, anchor, literals);
+	op += literals;
+	return (int)(op - (unsigned char *)dest);
+}
+
+int LZ_Decompress(const void *source, int size, void *dest, int capacity)
+{
+	const unsigned char *ip = (const unsigned char *)source;
+	const unsigned char *iend = ip + size;
+	unsigned char *start = (unsigned char *)dest;
+	unsigned char *op = start;
+	unsigned char *oend = op + capacity;
+	while (ip < iend)
+	{
+		unsigned char token = *ip++;
+		int literals = token >> 4;
+		if (literals == 15 && !LZ_Read_Length(ip, iend, literals))
+		{
+			return -1;
+		}
+		if (literals > iend - ip || literals > oend - op)
+		{
+			return -1;
+		}
+		memcpy(op, ip, literals);
+		op += literals;
+		ip += literals;
+		if (ip == iend)
+		{
+			break;
+		}
+		if (iend - ip < 2)
+		{
+			return -1;
+		}
+		int offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (!offset || offset > op - start)
+		{
+			return -1;
+		}
+		int match = token & 15;
+		if (match == 15 && !LZ_Read_Length(ip, iend, match))
+		{
+			return -1;
+		}
+		match += LZMinMatch;
+		if (match > oend - op)
+		{
+			return -1;
+		}
+		// NOTE: a match can overlap what it is writing, copying a period at a time keeps every memcpy non overlapping
+		const unsigned char *ref = op - offset;
+		if (offset >= match)
+		{
+			memcpy(op, ref, match);
+			op += match;
+		}
+		else
+		{
+			while (match > 0)
+			{
+				int count = match < offset ? match : offset;
+				memcpy(op, ref, count);
+				op += count;
+				match -= count;
+			}
+		}
+	}
+	return (int)(op - start);
+}
+
+void LZ_Compress_Blocks(const void *source, int size, int block_size, std::vector<unsigned char> &out)
+{
+	const unsigned char *src = (const unsigned char *)source;
+	for (int pos = 0; pos < size; pos += block_size)
+	{
+		int count = min(block_size, size - pos);
+		size_t at = out.size();
+		out.resize(at + sizeof(uint32) + count);
+		unsigned char *block = out.data() + at + sizeof(uint32);
+		uint32 header = LZ_Compress(src + pos, count, block, count - 1);
+		if (!header)
+		{
+			memcpy(block, src + pos, count);
+			header = count | LZ_BLOCK_RAW;
+		}
+		memcpy(out.data() + at, &header, sizeof(header));
+		out.resize(at + sizeof(uint32) + (header & ~LZ_BLOCK_RAW));
+	}
+}
+
+bool LZ_Decompress_Blocks(const void *source, int source_size, int block_size, void *dest, int size)
+{
+	const unsigned char *ip = (const unsigned char *)source;
+	const unsigned char *iend = ip + source_size;
+	unsigned char *op = (unsigned char *)dest;
+	for (int pos = 0; pos < size; pos += block_size)
+	{
+		int count = min(block_size, size - pos);
+		uint32 header;
+		if (iend - ip < (int)sizeof(header))
+		{
+			return false;
+		}
+		memcpy(&header, ip, sizeof(header));
+		ip += sizeof(header);
+		uint32 stored = header & ~LZ_BLOCK_RAW;
+		if (stored > (uint32)(iend - ip))
+		{
+			return false;
+		}
+		if (header & LZ_BLOCK_RAW)
+		{
+			if (stored != (uint32)count)
+			{
+				return false;
+			}
+			memcpy(op + pos, ip, count);
+		}
+		else if (LZ_Decompress(ip, stored, op + pos, count) != count)
+		{
+			return false;
+		}
+		ip += stored;
+	}
+	return true;
+}
+
+void LZBlockReaderClass::Begin(FileClass *file, unsigned long stored, unsigned long size, int block_size)
+{
+	TT_ASSERT(block_size > 0);
+	File = file;
+	BlockSize = block_size;
+	Stored = stored;
+	Remaining = size;
+	BlockPos = 0;
+	BlockUsed = 0;
+	Failed = false;
+}
+
+void LZBlockReaderClass::End()
+{
+	if (Stored)
+	{
+		File->Seek(Stored, 1);
+	}
+	File = nullptr;
+	Stored = 0;
+	Remaining = 0;
+	BlockPos = 0;
+	BlockUsed = 0;
+}
+
+bool LZBlockReaderClass::Next_Block()
+{
+	if (!Remaining || Failed)
+	{
+		return false;
+	}
+	int count = (int)min((unsigned long)BlockSize, Remaining);
+	uint32 header;
+	Failed = true;
+	if (Stored < sizeof(header) || File->Read(&header, sizeof(header)) != sizeof(header))
+	{
+		return false;
+	}
+	Stored -= sizeof(header);
+	uint32 stored = header & ~LZ_BLOCK_RAW;
+	if (stored > Stored)
+	{
+		return false;
+	}
+	// NOTE: whatever is left of the last block moves to the front so a peek across the boundary still sees contiguous bytes
+	int tail = BlockUsed - BlockPos;
+	memmove(Block.data(), Block.data() + BlockPos, tail);
+	if ((int)Block.size() < tail + count)
+	{
+		Block.resize(tail + count);
+	}
+	if (header & LZ_BLOCK_RAW)
+	{
+		if (stored != (uint32)count || File->Read(Block.data() + tail, count) != count)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		Packed.resize(stored);
+		if (File->Read(Packed.data(), stored) != (int)stored || LZ_Decompress(Packed.data(), stored, Block.data() + tail, count) != count)
+		{
+			return false;
+		}
+	}
+	Stored -= stored;
+	Remaining -= count;
+	BlockPos = 0;
+	BlockUsed = tail + count;
+	Failed = false;
+	return true;
+}
+
+int LZBlockReaderClass::Read(void *buf, int nbytes)
+{
+	int result = 0;
+	while (result < nbytes)
+	{
+		if (BlockPos == BlockUsed && !Next_Block())
+		{
+			break;
+		}
+		int count = min(nbytes - result, BlockUsed - BlockPos);
+		memcpy((char *)buf + result, Block.data() + BlockPos, count);
+		BlockPos += count;
+		result += count;
+	}
+	return result;
+}
+
+int LZBlockReaderClass::Skip(int nbytes)
+{
+	int result = 0;
+	while (result < nbytes)
+	{
+		if (BlockPos < BlockUsed)
+		{
+			int count = min(nbytes - result, BlockUsed - BlockPos);
+			BlockPos += count;
+			result += count;
+			continue;
+		}
+		int count = (int)min((unsigned long)BlockSize, Remaining);
+		if (!count || Failed)
+		{
+			break;
+		}
+		if (nbytes - result < count)
+		{
+			if (!Next_Block())
+			{
+				break;
+			}
+			continue;
+		}
+		// NOTE: the whole block is being skipped, it doesn't need decompressing
+		uint32 header;
+		if (Stored < sizeof(header) || File->Read(&header, sizeof(header)) != sizeof(header) || (header & ~LZ_BLOCK_RAW) > Stored - sizeof(header))
+		{
+			Failed = true;
+			break;
+		}
+		uint32 stored = header & ~LZ_BLOCK_RAW;
+		File->Seek(stored, 1);
+		Stored -= sizeof(header) + stored;
+		Remaining -= count;
+		result += count;
+	}
+	return result;
+}
+
+int LZBlockReaderClass::Peek(void *buf, int nbytes)
+{
+	while (BlockUsed - BlockPos < nbytes && Next_Block())
+	{
+	}
+	int count = min(nbytes, BlockUsed - BlockPos);
+	memcpy(buf, Block.data() + BlockPos, count);
+	return count;
+}
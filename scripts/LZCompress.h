@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+
+class FileClass;
+
+// Byte oriented LZ77 block compressor using the LZ4 block format: greedy matching against a small hash table on the way
+// in and nothing but copies on the way out, so decompressing is limited by memory bandwidth rather than the disk.
+//
+// Larger data is split into block streams, each block is a uint32 holding the stored size (with LZ_BLOCK_RAW set when
+// the block didn't compress and is stored as is) followed by the stored bytes. Every block but the last decompresses
+// to block_size bytes so the decompressed size of a block is always known before it's read.
+
+#define LZ_BLOCK_SIZE 65536
+#define LZ_MAX_BLOCK_SIZE 0x400000
+#define LZ_BLOCK_RAW 0x80000000
+
+// Worst case size of LZ_Compress output, incompressible data grows by about 1 in 255.
+SCRIPTS_API int LZ_Compress_Bound(int size);
+// Returns the compressed size, or 0 if it wouldn't fit in capacity.
+SCRIPTS_API int LZ_Compress(const void *source, int size, void *dest, int capacity);
+// Returns the decompressed size, or -1 if source is corrupt or decompresses to more than capacity.
+// Never reads or writes outside the two buffers whatever source contains.
+SCRIPTS_API int LZ_Decompress(const void *source, int size, void *dest, int capacity);
+
+// Appends size bytes of source to out as a block stream.
+SCRIPTS_API void LZ_Compress_Blocks(const void *source, int size, int block_size, std::vector<unsigned char> &out);
+// Decompresses a whole block stream that must come to exactly size bytes.
+SCRIPTS_API bool LZ_Decompress_Blocks(const void *source, int source_size, int block_size, void *dest, int size);
+
+// Reads a block stream straight out of a file one block at a time, so the decompressed data never has to be in memory
+// all at once. Skipping whole blocks seeks past them without decompressing them.
+class SCRIPTS_API LZBlockReaderClass
+{
+	FileClass *File;
+	int BlockSize;
+	unsigned long Stored; // bytes of the block stream still in the file
+	unsigned long Remaining; // decompressed bytes not decoded into Block yet
+	std::vector<unsigned char> Block;
+	std::vector<unsigned char> Packed;
+	int BlockPos;
+	int BlockUsed;
+	bool Failed;
+	bool Next_Block();
+public:
+	LZBlockReaderClass() : File(nullptr), BlockSize(0), Stored(0), Remaining(0), BlockPos(0), BlockUsed(0), Failed(false) {}
+	// Starts reading a block stream of stored bytes at the current position in file that decompresses to size bytes.
+	void Begin(FileClass *file, unsigned long stored, unsigned long size, int block_size);
+	// Moves the file past whatever is left of the block stream.
+	void End();
+	bool Is_Active() const { return File != nullptr; }
+	bool Has_Failed() const { return Failed; }
+	int Read(void *buf, int nbytes);
+	int Skip(int nbytes);
+	// Copies the next nbytes without moving past them.
+	int Peek(void *buf, int nbytes);
+};
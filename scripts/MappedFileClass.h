@@ -0,0 +1,87 @@
+#pragma once
+// Read only view of an entire file mapped into memory, for loaders that want to look at the data in place instead of copying it out
+class MappedFileClass
+{
+private:
+	HANDLE File;
+	HANDLE Mapping;
+	const unsigned char* Data;
+	unsigned long Size;
+public:
+	MappedFileClass() : File(INVALID_HANDLE_VALUE), Mapping(nullptr), Data(nullptr), Size(0)
+	{
+	}
+	MappedFileClass(const char* filename) : MappedFileClass()
+	{
+		Open(filename);
+	}
+	~MappedFileClass()
+	{
+		Close();
+	}
+	MappedFileClass(const MappedFileClass&) = delete;
+	MappedFileClass& operator=(const MappedFileClass&) = delete;
+	bool Open(const char* filename)
+	{
+		Close();
+		File = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(File, &size) || size.QuadPart > 0x7FFFFFFF)
+		{
+			Close();
+			return false;
+		}
+		Size = (unsigned long)size.QuadPart;
+		if (!Size)
+		{
+			// NOTE: an empty file can't be mapped, it just has no data
+			return true;
+		}
+		Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (Mapping)
+		{
+			Data = (const unsigned char*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (!Data)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+	void Close()
+	{
+		if (Data)
+		{
+			UnmapViewOfFile(Data);
+			Data = nullptr;
+		}
+		if (Mapping)
+		{
+			CloseHandle(Mapping);
+			Mapping = nullptr;
+		}
+		if (File != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(File);
+			File = INVALID_HANDLE_VALUE;
+		}
+		Size = 0;
+	}
+	bool Is_Open() const
+	{
+		return File != INVALID_HANDLE_VALUE;
+	}
+	const unsigned char* Get_Data() const
+	{
+		return Data;
+	}
+	unsigned long Get_Size() const
+	{
+		return Size;
+	}
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Calls func(i) for every i in [0, count) spread over one thread per core, the calling thread helps as well.
+// Items are handed out one at a time in order, so uneven items still balance. func must not throw, collect anything that
+// has to be reported and report it on the calling thread afterwards.
+template <typename F> void ParallelFor(int count, F func)
+{
+	int threadcount = (int)std::thread::hardware_concurrency();
+
+	if (threadcount > count)
+	{
+		threadcount = count;
+	}
+
+	std::atomic<int> next = 0;
+	auto worker = [&]()
+	{
+		for (int i = next++; i < count; i = next++)
+		{
+			func(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (int i = 1; i < threadcount; i++)
+	{
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -0,0 +1,687 @@
+#include "General.h"
+#include "W3DValidatorClass.h"
+#include "ChunkClass.h"
+#include "ChunkIndexClass.h"
+#include "w3d.h"
+#include "w3dobsolete.h"
+#include <algorithm>
+
+// Names in W3D structs are fixed size and not always null terminated
+template<int N> static StringClass Fixed_Name(const char (&name)[N])
+{
+	return StringClass(StringView(name, strnlen(name, N)));
+}
+
+template<int N, int M> static StringClass Qualified_Name(const char (&prefix)[N], const char (&name)[M])
+{
+	StringClass str = Fixed_Name(prefix);
+	if (!str.Is_Empty())
+	{
+		str += ".";
+	}
+	str += Fixed_Name(name);
+	return str;
+}
+
+// NOTE: a compressed top level chunk is checked in its decompressed form, so everything in it has an offset from the start of that
+static unsigned long Chunk_Offset(MappedChunkLoadClass &cload)
+{
+	if (cload.Is_Compressed() && (cload.Cur_Chunk_Depth() == 1))
+	{
+		return 0;
+	}
+	return cload.Cur_Chunk_Offset();
+}
+
+void W3DValidatorClass::Error(MappedChunkLoadClass &cload, unsigned long offset, const char *format, ...)
+{
+	StringClass message;
+	va_list args;
+	va_start(args, format);
+	message.Format_Args(format, args);
+	va_end(args);
+	StringClass str;
+	if (cload.Is_Compressed())
+	{
+		str.Format("0x%08X+0x%X (compressed)", TopOffset, offset);
+	}
+	else
+	{
+		str.Format("0x%08X", offset);
+	}
+	str += ": ";
+	if (!Object.Is_Empty())
+	{
+		str += Object;
+		str += ": ";
+	}
+	str += message;
+	Errors.push_back(str);
+}
+
+bool W3DValidatorClass::Check_Array(MappedChunkLoadClass &cload, const char *what, unsigned long header, unsigned long size, uint32 expected, bool known)
+{
+	unsigned long length = cload.Cur_Chunk_Length();
+	if ((length < header) || ((length - header) % size))
+	{
+		Error(cload, Chunk_Offset(cload), "%s chunk is %lu bytes which isn't a whole number of %lu byte entries", what, length, size);
+		return false;
+	}
+	unsigned long count = (length - header) / size;
+	if (known && (count != expected))
+	{
+		Error(cload, Chunk_Offset(cload), "%lu %s but the header says %u", count, what, expected);
+		return false;
+	}
+	return true;
+}
+
+void W3DValidatorClass::Check_Chunks(MappedChunkLoadClass &cload, const unsigned char *payload, unsigned long length, uint32 parent)
+{
+	unsigned long used = 0;
+	while (cload.Open_Chunk())
+	{
+		used += cload.Cur_Chunk_Stored_Size();
+		if (cload.Cur_Chunk_Depth() == 1)
+		{
+			TopOffset = cload.Cur_Chunk_Offset();
+		}
+		Check_Chunk(cload, parent);
+		cload.Close_Chunk();
+	}
+	if (used >= length)
+	{
+		return;
+	}
+	// NOTE: the loader won't open anything that doesn't fit, so whatever stopped it is right after the last chunk it did open
+	unsigned long left = length - used;
+	unsigned long offset = cload.Cur_Chunk_Depth() ? Chunk_Offset(cload) + 8 + used : used;
+	if (left < 8)
+	{
+		Error(cload, offset, "%lu bytes after the last chunk are too short to be a chunk", left);
+		return;
+	}
+	ChunkHeader header;
+	memcpy(&header, payload + used, sizeof(header));
+	unsigned long size = header.ChunkSize & 0x7FFFFFFF;
+	if (size > left - 8)
+	{
+		Error(cload, offset, "chunk %08X is %lu bytes but there are only %lu left in its parent", header.ChunkType, size, left - 8);
+	}
+	else if (!cload.Cur_Chunk_Depth() && (header.ChunkType == COMPRESSED_CHUNK_ID))
+	{
+		Error(cload, offset, "compressed chunk can't be decompressed");
+	}
+	else
+	{
+		Error(cload, offset, "chunk %08X is nested too deep", header.ChunkType);
+	}
+}
+
+void W3DValidatorClass::Check_Chunk(MappedChunkLoadClass &cload, uint32 parent)
+{
+	uint32 id = cload.Cur_Chunk_ID();
+	const unsigned char *payload = (const unsigned char *)cload.Cur_Chunk_Data();
+	unsigned long length = cload.Cur_Chunk_Length();
+	// NOTE: the objects are only ever top level chunks, a mesh id anywhere else is just a zero
+	switch (cload.Cur_Chunk_Depth() == 1 ? id : 0xFFFFFFFF)
+	{
+	case W3D_CHUNK_MESH:
+		Mesh = MeshState();
+		Object = "mesh";
+		Check_Chunks(cload, payload, length, id);
+		if (!Mesh.HasHeader)
+		{
+			Error(cload, Chunk_Offset(cload), "no mesh header");
+		}
+		Object = "";
+		return;
+	case W3D_CHUNK_HIERARCHY:
+		Hierarchy = HierarchyState();
+		Object = "hierarchy";
+		Check_Chunks(cload, payload, length, id);
+		if (!Hierarchy.HasHeader)
+		{
+			Error(cload, Chunk_Offset(cload), "no hierarchy header");
+		}
+		else
+		{
+			Hierarchies.push_back({ Hierarchy.Name, (int)Hierarchy.Pivots });
+		}
+		Object = "";
+		return;
+	case W3D_CHUNK_ANIMATION:
+	case W3D_CHUNK_COMPRESSED_ANIMATION:
+		Anim = AnimState();
+		Object = "animation";
+		Check_Chunks(cload, payload, length, id);
+		if (!Anim.HasHeader)
+		{
+			Error(cload, Chunk_Offset(cload), "no animation header");
+		}
+		else
+		{
+			Add_Reference(Anim.HierarchyName, Anim.MaxPivot);
+		}
+		Object = "";
+		return;
+	case W3D_CHUNK_HLOD:
+		HLod = HLodState();
+		Object = "HLOD";
+		Check_Chunks(cload, payload, length, id);
+		if (!HLod.HasHeader)
+		{
+			Error(cload, Chunk_Offset(cload), "no HLOD header");
+		}
+		else
+		{
+			Add_Reference(HLod.HierarchyName, HLod.MaxPivot);
+		}
+		Object = "";
+		return;
+	}
+	switch (parent)
+	{
+	case W3D_CHUNK_MESH:
+		Check_Mesh_Chunk(cload);
+		break;
+	case W3D_CHUNK_AABTREE:
+		Check_AABTree_Chunk(cload);
+		break;
+	case W3D_CHUNK_HIERARCHY:
+		Check_Hierarchy_Chunk(cload);
+		break;
+	case W3D_CHUNK_ANIMATION:
+	case W3D_CHUNK_COMPRESSED_ANIMATION:
+		Check_Animation_Chunk(cload);
+		break;
+	case W3D_CHUNK_HLOD:
+		if ((id == W3D_CHUNK_HLOD_HEADER) && !HLod.HasHeader)
+		{
+			auto header = cload.Cur_Chunk_Span<W3dHLodHeaderStruct>();
+			if (header.Empty())
+			{
+				Error(cload, Chunk_Offset(cload), "HLOD header is too short");
+				break;
+			}
+			HLod.HasHeader = true;
+			HLod.HierarchyName = Fixed_Name(header[0].HierarchyName);
+			Object = "HLOD ";
+			Object += Fixed_Name(header[0].Name);
+		}
+		break;
+	case W3D_CHUNK_HLOD_LOD_ARRAY:
+	case W3D_CHUNK_HLOD_AGGREGATE_ARRAY:
+	case W3D_CHUNK_HLOD_PROXY_ARRAY:
+		if (id == W3D_CHUNK_HLOD_SUB_OBJECT)
+		{
+			auto subobject = cload.Cur_Chunk_Span<W3dHLodSubObjectStruct>();
+			if (subobject.Empty())
+			{
+				Error(cload, Chunk_Offset(cload), "sub object is too short");
+			}
+			else if ((int)min(subobject[0].BoneIndex, 0x7FFFFFFFu) > HLod.MaxPivot)
+			{
+				HLod.MaxPivot = (int)min(subobject[0].BoneIndex, 0x7FFFFFFFu);
+			}
+		}
+		break;
+	}
+	if (cload.Contains_Chunks() || ChunkIndexClass::Is_Container(id))
+	{
+		Check_Chunks(cload, payload, length, id);
+	}
+}
+
+void W3DValidatorClass::Check_Mesh_Chunk(MappedChunkLoadClass &cload)
+{
+	switch (cload.Cur_Chunk_ID())
+	{
+	case W3D_CHUNK_MESH_HEADER3:
+	{
+		auto header = cload.Cur_Chunk_Span<W3dMeshHeader3Struct>();
+		if (header.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "mesh header is too short");
+			break;
+		}
+		Mesh.HasHeader = true;
+		Mesh.Vertices = header[0].NumVertices;
+		Mesh.Tris = header[0].NumTris;
+		Object = "mesh ";
+		Object += Qualified_Name(header[0].ContainerName, header[0].MeshName);
+		break;
+	}
+	case W3D_CHUNK_VERTICES:
+		Check_Array(cload, "vertices", 0, sizeof(W3dVectorStruct), Mesh.Vertices, Mesh.HasHeader);
+		break;
+	case W3D_CHUNK_QUANTIZED_VERTICES:
+		Check_Array(cload, "quantized vertices", sizeof(W3dQuantizedVectorHeaderStruct), 3 * sizeof(uint16), Mesh.Vertices, Mesh.HasHeader);
+		break;
+	case W3D_CHUNK_TRIANGLES:
+	{
+		if (!Check_Array(cload, "triangles", 0, sizeof(W3dTriStruct), Mesh.Tris, Mesh.HasHeader) || !Mesh.HasHeader)
+		{
+			break;
+		}
+		auto tris = cload.Cur_Chunk_Span<W3dTriStruct>();
+		int first = -1;
+		int bad = 0;
+		for (int i = 0; i < tris.Size(); i++)
+		{
+			if ((tris[i].Vindex[0] >= Mesh.Vertices) || (tris[i].Vindex[1] >= Mesh.Vertices) || (tris[i].Vindex[2] >= Mesh.Vertices))
+			{
+				if (first < 0)
+				{
+					first = i;
+				}
+				bad++;
+			}
+		}
+		if (bad)
+		{
+			Error(cload, Chunk_Offset(cload), "%d triangles use vertices past the %u the mesh has, the first is %d (%u %u %u)", bad, Mesh.Vertices, first, tris[first].Vindex[0], tris[first].Vindex[1], tris[first].Vindex[2]);
+		}
+		break;
+	}
+	}
+}
+
+void W3DValidatorClass::Check_AABTree_Chunk(MappedChunkLoadClass &cload)
+{
+	switch (cload.Cur_Chunk_ID())
+	{
+	case W3D_CHUNK_AABTREE_HEADER:
+	{
+		auto header = cload.Cur_Chunk_Span<W3dMeshAABTreeHeader>();
+		if (header.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "AABTree header is too short");
+			break;
+		}
+		Mesh.HasTreeHeader = true;
+		Mesh.Nodes = header[0].NodeCount;
+		Mesh.Polys = header[0].PolyCount;
+		break;
+	}
+	case W3D_CHUNK_AABTREE_POLYINDICES:
+	{
+		if (!Check_Array(cload, "AABTree polygon indices", 0, sizeof(uint32), Mesh.Polys, Mesh.HasTreeHeader) || !Mesh.HasHeader)
+		{
+			break;
+		}
+		auto polys = cload.Cur_Chunk_Span<uint32>();
+		int first = -1;
+		int bad = 0;
+		for (int i = 0; i < polys.Size(); i++)
+		{
+			if (polys[i] >= Mesh.Tris)
+			{
+				if (first < 0)
+				{
+					first = i;
+				}
+				bad++;
+			}
+		}
+		if (bad)
+		{
+			Error(cload, Chunk_Offset(cload), "%d AABTree polygon indices are past the %u triangles the mesh has, the first is %d (%u)", bad, Mesh.Tris, first, polys[first]);
+		}
+		break;
+	}
+	case W3D_CHUNK_AABTREE_NODES:
+	{
+		if (!Check_Array(cload, "AABTree nodes", 0, sizeof(W3dMeshAABTreeNode), Mesh.Nodes, Mesh.HasTreeHeader) || !Mesh.HasTreeHeader)
+		{
+			break;
+		}
+		auto nodes = cload.Cur_Chunk_Span<W3dMeshAABTreeNode>();
+		for (int i = 0; i < nodes.Size(); i++)
+		{
+			uint32 front = nodes[i].FrontOrPoly0;
+			uint32 back = nodes[i].BackOrPolyCount;
+			if (front & 0x80000000)
+			{
+				front &= 0x7FFFFFFF;
+				if ((front > Mesh.Polys) || (back > Mesh.Polys - front))
+				{
+					Error(cload, Chunk_Offset(cload), "AABTree leaf %d has polygons %u to %u but there are only %u", i, front, front + back, Mesh.Polys);
+					break;
+				}
+			}
+			// NOTE: nodes are stored depth first so children always come after their parent, anything else could loop forever
+			else if ((front <= (uint32)i) || (back <= (uint32)i) || (front >= Mesh.Nodes) || (back >= Mesh.Nodes))
+			{
+				Error(cload, Chunk_Offset(cload), "AABTree node %d has children %u and %u, they have to be after it and below %u", i, front, back, Mesh.Nodes);
+				break;
+			}
+		}
+		break;
+	}
+	}
+}
+
+void W3DValidatorClass::Check_Hierarchy_Chunk(MappedChunkLoadClass &cload)
+{
+	switch (cload.Cur_Chunk_ID())
+	{
+	case W3D_CHUNK_HIERARCHY_HEADER:
+	{
+		auto header = cload.Cur_Chunk_Span<W3dHierarchyStruct>();
+		if (header.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "hierarchy header is too short");
+			break;
+		}
+		Hierarchy.HasHeader = true;
+		Hierarchy.Name = Fixed_Name(header[0].Name);
+		Hierarchy.Pivots = header[0].NumPivots;
+		Object = "hierarchy ";
+		Object += Hierarchy.Name;
+		break;
+	}
+	case W3D_CHUNK_PIVOTS:
+	{
+		if (!Check_Array(cload, "pivots", 0, sizeof(W3dPivotStruct), Hierarchy.Pivots, Hierarchy.HasHeader))
+		{
+			break;
+		}
+		auto pivots = cload.Cur_Chunk_Span<W3dPivotStruct>();
+		for (int i = 0; i < pivots.Size(); i++)
+		{
+			uint32 parent = pivots[i].ParentIdx;
+			if ((parent != 0xFFFFFFFF) && (parent >= (uint32)i))
+			{
+				Error(cload, Chunk_Offset(cload), "pivot %d has parent %u, parents have to come before their children", i, parent);
+				break;
+			}
+		}
+		break;
+	}
+	}
+}
+
+void W3DValidatorClass::Check_Frames(MappedChunkLoadClass &cload, const char *what, const uint32 *timecodes, int count, int stride, uint32 mask)
+{
+	uint32 last = 0;
+	for (int i = 0; i < count; i++)
+	{
+		uint32 frame = timecodes[i * stride] & ~mask;
+		if (frame >= Anim.Frames)
+		{
+			Error(cload, Chunk_Offset(cload), "%s key %d is at frame %u but the animation has %u frames", what, i, frame, Anim.Frames);
+			return;
+		}
+		if (i && (frame <= last))
+		{
+			Error(cload, Chunk_Offset(cload), "%s key %d is at frame %u which isn't after the key before it at %u", what, i, frame, last);
+			return;
+		}
+		last = frame;
+	}
+}
+
+void W3DValidatorClass::Check_Pivot(int pivot)
+{
+	if (pivot > Anim.MaxPivot)
+	{
+		Anim.MaxPivot = pivot;
+	}
+}
+
+void W3DValidatorClass::Check_Animation_Chunk(MappedChunkLoadClass &cload)
+{
+	const unsigned char *payload = (const unsigned char *)cload.Cur_Chunk_Data();
+	unsigned long length = cload.Cur_Chunk_Length();
+	uint32 id = cload.Cur_Chunk_ID();
+	if ((id != W3D_CHUNK_ANIMATION_HEADER) && (id != W3D_CHUNK_COMPRESSED_ANIMATION_HEADER) && !Anim.HasHeader)
+	{
+		return;
+	}
+	switch (id)
+	{
+	case W3D_CHUNK_ANIMATION_HEADER:
+	{
+		auto header = cload.Cur_Chunk_Span<W3dAnimHeaderStruct>();
+		if (header.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "animation header is too short");
+			break;
+		}
+		Anim.HasHeader = true;
+		Anim.Frames = header[0].NumFrames;
+		Anim.HierarchyName = Fixed_Name(header[0].HierarchyName);
+		Object = "animation ";
+		Object += Qualified_Name(header[0].HierarchyName, header[0].Name);
+		break;
+	}
+	case W3D_CHUNK_COMPRESSED_ANIMATION_HEADER:
+	{
+		auto header = cload.Cur_Chunk_Span<W3dCompressedAnimHeaderStruct>();
+		if (header.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "animation header is too short");
+			break;
+		}
+		Object = "animation ";
+		Object += Qualified_Name(header[0].HierarchyName, header[0].Name);
+		if (header[0].Flavor >= ANIM_FLAVOR_NEW_VALID)
+		{
+			Error(cload, Chunk_Offset(cload), "unknown compression flavor %u", header[0].Flavor);
+			break;
+		}
+		Anim.HasHeader = true;
+		Anim.Frames = header[0].NumFrames;
+		Anim.Flavor = header[0].Flavor;
+		Anim.HierarchyName = Fixed_Name(header[0].HierarchyName);
+		break;
+	}
+	case W3D_CHUNK_ANIMATION_CHANNEL:
+	{
+		unsigned long header = offsetof(W3dAnimChannelStruct, Data);
+		if (length < header)
+		{
+			Error(cload, Chunk_Offset(cload), "animation channel is too short");
+			break;
+		}
+		auto channel = (const W3dAnimChannelStruct *)payload;
+		Check_Pivot(channel->Pivot);
+		if ((channel->FirstFrame > channel->LastFrame) || (channel->LastFrame >= Anim.Frames))
+		{
+			Error(cload, Chunk_Offset(cload), "channel for pivot %u has frames %u to %u but the animation has %u", channel->Pivot, channel->FirstFrame, channel->LastFrame, Anim.Frames);
+		}
+		else if (length - header < (unsigned long)(channel->LastFrame - channel->FirstFrame + 1) * channel->VectorLen * sizeof(float))
+		{
+			Error(cload, Chunk_Offset(cload), "channel for pivot %u is too short for frames %u to %u", channel->Pivot, channel->FirstFrame, channel->LastFrame);
+		}
+		break;
+	}
+	case W3D_CHUNK_BIT_CHANNEL:
+	{
+		unsigned long header = offsetof(W3dBitChannelStruct, Data);
+		if (length < header)
+		{
+			Error(cload, Chunk_Offset(cload), "bit channel is too short");
+			break;
+		}
+		auto channel = (const W3dBitChannelStruct *)payload;
+		Check_Pivot(channel->Pivot);
+		if ((channel->FirstFrame > channel->LastFrame) || (channel->LastFrame >= Anim.Frames))
+		{
+			Error(cload, Chunk_Offset(cload), "bit channel for pivot %u has frames %u to %u but the animation has %u", channel->Pivot, channel->FirstFrame, channel->LastFrame, Anim.Frames);
+		}
+		else if (length - header < (unsigned long)(channel->LastFrame - channel->FirstFrame + 8) / 8)
+		{
+			Error(cload, Chunk_Offset(cload), "bit channel for pivot %u is too short for frames %u to %u", channel->Pivot, channel->FirstFrame, channel->LastFrame);
+		}
+		break;
+	}
+	case W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL:
+		if (Anim.Flavor == ANIM_FLAVOR_NEW_TIMECODED)
+		{
+			unsigned long header = offsetof(W3dTimeCodedAnimChannelStruct, Data);
+			if (length < header)
+			{
+				Error(cload, Chunk_Offset(cload), "compressed channel is too short");
+				break;
+			}
+			auto channel = (const W3dTimeCodedAnimChannelStruct *)payload;
+			Check_Pivot(channel->Pivot);
+			uint64 packet = 1 + channel->VectorLen;
+			if ((length - header) / sizeof(uint32) / packet < channel->NumTimeCodes)
+			{
+				Error(cload, Chunk_Offset(cload), "compressed channel for pivot %u is too short for %u keys", channel->Pivot, channel->NumTimeCodes);
+				break;
+			}
+			Check_Frames(cload, "compressed channel", channel->Data, channel->NumTimeCodes, (int)packet, W3D_TIMECODED_BINARY_MOVEMENT_FLAG);
+		}
+		else if (Anim.Flavor >= 0)
+		{
+			unsigned long header = offsetof(W3dAdaptiveDeltaAnimChannelStruct, Data);
+			if (length < header)
+			{
+				Error(cload, Chunk_Offset(cload), "compressed channel is too short");
+				break;
+			}
+			auto channel = (const W3dAdaptiveDeltaAnimChannelStruct *)payload;
+			Check_Pivot(channel->Pivot);
+			if (channel->NumFrames != Anim.Frames)
+			{
+				Error(cload, Chunk_Offset(cload), "compressed channel for pivot %u has %u frames but the animation has %u", channel->Pivot, channel->NumFrames, Anim.Frames);
+				break;
+			}
+			// NOTE: the frame 0 vector and then a 9 byte packet (filter index and 16 4 bit deltas) per 16 frames per vector element
+			uint64 size = (uint64)channel->VectorLen * sizeof(float) + (uint64)((channel->NumFrames + 15) >> 4) * channel->VectorLen * 9;
+			if (length - header < size)
+			{
+				Error(cload, Chunk_Offset(cload), "compressed channel for pivot %u is too short for %u frames", channel->Pivot, channel->NumFrames);
+			}
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_ANIMATION_MOTION_CHANNEL:
+	{
+		auto channel = cload.Cur_Chunk_Span<W3dCompressedMotionChannelStruct>();
+		if (channel.Empty())
+		{
+			Error(cload, Chunk_Offset(cload), "motion channel is too short");
+			break;
+		}
+		Check_Pivot(channel[0].Pivot);
+		unsigned long left = length - sizeof(W3dCompressedMotionChannelStruct);
+		const unsigned char *data = payload + sizeof(W3dCompressedMotionChannelStruct);
+		uint32 keys = channel[0].NumTimeCodes;
+		if (channel[0].Flavor == ANIM_FLAVOR_NEW_TIMECODED)
+		{
+			// NOTE: the 16 bit frame numbers are padded to a multiple of 4 bytes, the key vectors come after them
+			uint64 size = (uint64)((keys + 1) & ~1) * sizeof(uint16) + (uint64)keys * channel[0].VectorLen * sizeof(float);
+			if (left < size)
+			{
+				Error(cload, Chunk_Offset(cload), "motion channel for pivot %u is too short for %u keys", channel[0].Pivot, keys);
+				break;
+			}
+			uint32 last = 0;
+			for (uint32 i = 0; i < keys; i++)
+			{
+				uint16 frame;
+				memcpy(&frame, data + i * sizeof(uint16), sizeof(frame));
+				if ((frame >= Anim.Frames) || (i && (frame <= last)))
+				{
+					Error(cload, Chunk_Offset(cload), "motion channel for pivot %u key %u is at frame %u, keys have to be in order and below %u", channel[0].Pivot, i, frame, Anim.Frames);
+					break;
+				}
+				last = frame;
+			}
+		}
+		else if ((channel[0].Flavor == ANIM_FLAVOR_NEW_ADAPTIVE_DELTA_4) || (channel[0].Flavor == ANIM_FLAVOR_NEW_ADAPTIVE_DELTA_8))
+		{
+			if (keys != Anim.Frames)
+			{
+				Error(cload, Chunk_Offset(cload), "motion channel for pivot %u has %u frames but the animation has %u", channel[0].Pivot, keys, Anim.Frames);
+				break;
+			}
+			int bits = channel[0].Flavor == ANIM_FLAVOR_NEW_ADAPTIVE_DELTA_4 ? 4 : 8;
+			uint64 size = sizeof(float) + (uint64)channel[0].VectorLen * sizeof(float) + (uint64)((keys + 15) >> 4) * channel[0].VectorLen * (1 + bits * 2);
+			if (left < size)
+			{
+				Error(cload, Chunk_Offset(cload), "motion channel for pivot %u is too short for %u frames", channel[0].Pivot, keys);
+			}
+		}
+		else
+		{
+			Error(cload, Chunk_Offset(cload), "motion channel for pivot %u has unknown flavor %u", channel[0].Pivot, channel[0].Flavor);
+		}
+		break;
+	}
+	case W3D_CHUNK_COMPRESSED_BIT_CHANNEL:
+	{
+		unsigned long header = offsetof(W3dTimeCodedBitChannelStruct, Data);
+		if (length < header)
+		{
+			Error(cload, Chunk_Offset(cload), "compressed bit channel is too short");
+			break;
+		}
+		auto channel = (const W3dTimeCodedBitChannelStruct *)payload;
+		Check_Pivot(channel->Pivot);
+		if ((length - header) / sizeof(uint32) < channel->NumTimeCodes)
+		{
+			Error(cload, Chunk_Offset(cload), "compressed bit channel for pivot %u is too short for %u keys", channel->Pivot, channel->NumTimeCodes);
+			break;
+		}
+		Check_Frames(cload, "compressed bit channel", channel->Data, channel->NumTimeCodes, 1, W3D_TIMECODED_BIT_MASK);
+		break;
+	}
+	}
+}
+
+void W3DValidatorClass::Add_Reference(const StringClass &hierarchy, int maxpivot)
+{
+	if (hierarchy.Is_Empty())
+	{
+		return;
+	}
+	W3DHierarchyReference reference;
+	reference.Hierarchy = hierarchy;
+	reference.Object = Object;
+	reference.MaxPivot = maxpivot;
+	Unresolved.push_back(reference);
+}
+
+bool W3DValidatorClass::Check_Reference(const W3DHierarchyReference &reference, int pivots, StringClass &error)
+{
+	if (reference.MaxPivot < pivots)
+	{
+		return true;
+	}
+	error.Format("%s: uses pivot %d but hierarchy %s only has %d", reference.Object.Peek_Buffer(), reference.MaxPivot, reference.Hierarchy.Peek_Buffer(), pivots);
+	return false;
+}
+
+int W3DValidatorClass::Validate(const void *data, unsigned long size)
+{
+	Errors.clear();
+	Hierarchies.clear();
+	Unresolved.clear();
+	Object = "";
+	TopOffset = 0;
+	MappedChunkLoadClass cload(data, size);
+	Check_Chunks(cload, (const unsigned char *)data, size, 0);
+	// NOTE: a hierarchy can come after the things using it, so nothing is resolved until the whole file has been seen
+	std::vector<W3DHierarchyReference> references;
+	references.swap(Unresolved);
+	for (const W3DHierarchyReference &reference : references)
+	{
+		auto hierarchy = std::find_if(Hierarchies.begin(), Hierarchies.end(), [&](const W3DHierarchyInfo &info) { return !_stricmp(info.Name, reference.Hierarchy); });
+		if (hierarchy == Hierarchies.end())
+		{
+			Unresolved.push_back(reference);
+			continue;
+		}
+		StringClass error;
+		if (!Check_Reference(reference, hierarchy->Pivots, error))
+		{
+			Errors.push_back(error);
+		}
+	}
+	return (int)Errors.size();
+}
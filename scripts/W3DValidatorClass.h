@@ -0,0 +1,91 @@
+#pragma once
+#include "engine_string.h"
+#include <vector>
+
+class MappedChunkLoadClass;
+
+struct W3DHierarchyInfo
+{
+	StringClass Name;
+	int Pivots;
+};
+
+// An animation or HLOD that uses pivots of a hierarchy by name. The hierarchy usually lives in another file so these
+// can only be checked once every file has been looked at.
+struct W3DHierarchyReference
+{
+	StringClass Hierarchy;
+	StringClass Object; // the animation or HLOD doing the referencing, for messages
+	int MaxPivot; // highest pivot used, -1 if none
+};
+
+// Checks a W3D file for internal consistency in a single pass over its chunks: chunk sizes that don't fit inside their
+// parent, triangles that use vertices the mesh doesn't have, AABTree nodes and polygon indices out of range, pivots
+// whose parent isn't an earlier pivot, HLOD sub objects and animation channels using pivots the hierarchy doesn't have
+// and animation channels with frames outside the animation.
+// References to hierarchies in other files are handed back instead of being checked, so files can be validated in any
+// order (and on any number of threads, one instance each) and the references checked once they're all done.
+class SCRIPTS_API W3DValidatorClass
+{
+	// NOTE: none of the objects checked can be inside one another so there only ever needs to be one of each of these
+	struct MeshState
+	{
+		bool HasHeader = false;
+		uint32 Vertices = 0;
+		uint32 Tris = 0;
+		bool HasTreeHeader = false;
+		uint32 Nodes = 0;
+		uint32 Polys = 0;
+	};
+	struct HierarchyState
+	{
+		bool HasHeader = false;
+		StringClass Name;
+		uint32 Pivots = 0;
+	};
+	struct AnimState
+	{
+		bool HasHeader = false;
+		StringClass HierarchyName;
+		uint32 Frames = 0;
+		int Flavor = -1; // -1 for uncompressed animations
+		int MaxPivot = -1;
+	};
+	struct HLodState
+	{
+		bool HasHeader = false;
+		StringClass HierarchyName;
+		int MaxPivot = -1;
+	};
+	std::vector<StringClass> Errors;
+	std::vector<W3DHierarchyInfo> Hierarchies;
+	std::vector<W3DHierarchyReference> Unresolved;
+	unsigned long TopOffset; // offset in the file of the top level chunk being checked
+	StringClass Object; // the object being checked, for messages
+	MeshState Mesh;
+	HierarchyState Hierarchy;
+	AnimState Anim;
+	HLodState HLod;
+	void Error(MappedChunkLoadClass &cload, unsigned long offset, const char *format, ...);
+	bool Check_Array(MappedChunkLoadClass &cload, const char *what, unsigned long header, unsigned long size, uint32 expected, bool known);
+	void Check_Chunks(MappedChunkLoadClass &cload, const unsigned char *payload, unsigned long length, uint32 parent);
+	void Check_Chunk(MappedChunkLoadClass &cload, uint32 parent);
+	void Check_Mesh_Chunk(MappedChunkLoadClass &cload);
+	void Check_AABTree_Chunk(MappedChunkLoadClass &cload);
+	void Check_Hierarchy_Chunk(MappedChunkLoadClass &cload);
+	void Check_Animation_Chunk(MappedChunkLoadClass &cload);
+	void Check_Frames(MappedChunkLoadClass &cload, const char *what, const uint32 *timecodes, int count, int stride, uint32 mask);
+	void Check_Pivot(int pivot);
+	void Add_Reference(const StringClass &hierarchy, int maxpivot);
+public:
+	W3DValidatorClass() : TopOffset(0) {}
+	// Checks a whole file that is already in memory and returns the number of errors found in it.
+	int Validate(const void *data, unsigned long size);
+	const std::vector<StringClass> &Get_Errors() const { return Errors; }
+	// Hierarchies in the last file.
+	const std::vector<W3DHierarchyInfo> &Get_Hierarchies() const { return Hierarchies; }
+	// References from the last file to hierarchies that weren't in it.
+	const std::vector<W3DHierarchyReference> &Get_Unresolved() const { return Unresolved; }
+	// Returns false and fills in error if reference uses a pivot a hierarchy with that many pivots doesn't have.
+	static bool Check_Reference(const W3DHierarchyReference &reference, int pivots, StringClass &error);
+};
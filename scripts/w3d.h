@@ -67,6 +67,15 @@ enum class W3DChunkType : uint32
 	AABBTREE_HEADER,
 	AABBTREE_POLYINDICES,
 	AABBTREE_NODES,
+	BONE_PALETTES                 = 0x000000A0,
+	BONE_PALETTE_HEADER,
+	BONE_PALETTE,
+	BONE_PALETTE_IDS,
+	QUANTIZED_VERTICES            = 0x000000B0,
+	QUANTIZED_VERTEX_NORMALS,
+	QUANTIZED_TANGENTS,
+	QUANTIZED_BINORMALS,
+	QUANTIZED_STAGE_TEXCOORDS,
 	HIERARCHY                     = 0x00000100,
 	HIERARCHY_HEADER,
 	PIVOTS,
@@ -792,6 +801,60 @@ struct W3dDeformData
 	W3dRGBAStruct			Color;
 	uint32					reserved[2];
 };
+// QUANTIZED_VERTICES starts with this header followed by 3 uint16 per vertex, position = Min + value * Scale
+struct W3dQuantizedVectorHeaderStruct
+{
+	W3dVectorStruct			Min;
+	W3dVectorStruct			Scale;
+};
+// QUANTIZED_STAGE_TEXCOORDS starts with this header followed by 2 uint16 per vertex, texcoord = Min + value * Scale
+struct W3dQuantizedTexCoordHeaderStruct
+{
+	W3dTexCoordStruct		Min;
+	W3dTexCoordStruct		Scale;
+};
+// QUANTIZED_VERTEX_NORMALS, QUANTIZED_TANGENTS and QUANTIZED_BINORMALS hold 2 sint16 per vertex, octahedral encoded
+inline void W3d_Octahedral_Encode(const W3dVectorStruct& v, sint16* out)
+{
+	float l = fabsf(v.X) + fabsf(v.Y) + fabsf(v.Z);
+	float x = l > 0.0f ? v.X / l : 0.0f;
+	float y = l > 0.0f ? v.Y / l : 0.0f;
+
+	if (v.Z < 0.0f)
+	{
+		float ox = x;
+		x = (1.0f - fabsf(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - fabsf(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	out[0] = (sint16)floorf(x * 32767.0f + 0.5f);
+	out[1] = (sint16)floorf(y * 32767.0f + 0.5f);
+}
+inline void W3d_Octahedral_Decode(const sint16* in, W3dVectorStruct& v)
+{
+	float x = in[0] / 32767.0f;
+	float y = in[1] / 32767.0f;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+
+	if (z < 0.0f)
+	{
+		float ox = x;
+		x = (1.0f - fabsf(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - fabsf(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	float l = sqrtf(x * x + y * y + z * z);
+	v.X = x / l;
+	v.Y = y / l;
+	v.Z = z / l;
+}
+struct W3dBonePaletteHeaderStruct
+{
+	uint32					PaletteSize;		// most bones a palette may hold
+	uint32					PaletteCount;		// followed by this many BONE_PALETTE chunks (arrays of uint16 bone indices)
+	uint32					SplitVertexCount;	// extra vertex copies needed so every palette owns its vertices
+	uint32					Padding[1];
+};
 struct W3dMeshAABTreeHeader
 {
 	uint32					NodeCount;
@@ -928,6 +991,18 @@ struct W3dAdaptiveDeltaAnimChannelStruct
 	uint32					Data[1];
 
 };
+// Adaptive delta data is the frame 0 vector followed by a packet per 16 frames per vector element: a filter index byte and
+// 16 signed 4 bit deltas.
+// Each frame adds delta * W3d_Adaptive_Delta_Filter(index) * Scale to the previous one.
+inline float W3d_Adaptive_Delta_Filter(int index)
+{
+	if (index < 16)
+	{
+		return (float)pow(10.0, index - 8);
+	}
+
+	return (float)(1.0 - sin(1.5707963267948966 * (index - 16) / 240.0));
+}
 enum
 {
 	ANIM_FLAVOR_NEW_TIMECODED = 0,
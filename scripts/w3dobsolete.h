@@ -95,6 +95,17 @@ enum ChunkType {
 	W3D_CHUNK_AABTREE_POLYINDICES,                                  // array of uint32 polygon indices with count=mesh.PolyCount
 	W3D_CHUNK_AABTREE_NODES,                                        // array of W3dMeshAABTreeNode's with count=aabheader.NodeCount
 
+	W3D_CHUNK_BONE_PALETTES = 0x000000A0,        // bone palette partitioning of a skinned mesh
+	W3D_CHUNK_BONE_PALETTE_HEADER,                                  // W3dBonePaletteHeaderStruct
+	W3D_CHUNK_BONE_PALETTE,                                         // array of uint16 bone indices, one chunk per palette
+	W3D_CHUNK_BONE_PALETTE_IDS,                                     // array of uint16 palette indices with count=mesh.PolyCount
+
+	W3D_CHUNK_QUANTIZED_VERTICES = 0x000000B0,        // W3dQuantizedVectorHeaderStruct then 3 uint16 per vertex, replaces W3D_CHUNK_VERTICES
+	W3D_CHUNK_QUANTIZED_VERTEX_NORMALS,                             // 2 sint16 per vertex octahedral encoded, replaces W3D_CHUNK_VERTEX_NORMALS
+	W3D_CHUNK_QUANTIZED_TANGENTS,                                   // 2 sint16 per vertex octahedral encoded, replaces W3D_CHUNK_TANGENTS
+	W3D_CHUNK_QUANTIZED_BINORMALS,                                  // 2 sint16 per vertex octahedral encoded, replaces W3D_CHUNK_BINORMALS
+	W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS,                            // W3dQuantizedTexCoordHeaderStruct then 2 uint16 per vertex, replaces W3D_CHUNK_STAGE_TEXCOORDS
+
 	W3D_CHUNK_HIERARCHY = 0x00000100,        // hierarchy tree definition
 	W3D_CHUNK_HIERARCHY_HEADER,
 	W3D_CHUNK_PIVOTS,
@@ -0,0 +1,5 @@
+#ifndef W3DMAPPER_INCLUDE__GENERAL_H
+#define W3DMAPPER_INCLUDE__GENERAL_H
+#include "Defines.h"
+#include "Standard.h"
+#endif
\ No newline at end of file
@@ -0,0 +1,695 @@
+#include "General.h"
+#include <chrono>
+#include <cfloat>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "BufferedFileClass.h"
+#include "chunkclass.h"
+#include "w3d.h"
+
+// Re-encodes the uncompressed animations of a set of W3D files with every compression flavor the exporter writes and
+// reports the size, encode time and pivot position error of each one, per animation and over the whole corpus.
+// The encoders follow the ones in w3dexport.cpp so the numbers match what an export with the same tolerances produces,
+// including the rotation budget that grows for short bones so their tip moves no further than the translation error.
+//
+// usage: w3danimbench [-t translation error] [-r rotation error] [-d adaptive delta error] file.w3d ...
+//
+// The hierarchy of an animation is taken from any of the files given, or from <hierarchy name>.w3d next to the animation.
+
+enum
+{
+	MODE_RAW,
+	MODE_TIMECODED,
+	MODE_ADAPTIVE_DELTA,
+	MODE_COUNT
+};
+
+const char *ModeNames[MODE_COUNT] = { "Uncompressed", "TimeCoded", "AdaptiveDelta" };
+
+struct PivotInfo
+{
+	int Parent;
+	float Translation[3];
+	float Rotation[4];
+};
+
+struct HierarchyInfo
+{
+	std::string Name;
+	std::vector<PivotInfo> Pivots;
+};
+
+struct ChannelInfo
+{
+	int Pivot;
+	int Flags;
+	int VectorLen;
+	std::vector<float> Frames; // every frame of the animation, frames outside the stored range hold the default value
+};
+
+struct AnimationInfo
+{
+	std::string Name;
+	std::string HierarchyName;
+	std::string File;
+	int NumFrames;
+	int FrameRate;
+	unsigned int RawBytes;
+	std::vector<ChannelInfo> Channels;
+};
+
+struct ModeResult
+{
+	uint64 Bytes = 0;
+	double EncodeTime = 0.0;
+	float MaxError = 0.0f;
+	double SquaredError = 0.0;
+	uint64 Samples = 0;
+	int OverTolerance = 0;
+
+	void Add(const ModeResult &r)
+	{
+		Bytes += r.Bytes;
+		EncodeTime += r.EncodeTime;
+		MaxError = r.MaxError > MaxError ? r.MaxError : MaxError;
+		SquaredError += r.SquaredError;
+		Samples += r.Samples;
+		OverTolerance += r.OverTolerance;
+	}
+};
+
+struct Tolerances
+{
+	float Translation = 0.002f;
+	float Rotation = 0.003f;
+	float AdaptiveDelta = 0.001f;
+};
+
+std::unordered_map<std::string, HierarchyInfo> hierarchies;
+std::vector<AnimationInfo> animations;
+
+std::string UpperCase(const char *str)
+{
+	std::string s = str;
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		s[i] = (char)toupper((unsigned char)s[i]);
+	}
+	return s;
+}
+
+void LoadHierarchy(ChunkLoadClass &cload)
+{
+	HierarchyInfo h;
+	while (cload.Open_Chunk())
+	{
+		if (cload.Is_Cur_Chunk_ID(W3DChunkType::HIERARCHY_HEADER))
+		{
+			W3dHierarchyStruct header;
+			cload.SimpleRead(header);
+			h.Name = UpperCase(header.Name);
+		}
+		else if (cload.Is_Cur_Chunk_ID(W3DChunkType::PIVOTS))
+		{
+			int count = cload.Cur_Chunk_Length() / sizeof(W3dPivotStruct);
+			for (int i = 0; i < count; i++)
+			{
+				W3dPivotStruct pivot;
+				cload.SimpleRead(pivot);
+				PivotInfo p;
+				p.Parent = (int)pivot.ParentIdx;
+				p.Translation[0] = pivot.Translation.X;
+				p.Translation[1] = pivot.Translation.Y;
+				p.Translation[2] = pivot.Translation.Z;
+				memcpy(p.Rotation, pivot.Rotation.Q, sizeof(p.Rotation));
+				h.Pivots.push_back(p);
+			}
+		}
+		cload.Close_Chunk();
+	}
+	if (!h.Name.empty())
+	{
+		hierarchies[h.Name] = h;
+	}
+}
+
+void LoadAnimation(ChunkLoadClass &cload, const char *filename)
+{
+	AnimationInfo a;
+	a.File = filename;
+	a.NumFrames = 0;
+	a.FrameRate = 0;
+	a.RawBytes = 0;
+	while (cload.Open_Chunk())
+	{
+		if (cload.Is_Cur_Chunk_ID(W3DChunkType::ANIMATION_HEADER))
+		{
+			W3dAnimHeaderStruct header;
+			cload.SimpleRead(header);
+			a.Name = header.Name;
+			a.HierarchyName = UpperCase(header.HierarchyName);
+			a.NumFrames = header.NumFrames;
+			a.FrameRate = header.FrameRate;
+		}
+		else if (cload.Is_Cur_Chunk_ID(W3DChunkType::ANIMATION_CHANNEL))
+		{
+			unsigned int length = cload.Cur_Chunk_Length();
+			const unsigned int headersize = offsetof(W3dAnimChannelStruct, Data);
+			std::vector<char> chunkdata(length > headersize ? length : headersize);
+			if (cload.Read(chunkdata.data(), length) != (long)length || length < headersize)
+			{
+				fprintf(stderr, "%s: animation %s has a truncated channel\n", filename, a.Name.c_str());
+				cload.Close_Chunk();
+				continue;
+			}
+			W3dAnimChannelStruct *channel = (W3dAnimChannelStruct *)chunkdata.data();
+			// only the motion channels move pivots, the rest are carried over unchanged by every flavor
+			if (channel->Flags == ANIM_CHANNEL_X || channel->Flags == ANIM_CHANNEL_Y || channel->Flags == ANIM_CHANNEL_Z || channel->Flags == ANIM_CHANNEL_Q)
+			{
+				int vectorlen = channel->Flags == ANIM_CHANNEL_Q ? 4 : 1;
+				if (channel->VectorLen != vectorlen || channel->FirstFrame > channel->LastFrame || headersize + ((uint64)channel->LastFrame - channel->FirstFrame + 1) * vectorlen * sizeof(float) > length)
+				{
+					fprintf(stderr, "%s: animation %s has a malformed channel for pivot %d\n", filename, a.Name.c_str(), (int)channel->Pivot);
+					cload.Close_Chunk();
+					continue;
+				}
+				ChannelInfo c;
+				c.Pivot = channel->Pivot;
+				c.Flags = channel->Flags;
+				c.VectorLen = channel->VectorLen;
+				c.Frames.assign(a.NumFrames * c.VectorLen, 0.0f);
+				for (int i = 0; i < a.NumFrames; i++)
+				{
+					if (i >= channel->FirstFrame && i <= channel->LastFrame)
+					{
+						memcpy(&c.Frames[i * c.VectorLen], &channel->Data[(i - channel->FirstFrame) * c.VectorLen], c.VectorLen * sizeof(float));
+					}
+					else if (c.VectorLen == 4)
+					{
+						c.Frames[i * 4 + 3] = 1.0f;
+					}
+				}
+				a.RawBytes += cload.Cur_Chunk_Length() + sizeof(ChunkHeader);
+				a.Channels.push_back(c);
+			}
+		}
+		cload.Close_Chunk();
+	}
+	if (a.NumFrames)
+	{
+		animations.push_back(a);
+	}
+}
+
+bool LoadFile(const char *filename)
+{
+	BufferedFileClass file(filename);
+	if (!file.Open(1))
+	{
+		return false;
+	}
+	ChunkLoadClass cload(&file);
+	while (cload.Open_Chunk())
+	{
+		if (cload.Is_Cur_Chunk_ID(W3DChunkType::HIERARCHY))
+		{
+			LoadHierarchy(cload);
+		}
+		else if (cload.Is_Cur_Chunk_ID(W3DChunkType::ANIMATION))
+		{
+			LoadAnimation(cload, filename);
+		}
+		cload.Close_Chunk();
+	}
+	return true;
+}
+
+void AlignQuaternions(std::vector<float> &frames, int vectorlen)
+{
+	if (vectorlen != 4)
+	{
+		return;
+	}
+	for (size_t i = 4; i < frames.size(); i += 4)
+	{
+		float *q1 = &frames[i - 4];
+		float *q2 = &frames[i];
+		if (q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3] < 0.0f)
+		{
+			q2[0] = -q2[0];
+			q2[1] = -q2[1];
+			q2[2] = -q2[2];
+			q2[3] = -q2[3];
+		}
+	}
+}
+
+void Interpolate(const float *v1, const float *v2, float t, int vectorlen, float *result)
+{
+	if (vectorlen != 4)
+	{
+		for (int i = 0; i < vectorlen; i++)
+		{
+			result[i] = v1[i] + (v2[i] - v1[i]) * t;
+		}
+		return;
+	}
+	float cosom = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2] + v1[3] * v2[3];
+	float sign = 1.0f;
+	if (cosom < 0.0f)
+	{
+		cosom = -cosom;
+		sign = -1.0f;
+	}
+	float s1 = 1.0f - t;
+	float s2 = t;
+	if (cosom < 0.9999f)
+	{
+		float omega = acosf(cosom);
+		float sinom = sinf(omega);
+		s1 = sinf(s1 * omega) / sinom;
+		s2 = sinf(s2 * omega) / sinom;
+	}
+	s2 *= sign;
+	float len = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		result[i] = v1[i] * s1 + v2[i] * s2;
+		len += result[i] * result[i];
+	}
+	len = 1.0f / sqrtf(len);
+	for (int i = 0; i < 4; i++)
+	{
+		result[i] *= len;
+	}
+}
+
+// same measure as AnimChannel::KeyError in the exporter, units for scalars and degrees for quaternions
+float KeyError(const float *v1, const float *v2, float t, const float *v, int vectorlen)
+{
+	float q[4];
+	Interpolate(v1, v2, t, vectorlen, q);
+	if (vectorlen != 4)
+	{
+		return fabsf(q[0] - v[0]);
+	}
+	float sign = q[0] * v[0] + q[1] * v[1] + q[2] * v[2] + q[3] * v[3] < 0.0f ? -1.0f : 1.0f;
+	float d = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		float f = q[i] * sign - v[i];
+		d += f * f;
+	}
+	d = sqrtf(d) * 0.5f;
+	return asinf(d > 1.0f ? 1.0f : d) * 4.0f * 57.29578f;
+}
+
+float SpanError(const std::vector<float> &frames, int vectorlen, int key1, int key2)
+{
+	float error = 0.0f;
+	for (int i = key1 + 1; i < key2; i++)
+	{
+		float e = KeyError(&frames[key1 * vectorlen], &frames[key2 * vectorlen], (float)(i - key1) / (key2 - key1), &frames[i * vectorlen], vectorlen);
+		error = e > error ? e : error;
+	}
+	return error;
+}
+
+unsigned int EncodeTimeCoded(const ChannelInfo &c, int numframes, float maxerror, std::vector<float> &decoded)
+{
+	const int maxspan = 256;
+	std::vector<float> frames = c.Frames;
+	AlignQuaternions(frames, c.VectorLen);
+	std::vector<int> keys;
+	keys.push_back(0);
+	int key = 0;
+	while (key < numframes - 1)
+	{
+		int next = key + 1;
+		while (next + 1 < numframes && next + 1 - key <= maxspan && SpanError(frames, c.VectorLen, key, next + 1) <= maxerror)
+		{
+			next++;
+		}
+		keys.push_back(next);
+		key = next;
+	}
+	decoded.resize(frames.size());
+	memcpy(decoded.data(), frames.data(), c.VectorLen * sizeof(float));
+	for (size_t i = 1; i < keys.size(); i++)
+	{
+		int key1 = keys[i - 1];
+		int key2 = keys[i];
+		for (int j = key1 + 1; j <= key2; j++)
+		{
+			Interpolate(&frames[key1 * c.VectorLen], &frames[key2 * c.VectorLen], (float)(j - key1) / (key2 - key1), c.VectorLen, &decoded[j * c.VectorLen]);
+		}
+	}
+	return sizeof(ChunkHeader) + sizeof(W3dTimeCodedAnimChannelStruct) - sizeof(uint32) + (unsigned int)keys.size() * (c.VectorLen + 1) * sizeof(uint32);
+}
+
+// returns the chunk size, decoded receives what the runtime will play back and error the largest difference to the source
+unsigned int EncodeAdaptiveDelta(const ChannelInfo &c, int numframes, std::vector<float> &decoded, float &error)
+{
+	static std::vector<float> filters;
+	if (filters.empty())
+	{
+		filters.resize(256);
+		for (int i = 0; i < 256; i++)
+		{
+			filters[i] = W3d_Adaptive_Delta_Filter(i);
+		}
+	}
+	std::vector<float> frames = c.Frames;
+	AlignQuaternions(frames, c.VectorLen);
+	int vectorlen = c.VectorLen;
+	float largest = 0.0f;
+	for (int i = 1; i < numframes; i++)
+	{
+		for (int j = 0; j < vectorlen; j++)
+		{
+			float d = fabsf(frames[i * vectorlen + j] - frames[(i - 1) * vectorlen + j]);
+			largest = d > largest ? d : largest;
+		}
+	}
+	float scale = largest / 7.0f;
+	int blocks = (numframes + 15) >> 4;
+	decoded.resize(frames.size());
+	memcpy(decoded.data(), frames.data(), vectorlen * sizeof(float));
+	error = 0.0f;
+	for (int i = 0; i < blocks; i++)
+	{
+		for (int j = 0; j < vectorlen; j++)
+		{
+			float start = decoded[i * 16 * vectorlen + j];
+			float besterror = FLT_MAX;
+			float beststep = 0.0f;
+			int bestdeltas[16] = {};
+			for (int f = 0; f < 256 && besterror > 0.0f; f++)
+			{
+				float step = filters[f] * scale;
+				float value = start;
+				float e = 0.0f;
+				int deltas[16] = {};
+				for (int k = 0; k < 16 && e < besterror; k++)
+				{
+					int frame = i * 16 + k + 1;
+					if (frame >= numframes)
+					{
+						continue;
+					}
+					float target = frames[frame * vectorlen + j];
+					if (step > 0.0f)
+					{
+						float q = floorf((target - value) / step + 0.5f);
+						deltas[k] = q < -8.0f ? -8 : (q > 7.0f ? 7 : (int)q);
+						value += step * deltas[k];
+					}
+					float d = fabsf(value - target);
+					e = d > e ? d : e;
+				}
+				if (e < besterror)
+				{
+					besterror = e;
+					beststep = step;
+					memcpy(bestdeltas, deltas, sizeof(deltas));
+				}
+			}
+			float value = start;
+			for (int k = 0; k < 16 && i * 16 + k + 1 < numframes; k++)
+			{
+				value += beststep * bestdeltas[k];
+				decoded[(i * 16 + k + 1) * vectorlen + j] = value;
+			}
+			error = besterror > error ? besterror : error;
+		}
+	}
+	return sizeof(ChunkHeader) + sizeof(W3dAdaptiveDeltaAnimChannelStruct) - sizeof(uint32) + vectorlen * sizeof(float) + blocks * vectorlen * 9;
+}
+
+struct Transform
+{
+	float M[3][4];
+
+	void Set(const float *q, const float *t)
+	{
+		float x = q[0];
+		float y = q[1];
+		float z = q[2];
+		float w = q[3];
+		float len = x * x + y * y + z * z + w * w;
+		float s = len > 0.0f ? 2.0f / len : 0.0f;
+		M[0][0] = 1.0f - s * (y * y + z * z);
+		M[0][1] = s * (x * y - z * w);
+		M[0][2] = s * (z * x + y * w);
+		M[1][0] = s * (x * y + z * w);
+		M[1][1] = 1.0f - s * (z * z + x * x);
+		M[1][2] = s * (y * z - x * w);
+		M[2][0] = s * (z * x - y * w);
+		M[2][1] = s * (y * z + x * w);
+		M[2][2] = 1.0f - s * (y * y + x * x);
+		M[0][3] = t[0];
+		M[1][3] = t[1];
+		M[2][3] = t[2];
+	}
+
+	static Transform Multiply(const Transform &a, const Transform &b)
+	{
+		Transform r;
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				r.M[i][j] = a.M[i][0] * b.M[0][j] + a.M[i][1] * b.M[1][j] + a.M[i][2] * b.M[2][j] + (j == 3 ? a.M[i][3] : 0.0f);
+			}
+		}
+		return r;
+	}
+};
+
+// Poses the hierarchy the way the runtime does, parent * base pivot * channel translation * channel rotation,
+// and returns the world position of every pivot. A pivot position is the tip of the bone leading to it.
+void PosePivots(const HierarchyInfo &h, const std::vector<int> &lookup, const std::vector<std::vector<float>> &channels, int frame, std::vector<Transform> &world)
+{
+	static const float identity[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	static const float zero[3] = { 0.0f, 0.0f, 0.0f };
+	world.resize(h.Pivots.size());
+	for (size_t i = 0; i < h.Pivots.size(); i++)
+	{
+		const PivotInfo &p = h.Pivots[i];
+		Transform base;
+		base.Set(p.Rotation, p.Translation);
+		if (p.Parent >= 0 && p.Parent < (int)i)
+		{
+			base = Transform::Multiply(world[p.Parent], base);
+		}
+		float t[3];
+		for (int j = 0; j < 3; j++)
+		{
+			int c = lookup[i * 4 + j];
+			t[j] = c != -1 ? channels[c][frame] : 0.0f;
+		}
+		int c = lookup[i * 4 + 3];
+		Transform motion;
+		motion.Set(c != -1 ? &channels[c][frame * 4] : identity, zero);
+		motion.M[0][3] = t[0];
+		motion.M[1][3] = t[1];
+		motion.M[2][3] = t[2];
+		world[i] = Transform::Multiply(base, motion);
+	}
+}
+
+void MeasureError(const HierarchyInfo &h, const AnimationInfo &a, const std::vector<int> &lookup, const std::vector<std::vector<float>> &source, const std::vector<std::vector<float>> &decoded, ModeResult &result)
+{
+	std::vector<Transform> p1;
+	std::vector<Transform> p2;
+	for (int frame = 0; frame < a.NumFrames; frame++)
+	{
+		PosePivots(h, lookup, source, frame, p1);
+		PosePivots(h, lookup, decoded, frame, p2);
+		for (size_t i = 0; i < p1.size(); i++)
+		{
+			float dx = p1[i].M[0][3] - p2[i].M[0][3];
+			float dy = p1[i].M[1][3] - p2[i].M[1][3];
+			float dz = p1[i].M[2][3] - p2[i].M[2][3];
+			float d = dx * dx + dy * dy + dz * dz;
+			result.SquaredError += d;
+			result.Samples++;
+			d = sqrtf(d);
+			result.MaxError = d > result.MaxError ? d : result.MaxError;
+		}
+	}
+}
+
+void PrintResult(const char *name, const ModeResult &r, uint64 rawbytes)
+{
+	double rms = r.Samples ? sqrt(r.SquaredError / r.Samples) : 0.0;
+	printf("  %-16s %12llu %7.2f%% %11.3f %12.6f %12.6f %6d\n", name, (unsigned long long)r.Bytes, rawbytes ? 100.0 * r.Bytes / rawbytes : 0.0, r.EncodeTime * 1000.0, r.MaxError, rms, r.OverTolerance);
+}
+
+void PrintHeader()
+{
+	printf("  %-16s %12s %8s %11s %12s %12s %6s\n", "mode", "bytes", "size", "encode ms", "max error", "rms error", "over");
+}
+
+// Loads the hierarchies the files given did not contain. Their files can hold more animations, which get benchmarked as well.
+// NOTE: This has to happen before benchmarking since LoadFile grows animations
+void LoadHierarchies()
+{
+	std::unordered_set<std::string> tried;
+	for (size_t i = 0; i < animations.size(); i++)
+	{
+		if (hierarchies.find(animations[i].HierarchyName) == hierarchies.end() && tried.insert(animations[i].HierarchyName).second)
+		{
+			// the hierarchy usually lives in its own file named after it
+			std::string path = animations[i].File;
+			size_t slash = path.find_last_of("\\/");
+			path = (slash == std::string::npos ? std::string() : path.substr(0, slash + 1)) + animations[i].HierarchyName + ".w3d";
+			LoadFile(path.c_str());
+		}
+	}
+}
+
+// same as HierarchySave::GetBoneLength in the exporter, the distance to the furthest child
+float BoneLength(const HierarchyInfo &h, int pivot)
+{
+	float length = 0.0f;
+	for (size_t i = 0; i < h.Pivots.size(); i++)
+	{
+		if ((int)i != pivot && h.Pivots[i].Parent == pivot)
+		{
+			const float *t = h.Pivots[i].Translation;
+			float l = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+			length = l > length ? l : length;
+		}
+	}
+	return length;
+}
+
+void Benchmark(const AnimationInfo &a, const Tolerances &tolerances, ModeResult *totals)
+{
+	auto iter = hierarchies.find(a.HierarchyName);
+	if (iter == hierarchies.end())
+	{
+		fprintf(stderr, "%s: hierarchy %s for animation %s not found\n", a.File.c_str(), a.HierarchyName.c_str(), a.Name.c_str());
+		return;
+	}
+	const HierarchyInfo &h = iter->second;
+	std::vector<int> lookup(h.Pivots.size() * 4, -1);
+	std::vector<std::vector<float>> source;
+	for (size_t i = 0; i < a.Channels.size(); i++)
+	{
+		const ChannelInfo &c = a.Channels[i];
+		if (c.Pivot >= (int)h.Pivots.size())
+		{
+			fprintf(stderr, "%s: animation %s has a channel for pivot %d but %s only has %d pivots\n", a.File.c_str(), a.Name.c_str(), c.Pivot, a.HierarchyName.c_str(), (int)h.Pivots.size());
+			return;
+		}
+		lookup[c.Pivot * 4 + (c.Flags == ANIM_CHANNEL_Q ? 3 : c.Flags)] = (int)i;
+		source.push_back(c.Frames);
+	}
+	printf("%s: %s (%s, %d frames at %d fps, %d pivots, %d channels)\n", a.File.c_str(), a.Name.c_str(), a.HierarchyName.c_str(), a.NumFrames, a.FrameRate, (int)h.Pivots.size(), (int)a.Channels.size());
+	PrintHeader();
+	for (int mode = 0; mode < MODE_COUNT; mode++)
+	{
+		ModeResult result;
+		std::vector<std::vector<float>> decoded(a.Channels.size());
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < a.Channels.size(); i++)
+		{
+			const ChannelInfo &c = a.Channels[i];
+			if (mode == MODE_RAW)
+			{
+				decoded[i] = c.Frames;
+			}
+			else if (mode == MODE_TIMECODED)
+			{
+				float maxerror = tolerances.Translation;
+				if (c.VectorLen == 4)
+				{
+					// NOTE: same budget as AnimationSave::WriteBoneChannels, MaxRotationError is only the floor
+					float length = BoneLength(h, c.Pivot);
+					maxerror = length > 0.0f && tolerances.Translation / length * 57.29578f > tolerances.Rotation ? tolerances.Translation / length * 57.29578f : tolerances.Rotation;
+				}
+				result.Bytes += EncodeTimeCoded(c, a.NumFrames, maxerror, decoded[i]);
+			}
+			else
+			{
+				float error;
+				result.Bytes += EncodeAdaptiveDelta(c, a.NumFrames, decoded[i], error);
+				// the exporter falls back to time-coded for animations with any of these channels
+				if (error > tolerances.AdaptiveDelta)
+				{
+					result.OverTolerance++;
+				}
+			}
+		}
+		result.EncodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (mode == MODE_RAW)
+		{
+			result.Bytes = a.RawBytes;
+		}
+		MeasureError(h, a, lookup, source, decoded, result);
+		PrintResult(ModeNames[mode], result, a.RawBytes);
+		totals[mode].Add(result);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	Tolerances tolerances;
+	int files = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i][0] == '-' && i + 1 < argc)
+		{
+			float value = (float)atof(argv[i + 1]);
+			switch (argv[i][1])
+			{
+			case 't':
+				tolerances.Translation = value;
+				break;
+			case 'r':
+				tolerances.Rotation = value;
+				break;
+			case 'd':
+				tolerances.AdaptiveDelta = value;
+				break;
+			default:
+				fprintf(stderr, "unknown option %s\n", argv[i]);
+				return 1;
+			}
+			i++;
+		}
+		else if (LoadFile(argv[i]))
+		{
+			files++;
+		}
+		else
+		{
+			fprintf(stderr, "%s: could not be opened\n", argv[i]);
+		}
+	}
+	if (!files)
+	{
+		printf("usage: w3danimbench [-t translation error] [-r rotation error] [-d adaptive delta error] file.w3d ...\n");
+		return 1;
+	}
+	printf("tolerances: translation %g, rotation %g degrees, adaptive delta %g\n\n", tolerances.Translation, tolerances.Rotation, tolerances.AdaptiveDelta);
+	LoadHierarchies();
+	ModeResult totals[MODE_COUNT];
+	for (size_t i = 0; i < animations.size(); i++)
+	{
+		Benchmark(animations[i], tolerances, totals);
+	}
+	printf("corpus: %d files, %d animations\n", files, (int)animations.size());
+	PrintHeader();
+	for (int mode = 0; mode < MODE_COUNT; mode++)
+	{
+		PrintResult(ModeNames[mode], totals[mode], totals[MODE_RAW].Bytes);
+	}
+	return 0;
+}
@@ -0,0 +1,177 @@
+#include "General.h"
+#include <vector>
+#include "MappedFileClass.h"
+#include "chunkclass.h"
+#include "ChunkIndexClass.h"
+
+// Compares two W3D files a chunk at a time using the subtree hashes from ChunkIndexClass and lists only the chunks that changed.
+// Chunks are matched by id and object name and then by order among chunks with the same id and name, so a re-export that
+// only touches one mesh reports that mesh and not everything after it. A chunk whose hash matches is skipped without
+// looking inside it.
+//
+// usage: w3ddiff [-i] old.w3d new.w3d
+//
+// -i uses the chunk index saved next to each file when it is up to date and saves one when it isn't.
+// The exit code is 0 when the files match, 1 when they differ and 2 when a file can't be read.
+
+struct DiffFile
+{
+	MappedFileClass File;
+	ChunkIndexClass Index;
+};
+
+struct DiffCounts
+{
+	int Changed = 0;
+	int Added = 0;
+	int Removed = 0;
+	int Total() const { return Changed + Added + Removed; }
+};
+
+bool LoadFile(DiffFile &file, const char *filename, bool cache)
+{
+	if (!file.File.Open(filename))
+	{
+		fprintf(stderr, "unable to open %s\n", filename);
+		return false;
+	}
+	if (cache)
+	{
+		file.Index.Load_Or_Build(filename, file.File.Get_Data(), file.File.Get_Size());
+	}
+	else
+	{
+		file.Index.Build(file.File.Get_Data(), file.File.Get_Size());
+	}
+	return true;
+}
+
+StringClass GetPath(const ChunkIndexClass &index, int entry)
+{
+	StringClass path;
+	for (; entry >= 0; entry = index.Get(entry).Parent)
+	{
+		StringClass str;
+		if (index.Get_Name(entry))
+		{
+			str.Format("%08X[%s]", index.Get(entry).ID, index.Get_Name(entry));
+		}
+		else
+		{
+			str.Format("%08X", index.Get(entry).ID);
+		}
+		if (!path.Is_Empty())
+		{
+			str += "/";
+			str += path;
+		}
+		path = str;
+	}
+	return path;
+}
+
+bool SameObject(const ChunkIndexClass &a, int entrya, const ChunkIndexClass &b, int entryb)
+{
+	if (a.Get(entrya).ID != b.Get(entryb).ID)
+	{
+		return false;
+	}
+	const char *namea = a.Get_Name(entrya);
+	const char *nameb = b.Get_Name(entryb);
+	if (!namea || !nameb)
+	{
+		return namea == nameb;
+	}
+	return !_stricmp(namea, nameb);
+}
+
+void CompareChildren(const ChunkIndexClass &a, int parenta, const ChunkIndexClass &b, int parentb, DiffCounts &counts)
+{
+	std::vector<int> childrenb;
+	for (int i = b.First_Child(parentb); i >= 0; i = b.Next_Sibling(i))
+	{
+		childrenb.push_back(i);
+	}
+	std::vector<bool> matched(childrenb.size(), false);
+	for (int i = a.First_Child(parenta); i >= 0; i = a.Next_Sibling(i))
+	{
+		size_t j = 0;
+		while (j < childrenb.size() && (matched[j] || !SameObject(a, i, b, childrenb[j])))
+		{
+			j++;
+		}
+		if (j == childrenb.size())
+		{
+			printf("removed %s (%u bytes)\n", GetPath(a, i).Peek_Buffer(), a.Get(i).Length);
+			counts.Removed++;
+			continue;
+		}
+		matched[j] = true;
+		int other = childrenb[j];
+		if (a.Get(i).Hash == b.Get(other).Hash)
+		{
+			continue;
+		}
+		// NOTE: report the chunk itself when it has no children to blame or none of them explain the difference
+		int before = counts.Total();
+		if (a.First_Child(i) >= 0 || b.First_Child(other) >= 0)
+		{
+			CompareChildren(a, i, b, other, counts);
+		}
+		if (counts.Total() == before)
+		{
+			printf("changed %s (%u -> %u bytes)\n", GetPath(b, other).Peek_Buffer(), a.Get(i).Length, b.Get(other).Length);
+			counts.Changed++;
+		}
+	}
+	for (size_t j = 0; j < childrenb.size(); j++)
+	{
+		if (!matched[j])
+		{
+			printf("added %s (%u bytes)\n", GetPath(b, childrenb[j]).Peek_Buffer(), b.Get(childrenb[j]).Length);
+			counts.Added++;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bool cache = false;
+	const char *filenames[2];
+	int files = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-i"))
+		{
+			cache = true;
+		}
+		else if (files < 2)
+		{
+			filenames[files++] = argv[i];
+		}
+		else
+		{
+			files++;
+		}
+	}
+	if (files != 2)
+	{
+		printf("usage: w3ddiff [-i] old.w3d new.w3d\n");
+		return 2;
+	}
+	DiffFile a;
+	DiffFile b;
+	if (!LoadFile(a, filenames[0], cache) || !LoadFile(b, filenames[1], cache))
+	{
+		return 2;
+	}
+	DiffCounts counts;
+	CompareChildren(a.Index, -1, b.Index, -1, counts);
+	if (!counts.Total())
+	{
+		printf("no differences\n");
+		return 0;
+	}
+	printf("%d changed, %d added, %d removed\n", counts.Changed, counts.Added, counts.Removed);
+	return 1;
+}
@@ -26,6 +26,10 @@ namespace W3D::MaxTools
 		void SetTab(W3DExportType tab);
 		void SelectExternalSkeleton(HWND buttonHandle);
 		void RefreshExternalSkeletonButton();
+#ifndef W3X
+		void SelectTakeList(HWND buttonHandle);
+		void RefreshTakeListButton();
+#endif
 		INT_PTR HandleCommand(uint16 controlID, uint16 commandID);
 		INT_PTR HandleSpinner(uint16 controlID);
 
@@ -36,7 +40,6 @@ namespace W3D::MaxTools
 		TabsArray           m_Tabs;
 	};
 
-#ifdef W3X
 	class W3DCompressionDlg
 	{
 	public:
@@ -59,8 +62,10 @@ namespace W3D::MaxTools
 		ICustEdit        * m_MaxRotation;
 		ICustEdit        * m_MaxVisibility;
 		ICustEdit        * m_MaxError;
-	};
+#ifndef W3X
+		ICustEdit        * m_FrameRate;
 #endif
+	};
 
 } // namespace W3D::MaxTools
 
@@ -65,6 +65,27 @@ namespace W3D::MaxTools
 #ifndef W3X
 		bool MeshDeduplication = false;
 		bool NewAABTree = false;
+		// NOTE: Older settings chunks are loaded as a prefix of this struct, including their tail padding.
+		//       Start every group of new members with a 4 byte member so none of them overlap that padding.
+		int ExportCacheSize = 1024; // in megabytes
+		bool ExportCache = false;
+		int BonePaletteSize = 0; // 0 turns bone palette partitioning off
+		float MaxPositionQuantizationError = 0.001f; // in world units
+		bool QuantizeVertices = false;
+		int CompressionTypes = 0; // bit 0 allows time-coded and bit 1 adaptive delta animation, 0 writes the uncompressed channels
+		float MaxTranslationError = 0.002f;
+		float MaxRotationError = 0.003f;
+		float MaxVisibilityError = 0.01f;
+		int KeyReduction = 50;
+		bool ForceKeyReduction = false;
+		bool NonDefaultCompressionSettings = false;
+		float MaxAdaptiveDeltaError = 0.001f;
+		BOOL ReduceKeyPrecision = FALSE; // round time-coded keys to as few mantissa bits as the error budget allows
+		BOOL BatchTakes = FALSE; // export every take in TakeListFileName to its own file instead of the frame range above
+		MCHAR TakeListFileDirectory[MAX_PATH] = {};
+		MCHAR TakeListFileName[MAX_PATH] = {};
+		int TargetFrameRate = 0; // resample the captured frames to this rate before compression, 0 keeps the scene rate
+		float MaxUnitQuantizationError = 0.001f; // normals, tangents, binormals and texture coordinates
 #else
 		bool NonDefaultCompressionSettings = false;
 		int CompressionTypes = 3;
@@ -104,6 +125,7 @@ namespace W3D::MaxTools
 		bool ExportAnimation(const char *name, ChunkSaveClass &csave, INode *node);
 		bool ExportGeometry(const char *name, ChunkSaveClass &csave, INode *node, MeshConnection **connection);
 		bool ExportHlod(const char *name, const char *hierarchyname, ChunkSaveClass &csave, MeshConnection **connections, int nodecount);
+		bool ExportTakes(INode *node);
 #else
 		void ExportData(char* name, XMLWriter& csave);
 		bool ExportHierarchy(const char* name, XMLWriter& csave, INode* node);
@@ -116,6 +138,10 @@ namespace W3D::MaxTools
 
 		W3DExportSettings m_Settings;
 		char Path[MAX_PATH];
+#ifndef W3X
+		char ExportPath[MAX_PATH];
+		char ExportFileName[MAX_PATH]; // file chosen in the export dialog, empty if it isn't being written
+#endif
 		ExpInterface *ExpInt;
 		Interface *Int;
 		TimeValue Time;
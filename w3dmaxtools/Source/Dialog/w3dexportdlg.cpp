@@ -190,11 +190,32 @@ namespace W3D::MaxTools
 #ifndef W3X
 		SetCheckBox(root, IDC_DEDUPLICATE, m_Settings.MeshDeduplication);
 		SetCheckBox(root, IDC_NEWAABTREE, m_Settings.NewAABTree);
+		SetCheckBox(root, IDC_EXPORT_CACHE, m_Settings.ExportCache);
+		SetCheckBox(root, IDC_QUANTIZE_VERTICES, m_Settings.QuantizeVertices);
+
+		if (GetDlgItem(root, IDC_BONE_PALETTE_SPIN))
+		{
+			ReleaseISpinner(SetupIntSpinner(root, IDC_BONE_PALETTE_SPIN, IDC_BONE_PALETTE_EDIT, 0, 256, m_Settings.BonePaletteSize));
+		}
+
+		if (GetDlgItem(root, IDC_POSITION_ERROR_SPIN))
+		{
+			ReleaseISpinner(SetupFloatSpinner(root, IDC_POSITION_ERROR_SPIN, IDC_POSITION_ERROR_EDIT, 0.0f, 1.0f, m_Settings.MaxPositionQuantizationError, 0.0001f));
+		}
+
+		if (GetDlgItem(root, IDC_UNIT_ERROR_SPIN))
+		{
+			ReleaseISpinner(SetupFloatSpinner(root, IDC_UNIT_ERROR_SPIN, IDC_UNIT_ERROR_EDIT, 0.0f, 1.0f, m_Settings.MaxUnitQuantizationError, 0.0001f));
+		}
 #endif
 		SetCheckBox(root, IDC_USE_EXT_SKELETON, m_Settings.UseExistingSkeleton);
 		SetCheckBox(m_DialogRoot, IDC_REVIEW_LOG, m_Settings.ReviewLog);
 		
 		RefreshExternalSkeletonButton();
+#ifndef W3X
+		SetCheckBox(root, IDC_BATCH_TAKES, m_Settings.BatchTakes != FALSE);
+		RefreshTakeListButton();
+#endif
 	}
 
 	void W3DExportDlg::SetTab(W3DExportType tab)
@@ -253,6 +274,47 @@ namespace W3D::MaxTools
 		}
 	}
 
+#ifndef W3X
+	void W3DExportDlg::SelectTakeList(HWND buttonHandle)
+	{
+		ICustButton* button = GetICustButton(buttonHandle);
+		static FilterList s_fl = []() { FilterList fl; fl.Append(_M("Take List (*.txt)")); fl.Append(_M("*.txt")); return
+			fl; }();
+		MSTR fname(m_Settings.TakeListFileName);
+		MSTR dir(m_Settings.TakeListFileDirectory);
+		if (GetCOREInterface16()->DoMaxOpenDialog(GetCOREInterface()->GetMAXHWnd(), _M("Take List"), fname, dir, s_fl))
+		{
+			wcscpy(m_Settings.TakeListFileName, fname);
+			wcscpy(m_Settings.TakeListFileDirectory, dir);
+			RefreshTakeListButton();
+		}
+
+		ReleaseICustButton(button);
+	}
+
+	void W3DExportDlg::RefreshTakeListButton()
+	{
+		HWND takesBrowse = GetDlgItem(m_ActiveTab, IDC_TAKES_BROWSE);
+		if (takesBrowse)
+		{
+			ICustButton* btn = GetICustButton(takesBrowse);
+
+			if (m_Settings.TakeListFileName[0])
+			{
+				MSTR filename;
+				SplitFilename(m_Settings.TakeListFileName, nullptr, &filename, nullptr);
+				btn->SetText(filename);
+			}
+			else
+			{
+				btn->SetText(_M("Take List..."));
+			}
+			btn->Enable(m_Settings.BatchTakes);
+			ReleaseICustButton(btn);
+		}
+	}
+#endif
+
 	INT_PTR W3DExportDlg::HandleCommand(uint16 controlID, uint16 commandID)
 	{
 		switch (controlID)
@@ -270,6 +332,19 @@ namespace W3D::MaxTools
 		case IDC_NEWAABTREE:
 			m_Settings.NewAABTree = IsDlgButtonChecked(m_ActiveTab, controlID);
 			return TRUE;
+		case IDC_EXPORT_CACHE:
+			m_Settings.ExportCache = IsDlgButtonChecked(m_ActiveTab, controlID);
+			return TRUE;
+		case IDC_QUANTIZE_VERTICES:
+			m_Settings.QuantizeVertices = IsDlgButtonChecked(m_ActiveTab, controlID);
+			return TRUE;
+		case IDC_BATCH_TAKES:
+			m_Settings.BatchTakes = IsDlgButtonChecked(m_ActiveTab, controlID);
+			RefreshTakeListButton();
+			return TRUE;
+		case IDC_TAKES_BROWSE:
+			SelectTakeList(GetDlgItem(m_ActiveTab, controlID));
+			return TRUE;
 #endif
 		case IDC_USE_EXT_SKELETON:
 			m_Settings.UseExistingSkeleton = IsDlgButtonChecked(m_ActiveTab, controlID);
@@ -302,14 +377,12 @@ namespace W3D::MaxTools
 			EndDialog(m_DialogRoot, controlID);
 			return TRUE;
 
-#ifdef W3X
 		case IDC_COMPRESSIONSETTINGS:
 			{
 				W3DCompressionDlg dlg(m_Settings, m_DialogRoot);
 				dlg.ShowDialog();
 			}
 			return TRUE;
-#endif
 		}
 
 
@@ -334,11 +407,33 @@ namespace W3D::MaxTools
 			ReleaseISpinner(sc);
 			return TRUE;
 		}
+#ifndef W3X
+		case IDC_BONE_PALETTE_SPIN:
+		{
+			ISpinnerControl* sc = GetISpinner(GetDlgItem(m_ActiveTab, controlID));
+			m_Settings.BonePaletteSize = sc->GetIVal();
+			ReleaseISpinner(sc);
+			return TRUE;
+		}
+		case IDC_POSITION_ERROR_SPIN:
+		{
+			ISpinnerControl* sc = GetISpinner(GetDlgItem(m_ActiveTab, controlID));
+			m_Settings.MaxPositionQuantizationError = sc->GetFVal();
+			ReleaseISpinner(sc);
+			return TRUE;
+		}
+		case IDC_UNIT_ERROR_SPIN:
+		{
+			ISpinnerControl* sc = GetISpinner(GetDlgItem(m_ActiveTab, controlID));
+			m_Settings.MaxUnitQuantizationError = sc->GetFVal();
+			ReleaseISpinner(sc);
+			return TRUE;
+		}
+#endif
 		}
 		return FALSE;
 	}
 
-#ifdef W3X
 	W3DCompressionDlg::W3DCompressionDlg(W3DExportSettings& settings, HWND parent)
 		: m_Settings(settings)
 		, m_Parent(parent)
@@ -346,6 +441,9 @@ namespace W3D::MaxTools
 		, m_MaxTranslation(nullptr)
 		, m_MaxVisibility(nullptr)
 		, m_MaxRotation(nullptr)
+#ifndef W3X
+		, m_FrameRate(nullptr)
+#endif
 	{ }
 
 	INT_PTR W3DCompressionDlg::ShowDialog()
@@ -379,6 +477,9 @@ namespace W3D::MaxTools
 		SetCheckBox(dialogRoot, IDC_TIMECODED, m_Settings.CompressionTypes & 1);
 		SetCheckBox(dialogRoot, IDC_ADAPTIVEDELTA, (m_Settings.CompressionTypes >> 1) & 1);
 		SetCheckBox(dialogRoot, IDC_FORCEKEYREDUCTION, m_Settings.ForceKeyReduction);
+#ifndef W3X
+		SetCheckBox(dialogRoot, IDC_REDUCEPRECISION, m_Settings.ReduceKeyPrecision != FALSE);
+#endif
 		wchar_t buf[128];
 		memset(buf, 0, sizeof(buf));
 		HWND combo = GetDlgItem(dialogRoot, IDC_KEYREDUCTION);
@@ -406,6 +507,11 @@ namespace W3D::MaxTools
 		swprintf(buf, 128, L"%f", m_Settings.MaxAdaptiveDeltaError);
 		m_MaxError = GetICustEdit(GetDlgItem(dialogRoot, IDC_MAXERROR));
 		m_MaxError->SetText(buf);
+#ifndef W3X
+		swprintf(buf, 128, L"%d", m_Settings.TargetFrameRate);
+		m_FrameRate = GetICustEdit(GetDlgItem(dialogRoot, IDC_TARGETFRAMERATE));
+		m_FrameRate->SetText(buf);
+#endif
 	}
 
 	void W3DCompressionDlg::UpdateControls(HWND dialogRoot)
@@ -418,6 +524,9 @@ namespace W3D::MaxTools
 		EnableWindow(GetDlgItem(dialogRoot, IDC_MAXROTATION), timecoded);
 		EnableWindow(GetDlgItem(dialogRoot, IDC_MAXVISIBILITY), timecoded);
 		EnableWindow(GetDlgItem(dialogRoot, IDC_FORCEKEYREDUCTION), timecoded);
+#ifndef W3X
+		EnableWindow(GetDlgItem(dialogRoot, IDC_REDUCEPRECISION), timecoded);
+#endif
 		bool keyreduction = timecoded && IsDlgButtonChecked(dialogRoot, IDC_FORCEKEYREDUCTION);
 		EnableWindow(GetDlgItem(dialogRoot, IDC_KEYREDUCTION), keyreduction);
 		bool adaptivedelta = !usedefault && IsDlgButtonChecked(dialogRoot, IDC_ADAPTIVEDELTA);
@@ -448,16 +557,31 @@ namespace W3D::MaxTools
 
 	void W3DCompressionDlg::OnOk(HWND dialogRoot)
 	{
+#ifndef W3X
+		// NOTE: Resampling is not a compression type, the default settings leave it alone
+		wchar_t rate[128];
+		m_FrameRate->GetText(rate, 128);
+		m_Settings.TargetFrameRate = _wtoi(rate) > 0 ? _wtoi(rate) : 0;
+#endif
+
 		m_Settings.NonDefaultCompressionSettings = IsDlgButtonChecked(dialogRoot, IDC_DEFAULTSETTINGS) != 1;
 		if (!m_Settings.NonDefaultCompressionSettings)
 		{
+#ifndef W3X
+			// NOTE: The default for .w3d files stays the uncompressed channel format.
+			m_Settings.CompressionTypes = 0;
+#else
 			m_Settings.CompressionTypes = 3;
+#endif
 			m_Settings.MaxTranslationError = 0.002f;
 			m_Settings.MaxRotationError = 0.003f;
 			m_Settings.MaxVisibilityError = 0.01f;
 			m_Settings.ForceKeyReduction = false;
 			m_Settings.KeyReduction = 50;
 			m_Settings.MaxAdaptiveDeltaError = 0.001f;
+#ifndef W3X
+			m_Settings.ReduceKeyPrecision = FALSE;
+#endif
 		}
 		else
 		{
@@ -467,6 +591,9 @@ namespace W3D::MaxTools
 			m_Settings.CompressionTypes &= ~2;
 			m_Settings.CompressionTypes |= IsDlgButtonChecked(dialogRoot, IDC_ADAPTIVEDELTA) != 1 ? 0 : 2;
 			m_Settings.ForceKeyReduction = IsDlgButtonChecked(dialogRoot, IDC_FORCEKEYREDUCTION) == 1;
+#ifndef W3X
+			m_Settings.ReduceKeyPrecision = IsDlgButtonChecked(dialogRoot, IDC_REDUCEPRECISION) == 1;
+#endif
 			m_Settings.KeyReduction = (int)SendMessage(GetDlgItem(dialogRoot, IDC_KEYREDUCTION), CB_GETCURSEL, 0, 0) + 1;
 			m_MaxTranslation->GetText(buf, 128);
 			m_Settings.MaxTranslationError = (float)_wtof(buf);
@@ -478,5 +605,4 @@ namespace W3D::MaxTools
 			m_Settings.MaxAdaptiveDeltaError = (float)_wtof(buf);
 		}
 	}
-#endif
 }
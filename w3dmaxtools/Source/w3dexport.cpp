@@ -8,6 +8,7 @@
 #include "EulerAngles.h"
 #include "Dialog/w3dexportdlg.h"
 #include "BufferedFileClass.h"
+#include "AsyncWriteFileClass.h"
 #include "w3d.h"
 #include "matrix3d.h"
 #ifndef W3X
@@ -15,7 +16,6 @@
 #include "w3dutilities.h"
 #else
 #include "w3xutilities.h"
-#include "ramfileclass.h"
 #include "xmlwriter.h"
 #include "pugixml.hpp"
 #endif
@@ -33,8 +33,14 @@
 #include <pbbitmap.h>
 #include <vector>
 #include <deque>
+#include <queue>
 #include <unordered_set>
+#include <algorithm>
+#include <thread>
 #include "CriticalSectionClass.h"
+#include "HashTemplateKeyClass.h"
+#include "ramfileclass.h"
+#include "ParallelFor.h"
 
 #ifdef W3X
 extern unsigned long crc_table[256];
@@ -178,6 +184,7 @@ namespace W3D::MaxTools
 	};
 
 	void Set_Bit(unsigned char* array, int bit, int value);
+	void Set_Bit_Run(unsigned char* array, int first, int count);
 	int Get_Bit(unsigned char const* array, int bit);
 	int First_True_Bit(unsigned char const* array);
 	int First_False_Bit(unsigned char const* array);
@@ -293,6 +300,25 @@ namespace W3D::MaxTools
 		}
 	}
 
+	void Set_Bit_Run(unsigned char* array, int first, int count)
+	{
+		int last = first + count;
+
+		for (; first < last && (first & 7); first++)
+		{
+			array[first / 8] |= 1 << (first & 7);
+		}
+
+		int bytes = (last - first) / 8;
+		memset(&array[first / 8], 0xFF, bytes);
+		first += bytes * 8;
+
+		for (; first < last; first++)
+		{
+			array[first / 8] |= 1 << (first & 7);
+		}
+	}
+
 	int Get_Bit(unsigned char const* array, int bit)
 	{
 		int bit2 = bit;
@@ -585,11 +611,11 @@ namespace W3D::MaxTools
 		void __declspec(noinline) PrintWindow(_Printf_format_string_ const wchar_t* format, ...)
 		{
 			static WideStringClass str;
+			FastCriticalSectionClass::LockClass lock(Mutex); // NOTE: str is shared, animation takes are saved from a worker thread
 			va_list va;
 			va_start(va, format);
 			str.Format_Args(format, va);
 			va_end(va);
-			FastCriticalSectionClass::LockClass lock(Mutex);
 			StringBuilder.insert(StringBuilder.end(), str.Peek_Buffer(), str.Peek_Buffer() + str.Get_Length());
 		}
 
@@ -717,8 +743,94 @@ namespace W3D::MaxTools
 	int LogDataDialogClass::TotalVertexCount = 0;
 
 #ifndef W3X
+	struct MeshContentStruct
+	{
+		char Name[W3D_NAME_LEN];
+		char ContainerName[W3D_NAME_LEN];
+		std::vector<unsigned char> Data;
+	};
+
 	std::unordered_map<Object*, StringClass> ObjectMap;
+	std::unordered_multimap<uint64, MeshContentStruct> MeshContentMap;
 	bool MeshDeduplication = false;
+	bool ExportCache = false;
+	int BonePaletteSize = 0;
+	bool QuantizeVertices = false;
+	float MaxPositionQuantizationError = 0.0f;
+	float MaxUnitQuantizationError = 0.0f;
+	StringClass ExportCachePath;
+
+	// Deletes the least recently used cache files until the cache fits in maxsize megabytes
+	void TrimExportCache(int maxsize)
+	{
+		TT_PROFILER_SCOPE("TrimExportCache");
+
+		struct CacheFileStruct
+		{
+			StringClass Name;
+			uint64 Time;
+			uint64 Size;
+		};
+
+		std::vector<CacheFileStruct> files;
+		uint64 total = 0;
+		StringClass search = ExportCachePath;
+		search += "*.w3c";
+		WIN32_FIND_DATAA data;
+		HANDLE h = FindFirstFileA(search, &data);
+
+		if (h == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+
+		do
+		{
+			CacheFileStruct file;
+			file.Name = data.cFileName;
+			file.Time = ((uint64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+			file.Size = ((uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+			total += file.Size;
+			files.push_back(file);
+		} while (FindNextFileA(h, &data));
+
+		FindClose(h);
+		uint64 limit = (uint64)maxsize * 1024 * 1024;
+
+		if (total <= limit)
+		{
+			return;
+		}
+
+		std::sort(files.begin(), files.end(), [](const CacheFileStruct& a, const CacheFileStruct& b) { return a.Time < b.Time; });
+		int count = 0;
+
+		for (size_t i = 0; i < files.size() && total > limit; i++)
+		{
+			StringClass path = ExportCachePath;
+			path += files[i].Name;
+
+			if (DeleteFileA(path))
+			{
+				total -= files[i].Size;
+				count++;
+			}
+		}
+
+		LogDataDialogClass::WriteLogWindow(L"\nRemoved %d old entries from the export cache\n", count);
+	}
+
+	// Returns the result of save, the buffer keeps whatever was written either way
+	template <typename F> bool SaveToBuffer(std::vector<unsigned char>& buffer, F save)
+	{
+		RAMFileClass file(nullptr, 65536);
+		file.Set_Reallocate(true);
+		file.Open(2);
+		ChunkSaveClass csave(&file);
+		bool result = save(csave);
+		buffer.assign(file.Get_Buffer(), file.Get_Buffer() + file.Get_Length());
+		return result;
+	}
 #endif
 
 	class HierarchySave
@@ -750,6 +862,7 @@ namespace W3D::MaxTools
 		int FindBone(const StringClass& name);
 		int GetBoneIndexForNode(INode* node);
 		Matrix3 GetPivotFixup(int bone);
+		float GetBoneLength(int bone);
 #ifndef W3X
 		bool SaveHierarchy(ChunkSaveClass& csave);
 		bool SaveHierarchyHeader(ChunkSaveClass& csave);
@@ -786,27 +899,46 @@ namespace W3D::MaxTools
 		int EndFrame;
 		int NumFrames;
 		int FrameRate;
-#ifdef W3X
 		W3DExportSettings* ExportStr;
-#endif
 		char Name[W3D_NAME_LEN];
 		Matrix3 Matrix;
-		Matrix3** Transforms;
-		Point3** Angles;
-		BooleanVectorClass* BitChannels;
-		VectorClass<float>* VisibilityChannels;
-		BooleanVectorClass* BinaryMove;
-		BooleanVectorClass HasData;
+		// NOTE: The captured frames are stored bone-major, frame j of bone i is element i * NumFrames + j of every stream.
+		//       The channels read their data straight out of these.
+		std::vector<float> Translations; // separate x, y and z runs of NumFrames floats per bone
+		std::vector<float> Rotations; // 4 floats per frame, already in the W3D quaternion convention
+		std::vector<float> Visibility;
+		std::vector<unsigned char> FrameFlags;
+		std::vector<bool> HasData;
+#ifndef W3X
+		int Flavor; // ANIM_FLAVOR_VALID writes the uncompressed format
+		bool WithinTolerance;
+#endif
+
+		enum
+		{
+			FRAME_VISIBLE = 1,
+			FRAME_BINARY_MOVE = 2,
+		};
+
+		struct BoneChannelStats
+		{
+			WideStringClass Log;
+			int Keys = 0;
+			int Frames = 0;
+			int MissedChannels = 0; // adaptive delta channels that could not stay within tolerance
+			int Shapes[3] = {}; // indexed by AnimChannel::CHANNEL_CONSTANT and friends
+			bool WithinTolerance = true;
+		};
 
 	public:
 		AnimationSave(IScene* scene, INode* node, HierarchySave* hierarchyobject, W3DExportSettings* exportstr, int framerate, const char* name, Matrix3& mat);
 		void CaptureBones();
 		void CaptureFrame(int frame);
 		void CopyTransform(int bone, int frame, Matrix3& transform);
-		void SetAngles(int bone, int frame, float xrot, float yrot, float zrot);
 		void CopyVisibility(int bone, int frame, bool vis, float floatvis);
-		Matrix3 GetTransform(int node, int frame);
 #ifndef W3X
+		void Resample(int framerate);
+		void WriteBoneChannels(ChunkSaveClass& csave, int bone, int maxkeys, BoneChannelStats& stats);
 		bool WriteAnimation(ChunkSaveClass& csave);
 		bool WriteAnimationHeader(ChunkSaveClass& csave);
 		bool WriteAnimationChannels(ChunkSaveClass& csave);
@@ -814,6 +946,7 @@ namespace W3D::MaxTools
 		bool WriteAnimation(XMLWriter& csave);
 		bool WriteAnimationHeader(XMLWriter& csave);
 		bool WriteAnimationChannels(XMLWriter& csave);
+		void WriteBoneChannels(XMLWriter& csave, int bone, int maxkeys, BoneChannelStats& stats);
 #endif
 		~AnimationSave();
 	};
@@ -896,6 +1029,9 @@ namespace W3D::MaxTools
 			char fname[_MAX_FNAME];
 			StringClass n = name;
 			_splitpath(n, drive, dir, fname, nullptr);
+#ifndef W3X
+			sprintf(ExportPath, "%s%s", drive, dir);
+#endif
 
 			if (strlen(fname) >= W3D_NAME_LEN)
 			{
@@ -925,13 +1061,15 @@ namespace W3D::MaxTools
 				((W3DExportSettings*)chunk->data)->AnimFramesEnd = Int->GetAnimRange().End() / GetTicksPerFrame();
 			}
 
-			if (chunk->length == sizeof(OldW3DExportSettings))
+			// NOTE: Settings only ever get new members appended, so older chunks are a prefix of the current struct.
+			if (chunk->length < sizeof(W3DExportSettings))
 			{
-				OldW3DExportSettings* data = (OldW3DExportSettings*)chunk->data;
+				void* data = chunk->data;
+				DWORD length = chunk->length;
 				chunk->length = sizeof(W3DExportSettings);
 				void* alloc = MAX_malloc(chunk->length);
 				chunk->data = new(alloc) W3DExportSettings;
-				memcpy(chunk->data, data, sizeof(OldW3DExportSettings));
+				memcpy(chunk->data, data, length);
 				MAX_free(data);
 			}
 
@@ -1019,16 +1157,36 @@ namespace W3D::MaxTools
 #ifndef W3X
 					MeshDeduplication = m_Settings.MeshDeduplication;
 					ObjectMap.clear();
+					MeshContentMap.clear();
+					ExportCache = m_Settings.ExportCache;
+					BonePaletteSize = m_Settings.BonePaletteSize;
+					QuantizeVertices = m_Settings.QuantizeVertices;
+					MaxPositionQuantizationError = m_Settings.MaxPositionQuantizationError;
+					MaxUnitQuantizationError = m_Settings.MaxUnitQuantizationError;
+
+					if (ExportCache)
+					{
+						StringClass dir = Int->GetDir(APP_PLUGCFG_DIR);
+						ExportCachePath.Format("%s\\W3DExportCache\\", dir.Peek_Buffer());
+						CreateDirectoryA(ExportCachePath, nullptr);
+					}
 #endif
 					LogDataDialogClass::CreateLogDialog(nullptr);
 					StringClass fn = name;
-					BufferedFileClass file(fn);
+					AsyncWriteFileClass file(fn);
+#ifndef W3X
+					// NOTE: batched takes each go to a file of their own, with an existing skeleton there is nothing left to put in the chosen file so it isn't created
+					bool takesonly = m_Settings.ExportType == W3DExportType::PureAnimation && m_Settings.BatchTakes && !m_Settings.ExportSkeleton;
+					strcpy(ExportFileName, takesonly ? "" : fn.Peek_Buffer());
 
+					if (takesonly || file.Open(2))
+#else
 					if (file.Open(2))
+#endif
 					{
 						TT_PROFILER_SCOPE("Export");
 #ifndef W3X
-						ChunkSaveClass csave(&file);
+						ChunkSaveClass csave(takesonly ? nullptr : &file);
 #else
 						XMLWriter csave(&file, true);
 #endif
@@ -1038,6 +1196,11 @@ namespace W3D::MaxTools
 							ExportData(fname, csave);
 						}
 
+						if (!file.Flush())
+						{
+							MessageBox(nullptr, L"Unable to write file.", L"Error", MB_SETFOREGROUND);
+						}
+
 						file.Close();
 						SAFE_DELETE(HierarchyStruct);
 						SAFE_DELETE(OriginNodeList);
@@ -1052,6 +1215,13 @@ namespace W3D::MaxTools
 						MessageBox(nullptr, L"Unable to open file.", L"Error", MB_SETFOREGROUND);
 					}
 
+#ifndef W3X
+					if (ExportCache)
+					{
+						TrimExportCache(m_Settings.ExportCacheSize);
+					}
+#endif
+
 					LogDataDialogClass::PrintTotalVertexCount();
 					LogDataDialogClass::DestroyLogDialog(m_Settings.ReviewLog);
 				}
@@ -1585,6 +1755,28 @@ namespace W3D::MaxTools
 		return Bones[bone].Node;
 	}
 
+	// Distance from the pivot to its furthest child pivot in the base pose, 0 for bones without children
+	float HierarchySave::GetBoneLength(int bone)
+	{
+		float length = 0.0f;
+
+		for (int i = 0; i < BoneCount; i++)
+		{
+			if (i != bone && Bones[i].pivot.ParentIdx == (uint32)bone)
+			{
+				W3dVectorStruct& t = Bones[i].pivot.Translation;
+				float l = sqrtf(t.X * t.X + t.Y * t.Y + t.Z * t.Z);
+
+				if (l > length)
+				{
+					length = l;
+				}
+			}
+		}
+
+		return length;
+	}
+
 	const char* HierarchySave::GetName(int bone)
 	{
 		return Bones[bone].pivot.Name;
@@ -2514,6 +2706,11 @@ namespace W3D::MaxTools
 		}
 
 		virtual ~GeometryExportTaskClass() {};
+
+		// Export runs in three stages: Prepare pulls everything needed out of Max on the main thread,
+		// Build runs on a worker thread and Save writes the result on the main thread in task order.
+		virtual void Prepare(LodData& lod) {}
+		virtual void Build(LodData& lod) {}
 		virtual void Save(LodData& lod) = 0;
 
 		virtual Point3 Build_Vertex_Normal_For_Point(Point3& point, int smoothing)
@@ -4587,6 +4784,12 @@ namespace W3D::MaxTools
 		void Optimize_Mesh(bool keepnormals);
 		void Build_Mesh(bool keepnormals);
 		void Set_World_Info(WorldInfoClass* info) { WorldInfo = info; }
+		WorldInfoClass* Get_World_Info() { return WorldInfo; }
+#ifndef W3X
+		void Get_Input_Key(std::vector<unsigned char>& key);
+		bool Save_Output(ChunkSaveClass& csave);
+		bool Load_Output(ChunkLoadClass& cload);
+#endif
 		int Get_Pass_Count() { return PassCount; }
 		int Get_Vertex_Count() { return VertCount; }
 		int Get_Face_Count() { return FaceCount; }
@@ -6017,6 +6220,251 @@ namespace W3D::MaxTools
 		Optimize_Mesh(keepnormals);
 	}
 
+#ifndef W3X
+	// Everything in VertClass before NextHash and everything in FaceClass after Verts is made of 4 byte values, so these ranges contain no padding
+	constexpr size_t CachedVertSize = offsetof(MeshBuilderClass::VertClass, NextHash);
+	constexpr size_t CachedFaceOffset = offsetof(MeshBuilderClass::FaceClass, SmGroup);
+	constexpr size_t CachedFaceSize = offsetof(MeshBuilderClass::FaceClass, Dist) + sizeof(float) - CachedFaceOffset;
+
+	// Bump this whenever MeshBuilderClass or the AABTree builder produce different output
+	constexpr uint32 ExportCacheVersion = 1;
+
+	enum class ExportCacheChunkType : uint32
+	{
+		HEADER = 0x100,
+		BUILDER,
+		STATS,
+		VERTICES,
+		FACES,
+		AABTREE,
+	};
+
+	void MeshBuilderClass::Get_Input_Key(std::vector<unsigned char>& key)
+	{
+		TT_PROFILER_SCOPE("MeshBuilderClass::Get_Input_Key");
+		size_t pos = key.size();
+		key.resize(pos + CurFace * (CachedVertSize * 3 + CachedFaceSize));
+
+		for (int i = 0; i < CurFace; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				memcpy(&key[pos], &Faces[i].Verts[j], CachedVertSize);
+				pos += CachedVertSize;
+			}
+
+			memcpy(&key[pos], (const char*)&Faces[i] + CachedFaceOffset, CachedFaceSize);
+			pos += CachedFaceSize;
+		}
+	}
+
+	bool MeshBuilderClass::Save_Output(ChunkSaveClass& csave)
+	{
+		TT_PROFILER_SCOPE("MeshBuilderClass::Save_Output");
+
+		if (!csave.Begin_Chunk(ExportCacheChunkType::STATS) || csave.Write(&Stats, sizeof(Stats)) != sizeof(Stats) || !csave.End_Chunk())
+		{
+			return false;
+		}
+
+		if (!csave.Begin_Chunk(ExportCacheChunkType::VERTICES))
+		{
+			return false;
+		}
+
+		unsigned char* vertexes = (unsigned char*)csave.Reserve((unsigned long)(VertCount * CachedVertSize));
+
+		for (int i = 0; i < VertCount; i++)
+		{
+			memcpy(vertexes + i * CachedVertSize, &Vertexes[i], CachedVertSize);
+		}
+
+		if (!csave.End_Chunk() || !csave.Begin_Chunk(ExportCacheChunkType::FACES))
+		{
+			return false;
+		}
+
+		unsigned char* faces = (unsigned char*)csave.Reserve((unsigned long)(FaceCount * CachedFaceSize));
+
+		for (int i = 0; i < FaceCount; i++)
+		{
+			memcpy(faces + i * CachedFaceSize, (const char*)&Faces[i] + CachedFaceOffset, CachedFaceSize);
+		}
+
+		return csave.End_Chunk();
+	}
+
+	bool MeshBuilderClass::Load_Output(ChunkLoadClass& cload)
+	{
+		TT_PROFILER_SCOPE("MeshBuilderClass::Load_Output");
+		MeshStatsStruct stats;
+		bool hasstats = false;
+		std::vector<unsigned char> verts;
+		std::vector<unsigned char> faces;
+
+		while (cload.Open_Chunk())
+		{
+			unsigned long length = cload.Cur_Chunk_Length();
+
+			if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::STATS) && length == sizeof(stats))
+			{
+				hasstats = cload.Read(&stats, length) == (long)length;
+			}
+			else if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::VERTICES) && length % CachedVertSize == 0)
+			{
+				verts.resize(length);
+
+				if (length && cload.Read(verts.data(), length) != (long)length)
+				{
+					return false;
+				}
+			}
+			else if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::FACES) && length % CachedFaceSize == 0)
+			{
+				faces.resize(length);
+
+				if (length && cload.Read(faces.data(), length) != (long)length)
+				{
+					return false;
+				}
+			}
+
+			cload.Close_Chunk();
+		}
+
+		int vertcount = (int)(verts.size() / CachedVertSize);
+		int facecount = (int)(faces.size() / CachedFaceSize);
+
+		// NOTE: Welding only ever removes faces, so the input array is always big enough.
+		if (!hasstats || !vertcount || !facecount || facecount > AllocFaceCount)
+		{
+			return false;
+		}
+
+		if (Vertexes)
+		{
+			delete[] Vertexes;
+		}
+
+		VertCount = vertcount;
+		Vertexes = new VertClass[VertCount];
+
+		for (int i = 0; i < VertCount; i++)
+		{
+			memcpy(&Vertexes[i], &verts[i * CachedVertSize], CachedVertSize);
+		}
+
+		FaceCount = facecount;
+
+		for (int i = 0; i < FaceCount; i++)
+		{
+			memcpy((char*)&Faces[i] + CachedFaceOffset, &faces[i * CachedFaceSize], CachedFaceSize);
+		}
+
+		Stats = stats;
+		State = STATE_MESH_PROCESSED;
+		return true;
+	}
+
+	StringClass GetExportCacheFileName(Hash128 key)
+	{
+		uint64 parts[2];
+		_mm_storeu_si128((__m128i*)parts, key);
+		StringClass str;
+		str.Format("%s%016llx%016llx.w3c", ExportCachePath.Peek_Buffer(), parts[1], parts[0]);
+		return str;
+	}
+
+	bool LoadExportCache(const char* filename, MeshBuilderClass& builder, std::vector<unsigned char>& aabtree)
+	{
+		TT_PROFILER_SCOPE("LoadExportCache");
+		bool hasbuilder = false;
+		bool hasaabtree = false;
+
+		{
+			BufferedFileClass file(filename);
+
+			if (!file.Open(1))
+			{
+				return false;
+			}
+
+			ChunkLoadClass cload(&file);
+			uint32 version = 0;
+
+			while (cload.Open_Chunk())
+			{
+				unsigned long length = cload.Cur_Chunk_Length();
+
+				if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::HEADER) && length == sizeof(version))
+				{
+					cload.Read(&version, sizeof(version));
+				}
+				else if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::BUILDER) && version == ExportCacheVersion)
+				{
+					hasbuilder = builder.Load_Output(cload);
+				}
+				else if (cload.Is_Cur_Chunk_ID(ExportCacheChunkType::AABTREE) && version == ExportCacheVersion)
+				{
+					aabtree.resize(length);
+					hasaabtree = !length || cload.Read(aabtree.data(), length) == (long)length;
+				}
+
+				cload.Close_Chunk();
+			}
+		}
+
+		if (!hasbuilder || !hasaabtree)
+		{
+			return false;
+		}
+
+		// Touch the file so TrimExportCache sees it as recently used
+		HANDLE h = CreateFileA(filename, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (h != INVALID_HANDLE_VALUE)
+		{
+			FILETIME time;
+			GetSystemTimeAsFileTime(&time);
+			SetFileTime(h, nullptr, nullptr, &time);
+			CloseHandle(h);
+		}
+
+		return true;
+	}
+
+	void StoreExportCache(const char* filename, MeshBuilderClass& builder, std::vector<unsigned char>& aabtree)
+	{
+		TT_PROFILER_SCOPE("StoreExportCache");
+		StringClass tempname = filename;
+		tempname += ".tmp";
+		bool result = false;
+
+		{
+			AsyncWriteFileClass file(tempname);
+
+			if (!file.Open(2))
+			{
+				return;
+			}
+
+			ChunkSaveClass csave(&file);
+			uint32 version = ExportCacheVersion;
+			unsigned long size = (unsigned long)aabtree.size();
+			result = csave.Begin_Chunk(ExportCacheChunkType::HEADER) && csave.Write(&version, sizeof(version)) == sizeof(version) && csave.End_Chunk()
+				&& csave.Begin_Chunk(ExportCacheChunkType::BUILDER) && builder.Save_Output(csave) && csave.End_Chunk()
+				&& csave.Begin_Chunk(ExportCacheChunkType::AABTREE) && (!size || csave.Write(aabtree.data(), size) == size) && csave.End_Chunk()
+				&& file.Flush();
+			file.Close();
+		}
+
+		if (!result || !MoveFileExA(tempname, filename, MOVEFILE_REPLACE_EXISTING))
+		{
+			DeleteFileA(tempname);
+		}
+	}
+#endif
+
 	float GetMatrix3Determinant(const Matrix3& m)
 	{
 		return (m[1][1] * m[2][2] - m[2][1] * m[1][2]) * m[0][0] - (m[2][2] * m[1][0] - m[1][2] * m[2][0]) * m[0][1] + (m[2][1] * m[1][0] - m[1][1] * m[2][0]) * m[0][2];
@@ -6154,33 +6602,294 @@ namespace W3D::MaxTools
 		return attributes;
 	}
 
-	class MeshSave
-	{
-		INode* Node;
-		W3DAppDataChunk* ExportFlags;
-		W3DExportSettings* ExportData;
-		W3dMeshHeader3Struct Header;
-		W3dMaterialDescClass Materials;
-		MeshBuilderClass MeshBuilder;
-		TimeValue Time;
-		Matrix3 Transform;
-		Matrix3 ObjectTransform;
-		HierarchySave* Hierarchy;
-		const char* MeshUserText;
-		bool IsDetermenentNegative;
-		W3dVertInfStruct* VertexInfluences;
-		int* MaterialIndex;
-		bool HasSmoothSkin;
-#ifdef W3X
-		std::vector<StringClass>* Includes;
-#endif
-	public:
 #ifndef W3X
-		MeshSave(const char* meshname, const char* containername, INode* node, Mesh* mesh, Matrix3* transform, W3DAppDataChunk* exportflags, W3DExportSettings* exportdata, HierarchySave* hierarchy, TimeValue time, MaxWorldInfoClass* info) :
-			ExportData(exportdata), Node(node), ExportFlags(exportflags), MeshBuilder(1, 255, 64), Time(time), Transform(*transform), Hierarchy(hierarchy), MeshUserText(nullptr), VertexInfluences(nullptr), MaterialIndex(nullptr), HasSmoothSkin(false)
-#else
-		MeshSave(const char* meshname, const char* containername, INode* node, Mesh* mesh, Matrix3* transform, W3DAppDataChunk* exportflags, W3DExportSettings* exportdata, std::vector<StringClass>* includes, HierarchySave* hierarchy, TimeValue time, MaxWorldInfoClass* info) :
-			Node(node), ExportFlags(exportflags), ExportData(exportdata), MeshBuilder(1, 255, 64), Time(time), Transform(*transform), Hierarchy(hierarchy), MeshUserText(nullptr), VertexInfluences(nullptr), MaterialIndex(nullptr), HasSmoothSkin(false), Includes(includes)
+	uint16 QuantizeUNorm16(float value, float min, float scale)
+	{
+		if (scale <= 0.0f)
+		{
+			return 0;
+		}
+
+		float q = floorf((value - min) / scale + 0.5f);
+		return (uint16)(q < 0.0f ? 0.0f : q > 65535.0f ? 65535.0f : q);
+	}
+
+	// Splits a skinned mesh into groups of triangles whose bones fit in a palette of PaletteSize matrices so each group can be skinned in one GPU pass.
+	// Groups are grown greedily across shared vertices, always taking the triangle that adds the fewest new bones, which keeps both the group count
+	// and the number of vertices shared between groups (those have to be duplicated by the loader) low.
+	class BonePaletteBuilderClass
+	{
+	public:
+		std::vector<std::vector<uint16>> Palettes;
+		std::vector<uint16> FacePalettes;
+		int SplitVertexCount = 0;
+		int PaletteSize = 0; // the size actually used, which can be bigger than the one asked for
+
+		void Build(int palettesize, int facecount, const uint32* faceverts, int vertcount, const W3dVertInfStruct* influences)
+		{
+			TT_PROFILER_SCOPE("BonePaletteBuilderClass::Build");
+			constexpr uint16 unassigned = 0xFFFF;
+
+			// a triangle can reference up to 6 different bones
+			if (palettesize < 6)
+			{
+				palettesize = 6;
+			}
+
+			PaletteSize = palettesize;
+			Palettes.clear();
+			FacePalettes.assign(facecount, unassigned);
+			SplitVertexCount = 0;
+			std::vector<uint16> facebones(facecount * 6);
+			std::vector<uint8> facebonecount(facecount, 0);
+			int bonecount = 0;
+
+			for (int i = 0; i < facecount; i++)
+			{
+				for (int j = 0; j < 3; j++)
+				{
+					const W3dVertInfStruct& inf = influences[faceverts[i * 3 + j]];
+
+					for (int k = 0; k < 2; k++)
+					{
+						if (k && !inf.Weight[k])
+						{
+							continue;
+						}
+
+						uint16* bones = &facebones[i * 6];
+						uint8& count = facebonecount[i];
+
+						if (std::find(bones, bones + count, inf.BoneIdx[k]) == bones + count)
+						{
+							bones[count++] = inf.BoneIdx[k];
+						}
+
+						if (inf.BoneIdx[k] >= bonecount)
+						{
+							bonecount = inf.BoneIdx[k] + 1;
+						}
+					}
+				}
+			}
+
+			std::vector<int> vertfacestart(vertcount + 1, 0);
+			std::vector<int> vertfaces(facecount * 3);
+
+			for (int i = 0; i < facecount * 3; i++)
+			{
+				vertfacestart[faceverts[i] + 1]++;
+			}
+
+			for (int i = 0; i < vertcount; i++)
+			{
+				vertfacestart[i + 1] += vertfacestart[i];
+			}
+
+			std::vector<int> vertfacefill(vertfacestart.begin(), vertfacestart.end() - 1);
+
+			for (int i = 0; i < facecount * 3; i++)
+			{
+				vertfaces[vertfacefill[faceverts[i]]++] = i / 3;
+			}
+
+			// the palette each bone or face was last added to or queued for, saves clearing them for every palette
+			std::vector<int> bonepalette(bonecount, -1);
+			std::vector<int> facequeued(facecount, -1);
+			int seed = 0;
+
+			for (;;)
+			{
+				while (seed < facecount && FacePalettes[seed] != unassigned)
+				{
+					seed++;
+				}
+
+				if (seed == facecount)
+				{
+					break;
+				}
+
+				int palette = (int)Palettes.size();
+				Palettes.emplace_back();
+				std::vector<uint16>& bones = Palettes.back();
+
+				auto cost = [&](int face)
+				{
+					int count = 0;
+
+					for (int i = 0; i < facebonecount[face]; i++)
+					{
+						if (bonepalette[facebones[face * 6 + i]] != palette)
+						{
+							count++;
+						}
+					}
+
+					return count;
+				};
+
+				// (new bones, face), the lowest face index wins ties so the result does not depend on anything but the input
+				std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> queue;
+				queue.emplace(cost(seed), seed);
+				facequeued[seed] = palette;
+
+				for (;;)
+				{
+					while (!queue.empty())
+					{
+						std::pair<int, int> top = queue.top();
+						queue.pop();
+						int face = top.second;
+
+						if (FacePalettes[face] != unassigned)
+						{
+							continue;
+						}
+
+						// costs only go down as bones are added, requeue so cheaper faces are still taken first
+						int c = cost(face);
+
+						if (c < top.first)
+						{
+							queue.emplace(c, face);
+							continue;
+						}
+
+						if ((int)bones.size() + c > palettesize)
+						{
+							continue;
+						}
+
+						FacePalettes[face] = (uint16)palette;
+
+						for (int i = 0; i < facebonecount[face]; i++)
+						{
+							uint16 bone = facebones[face * 6 + i];
+
+							if (bonepalette[bone] != palette)
+							{
+								bonepalette[bone] = palette;
+								bones.push_back(bone);
+							}
+						}
+
+						for (int i = 0; i < 3; i++)
+						{
+							uint32 vert = faceverts[face * 3 + i];
+
+							for (int j = vertfacestart[vert]; j < vertfacestart[vert + 1]; j++)
+							{
+								int next = vertfaces[j];
+
+								if (FacePalettes[next] == unassigned && facequeued[next] != palette)
+								{
+									facequeued[next] = palette;
+									queue.emplace(cost(next), next);
+								}
+							}
+						}
+					}
+
+					// nothing connected fits anymore, fill the remaining space with whatever else does
+					for (int i = seed; i < facecount; i++)
+					{
+						if (FacePalettes[i] == unassigned)
+						{
+							int c = cost(i);
+
+							if ((int)bones.size() + c <= palettesize)
+							{
+								facequeued[i] = palette;
+								queue.emplace(c, i);
+							}
+						}
+					}
+
+					if (queue.empty())
+					{
+						break;
+					}
+				}
+
+				std::sort(bones.begin(), bones.end());
+			}
+
+			std::vector<int> vertpalette(vertcount, -1);
+
+			for (int i = 0; i < vertcount; i++)
+			{
+				for (int j = vertfacestart[i]; j < vertfacestart[i + 1]; j++)
+				{
+					int palette = FacePalettes[vertfaces[j]];
+
+					if (vertpalette[i] == -1)
+					{
+						vertpalette[i] = palette;
+					}
+					else if (vertpalette[i] != palette)
+					{
+						// faces are visited in index order, so count each extra palette of this vertex once
+						bool seen = false;
+
+						for (int k = vertfacestart[i]; k < j; k++)
+						{
+							if (FacePalettes[vertfaces[k]] == palette)
+							{
+								seen = true;
+								break;
+							}
+						}
+
+						if (!seen)
+						{
+							SplitVertexCount++;
+						}
+					}
+				}
+			}
+		}
+	};
+#endif
+
+	class MeshSave
+	{
+		INode* Node;
+		W3DAppDataChunk* ExportFlags;
+		W3DExportSettings* ExportData;
+		W3dMeshHeader3Struct Header;
+		W3dMaterialDescClass Materials;
+		MeshBuilderClass MeshBuilder;
+		TimeValue Time;
+		Matrix3 Transform;
+		Matrix3 ObjectTransform;
+		HierarchySave* Hierarchy;
+		const char* MeshUserText;
+		bool IsDetermenentNegative;
+		W3dVertInfStruct* VertexInfluences;
+		int* MaterialIndex;
+		bool HasSmoothSkin;
+		bool KeepNormals;
+		int InputFaceCount;
+		float SkinOptimizationFactor;
+#ifdef W3X
+		std::vector<StringClass>* Includes;
+#else
+		bool IsNPatchable;
+		bool IsZNormal;
+		BonePaletteBuilderClass BonePalettes;
+		bool UseCache;
+		bool CacheHit;
+		StringClass CacheFileName;
+		std::vector<unsigned char> CachedAABTree;
+#endif
+	public:
+#ifndef W3X
+		MeshSave(const char* meshname, const char* containername, INode* node, Mesh* mesh, Matrix3* transform, W3DAppDataChunk* exportflags, W3DExportSettings* exportdata, HierarchySave* hierarchy, TimeValue time, MaxWorldInfoClass* info) :
+			ExportData(exportdata), Node(node), ExportFlags(exportflags), MeshBuilder(1, 255, 64), Time(time), Transform(*transform), Hierarchy(hierarchy), MeshUserText(nullptr), VertexInfluences(nullptr), MaterialIndex(nullptr), HasSmoothSkin(false), KeepNormals(false), InputFaceCount(0), SkinOptimizationFactor(0.0f), IsNPatchable(false), IsZNormal(false), UseCache(false), CacheHit(false)
+#else
+		MeshSave(const char* meshname, const char* containername, INode* node, Mesh* mesh, Matrix3* transform, W3DAppDataChunk* exportflags, W3DExportSettings* exportdata, std::vector<StringClass>* includes, HierarchySave* hierarchy, TimeValue time, MaxWorldInfoClass* info) :
+			Node(node), ExportFlags(exportflags), ExportData(exportdata), MeshBuilder(1, 255, 64), Time(time), Transform(*transform), Hierarchy(hierarchy), MeshUserText(nullptr), VertexInfluences(nullptr), MaterialIndex(nullptr), HasSmoothSkin(false), KeepNormals(false), InputFaceCount(0), SkinOptimizationFactor(0.0f), Includes(includes)
 #endif
 		{
 			TT_PROFILER_SCOPE("MeshSave::MeshSave");
@@ -6228,7 +6937,10 @@ namespace W3D::MaxTools
 			}
 
 #ifndef W3X
-			if (Materials.GetNeedsTangents() || IsMeshNPatchable(Node))
+			IsNPatchable = IsMeshNPatchable(Node);
+			IsZNormal = enum_has_flags(W3DUtilities::GetOrCreateW3DAppDataChunk(*Node).GeometryFlags, W3DGeometryFlags::ZNormal);
+
+			if (Materials.GetNeedsTangents() || IsNPatchable)
 #else
 			if (Materials.GetNeedsTangents())
 #endif
@@ -6238,15 +6950,6 @@ namespace W3D::MaxTools
 
 			MeshBuilder.Set_World_Info(info);
 			BuildMesh(&m, mtl);
-			Header.NumVertices = MeshBuilder.Get_Vertex_Count();
-			Header.NumTris = MeshBuilder.Get_Face_Count();
-			ComputeBoundingVolumes();
-
-			if ((Header.Attributes & W3D_MESH_FLAG_GEOMETRY_TYPE_MASK) == W3D_MESH_FLAG_GEOMETRY_TYPE_SKIN && Hierarchy)
-			{
-				CalculateSkinData();
-			}
-
 			MSTR str;
 			node->GetUserPropBuffer(str);
 
@@ -6278,6 +6981,116 @@ namespace W3D::MaxTools
 			}
 		}
 
+		// Everything after the input has been pulled out of Max, safe to run on a worker thread.
+		void Build()
+		{
+			TT_PROFILER_SCOPE("MeshSave::Build");
+#ifndef W3X
+			// NOTE: Normals smoothed across meshes depend on every other mesh in the scene, so those can't be cached per mesh.
+			UseCache = ExportCache && !(KeepNormals && MeshBuilder.Get_World_Info() && MeshBuilder.Get_World_Info()->Are_Meshes_Smoothed());
+
+			if (UseCache)
+			{
+				uint32 settings[5] = { ExportCacheVersion, Header.Attributes, KeepNormals, ExportData->OptimiseCollisions, ExportData->NewAABTree };
+				std::vector<unsigned char> key((unsigned char*)settings, (unsigned char*)settings + sizeof(settings));
+				MeshBuilder.Get_Input_Key(key);
+				CacheFileName = GetExportCacheFileName(LargeByteHashFunc128(key.data(), key.size()));
+				CacheHit = LoadExportCache(CacheFileName, MeshBuilder, CachedAABTree);
+			}
+
+			if (!CacheHit)
+#endif
+			{
+				MeshBuilder.Build_Mesh(KeepNormals);
+			}
+
+			Header.NumVertices = MeshBuilder.Get_Vertex_Count();
+			Header.NumTris = MeshBuilder.Get_Face_Count();
+			ComputeBoundingVolumes();
+
+			if ((Header.Attributes & W3D_MESH_FLAG_GEOMETRY_TYPE_MASK) == W3D_MESH_FLAG_GEOMETRY_TYPE_SKIN && Hierarchy)
+			{
+				CalculateSkinData();
+#ifndef W3X
+
+				if (BonePaletteSize > 0)
+				{
+					CalculateBonePalettes();
+				}
+#endif
+			}
+		}
+
+		// Reports the results of Build, has to run on the main thread.
+		void LogBuild()
+		{
+			LogDataDialogClass::WriteLogWindow(L"\nBuilt Mesh: %S\n", Header.MeshName);
+#ifndef W3X
+
+			if (CacheHit)
+			{
+				LogDataDialogClass::WriteLogWindow(L" loaded from export cache\n");
+			}
+#endif
+
+			LogDataDialogClass::WriteLogWindow(L" triangle count: %d\n", InputFaceCount);
+			LogDataDialogClass::WriteLogWindow(L" final vertex count: %d\n", MeshBuilder.Get_Vertex_Count());
+			LogDataDialogClass::WriteLogWindow(L" vertex/triangle ratio: %f\n", (float)MeshBuilder.Get_Vertex_Count() / (float)InputFaceCount);
+			LogDataDialogClass::WriteLogWindow(L" strip count: %d\n", MeshBuilder.Get_Mesh_Stats().StripCount);
+			LogDataDialogClass::WriteLogWindow(L" average strip length: %f\n", MeshBuilder.Get_Mesh_Stats().AvgStripLength);
+			LogDataDialogClass::WriteLogWindow(L" longest strip: %d\n", MeshBuilder.Get_Mesh_Stats().MaxStripLength);
+			LogDataDialogClass::AddToTotalVertexCount(MeshBuilder.Get_Vertex_Count());
+
+			if (SkinOptimizationFactor > 0.0f)
+			{
+				LogDataDialogClass::WriteLogWindow(L"Skin optimization factor: %.1f (the greater the better, less than 2.0 really bad)\n", SkinOptimizationFactor);
+
+				if (SkinOptimizationFactor < 3.0f)
+				{
+					WideStringClass str;
+					str.Format(L"Please optimize %S skinning for better performance\nVertices do not share skinning very much", Header.MeshName);
+					MessageBox(nullptr, str, L"Warning", MB_SETFOREGROUND);
+				}
+			}
+#ifndef W3X
+
+			if (BonePalettes.Palettes.size())
+			{
+				size_t minbones = BonePalettes.Palettes[0].size();
+				size_t maxbones = 0;
+				size_t totalbones = 0;
+
+				for (auto& palette : BonePalettes.Palettes)
+				{
+					minbones = palette.size() < minbones ? palette.size() : minbones;
+					maxbones = palette.size() > maxbones ? palette.size() : maxbones;
+					totalbones += palette.size();
+				}
+
+				LogDataDialogClass::WriteLogWindow(L" bone palettes: %d (size %d)\n", (int)BonePalettes.Palettes.size(), BonePalettes.PaletteSize);
+				LogDataDialogClass::WriteLogWindow(L" bones per palette: min %d, average %.1f, max %d\n", (int)minbones, (float)totalbones / BonePalettes.Palettes.size(), (int)maxbones);
+				LogDataDialogClass::WriteLogWindow(L" split vertices: %d (%.1f%%)\n", BonePalettes.SplitVertexCount, BonePalettes.SplitVertexCount * 100.0f / MeshBuilder.Get_Vertex_Count());
+			}
+#endif
+		}
+
+#ifndef W3X
+		void CalculateBonePalettes()
+		{
+			int facecount = MeshBuilder.Get_Face_Count();
+			std::vector<uint32> faceverts(facecount * 3);
+
+			for (int i = 0; i < facecount; i++)
+			{
+				faceverts[i * 3] = MeshBuilder.Get_Face(i).VertIdx[0];
+				faceverts[i * 3 + 1] = MeshBuilder.Get_Face(i).VertIdx[1];
+				faceverts[i * 3 + 2] = MeshBuilder.Get_Face(i).VertIdx[2];
+			}
+
+			BonePalettes.Build(BonePaletteSize, facecount, faceverts.data(), MeshBuilder.Get_Vertex_Count(), VertexInfluences);
+		}
+#endif
+
 		void ComputeSkinOptimization()
 		{
 			int count = MeshBuilder.Get_Vertex_Count();
@@ -6322,15 +7135,7 @@ namespace W3D::MaxTools
 
 				if (x > 0)
 				{
-					float f1 = (float)count / (float)x;
-
-					LogDataDialogClass::WriteLogWindow(L"Skin optimization factor: %.1f (the greater the better, less than 2.0 really bad)\n", f1);
-					if (f1 < 3.0f)
-					{
-						WideStringClass str;
-						str.Format(L"Please optimize %S skinning for better performance\nVertices do not share skinning very much", Header.MeshName);
-						MessageBox(nullptr, str, L"Warning", MB_SETFOREGROUND);
-					}
+					SkinOptimizationFactor = (float)count / (float)x;
 				}
 			}
 		}
@@ -6356,77 +7161,241 @@ namespace W3D::MaxTools
 			return true;
 		}
 
-		bool SaveVertices(ChunkSaveClass& csave)
+		// Returns true on failure like the Save functions
+		bool SaveChunkData(ChunkSaveClass& csave, W3DChunkType type, const std::vector<unsigned char>& data)
+		{
+			return !csave.Begin_Chunk(type) || csave.Write(data.data(), (unsigned long)data.size()) != data.size() || !csave.End_Chunk();
+		}
+
+		// 16 bit positions relative to the bounding box, false if any of them would be off by more than MaxPositionQuantizationError
+		bool QuantizePositions(std::vector<unsigned char>& out)
 		{
-			if (!csave.Begin_Chunk(W3DChunkType::VERTICES))
+			int count = MeshBuilder.Get_Vertex_Count();
+
+			if (!count)
 			{
-				return true;
+				return false;
 			}
 
-			TT_PROFILER_SCOPE("MeshSave::SaveVertices");
+			Vector3 min = MeshBuilder.Get_Vertex(0).Vertexes[0];
+			Vector3 max = min;
 
-			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+			for (int i = 1; i < count; i++)
 			{
-				W3dVectorStruct buf;
-				Vector3 v = MeshBuilder.Get_Vertex(i).Vertexes[0];
-				buf.X = v.X;
-				buf.Y = v.Y;
-				buf.Z = v.Z;
+				Vector3& v = MeshBuilder.Get_Vertex(i).Vertexes[0];
 
-				if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
+				for (int j = 0; j < 3; j++)
 				{
-					return true;
+					min[j] = v[j] < min[j] ? v[j] : min[j];
+					max[j] = v[j] > max[j] ? v[j] : max[j];
 				}
 			}
 
-			if (csave.End_Chunk())
+			W3dQuantizedVectorHeaderStruct header;
+			header.Min.X = min.X;
+			header.Min.Y = min.Y;
+			header.Min.Z = min.Z;
+			header.Scale.X = (max.X - min.X) / 65535.0f;
+			header.Scale.Y = (max.Y - min.Y) / 65535.0f;
+			header.Scale.Z = (max.Z - min.Z) / 65535.0f;
+			float scale[3] = { header.Scale.X, header.Scale.Y, header.Scale.Z };
+			out.resize(sizeof(header) + count * 3 * sizeof(uint16));
+			memcpy(out.data(), &header, sizeof(header));
+			uint16* values = (uint16*)(out.data() + sizeof(header));
+
+			for (int i = 0; i < count; i++)
 			{
-				if (!HasSmoothSkin)
+				Vector3& v = MeshBuilder.Get_Vertex(i).Vertexes[0];
+
+				for (int j = 0; j < 3; j++)
 				{
-					return false;
+					uint16 q = QuantizeUNorm16(v[j], min[j], scale[j]);
+
+					if (fabsf(min[j] + q * scale[j] - v[j]) > MaxPositionQuantizationError)
+					{
+						return false;
+					}
+
+					values[i * 3 + j] = q;
+				}
+			}
+
+			return true;
+		}
+
+		// 16 bit texture coordinates relative to the range used by this mesh, false if any of them would be off by more than MaxUnitQuantizationError
+		bool QuantizeTexCoords(std::vector<unsigned char>& out, int pass, int stage)
+		{
+			int count = MeshBuilder.Get_Vertex_Count();
+
+			if (!count)
+			{
+				return false;
+			}
+
+			Vector2 min = MeshBuilder.Get_Vertex(0).TexCoord[pass][stage];
+			Vector2 max = min;
+
+			for (int i = 1; i < count; i++)
+			{
+				Vector2& uv = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage];
+
+				for (int j = 0; j < 2; j++)
+				{
+					min[j] = uv[j] < min[j] ? uv[j] : min[j];
+					max[j] = uv[j] > max[j] ? uv[j] : max[j];
 				}
+			}
+
+			W3dQuantizedTexCoordHeaderStruct header;
+			header.Min.U = min.X;
+			header.Min.V = min.Y;
+			header.Scale.U = (max.X - min.X) / 65535.0f;
+			header.Scale.V = (max.Y - min.Y) / 65535.0f;
+			float scale[2] = { header.Scale.U, header.Scale.V };
+			out.resize(sizeof(header) + count * 2 * sizeof(uint16));
+			memcpy(out.data(), &header, sizeof(header));
+			uint16* values = (uint16*)(out.data() + sizeof(header));
 
-				if (csave.Begin_Chunk(W3DChunkType::SECONDARY_VERTICES))
+			for (int i = 0; i < count; i++)
+			{
+				Vector2& uv = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage];
+
+				for (int j = 0; j < 2; j++)
 				{
-					for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+					uint16 q = QuantizeUNorm16(uv[j], min[j], scale[j]);
+
+					if (fabsf(min[j] + q * scale[j] - uv[j]) > MaxUnitQuantizationError)
 					{
-						W3dVectorStruct buf;
-						Vector3 v = MeshBuilder.Get_Vertex(i).Vertexes[1];
-						buf.X = v.X;
-						buf.Y = v.Y;
-						buf.Z = v.Z;
-						if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
-						{
-							return true;
-						}
+						return false;
 					}
 
-					return !csave.End_Chunk();
+					values[i * 2 + j] = q;
 				}
 			}
 
 			return true;
 		}
 
-		bool SaveVertexNormals(ChunkSaveClass& csave)
+		// Octahedral encoded unit vectors, false if any of them would be off by more than MaxUnitQuantizationError
+		template <typename F> bool QuantizeUnitVectors(std::vector<unsigned char>& out, F get)
 		{
-			if (!(Header.VertexChannels & W3D_VERTEX_CHANNEL_NORMAL))
+			int count = MeshBuilder.Get_Vertex_Count();
+			out.resize(count * 2 * sizeof(sint16));
+			sint16* values = (sint16*)out.data();
+
+			for (int i = 0; i < count; i++)
 			{
-				return false;
+				W3dVectorStruct v = get(i);
+				W3dVectorStruct decoded;
+				W3d_Octahedral_Encode(v, &values[i * 2]);
+				W3d_Octahedral_Decode(&values[i * 2], decoded);
+
+				if (fabsf(decoded.X - v.X) > MaxUnitQuantizationError || fabsf(decoded.Y - v.Y) > MaxUnitQuantizationError || fabsf(decoded.Z - v.Z) > MaxUnitQuantizationError)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Writes the vectors returned by get as floats, or octahedral encoded if QuantizeVertices is set and they fit the error budget
+		template <typename F> bool SaveUnitVectors(ChunkSaveClass& csave, W3DChunkType type, W3DChunkType quantizedtype, F get)
+		{
+			std::vector<unsigned char> quantized;
+
+			if (QuantizeVertices && QuantizeUnitVectors(quantized, get))
+			{
+				return SaveChunkData(csave, quantizedtype, quantized);
 			}
 
-			if (!csave.Begin_Chunk(W3DChunkType::VERTEX_NORMALS))
+			if (!csave.Begin_Chunk(type))
 			{
 				return true;
 			}
 
-			TT_PROFILER_SCOPE("MeshSave::SaveVertexNormals");
+			W3dVectorStruct* vectors = csave.Reserve_Array<W3dVectorStruct>(MeshBuilder.Get_Vertex_Count());
 
 			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+			{
+				vectors[i] = get(i);
+			}
+
+			return !csave.End_Chunk();
+		}
+
+		bool SaveVertices(ChunkSaveClass& csave)
+		{
+			TT_PROFILER_SCOPE("MeshSave::SaveVertices");
+			std::vector<unsigned char> quantized;
+
+			if (QuantizeVertices && QuantizePositions(quantized))
+			{
+				if (SaveChunkData(csave, W3DChunkType::QUANTIZED_VERTICES, quantized))
+				{
+					return true;
+				}
+			}
+			else
+			{
+				if (!csave.Begin_Chunk(W3DChunkType::VERTICES))
+				{
+					return true;
+				}
+
+				W3dVectorStruct* vertices = csave.Reserve_Array<W3dVectorStruct>(MeshBuilder.Get_Vertex_Count());
+
+				for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+				{
+					Vector3 v = MeshBuilder.Get_Vertex(i).Vertexes[0];
+					vertices[i].X = v.X;
+					vertices[i].Y = v.Y;
+					vertices[i].Z = v.Z;
+				}
+
+				if (!csave.End_Chunk())
+				{
+					return true;
+				}
+			}
+
+			if (!HasSmoothSkin)
+			{
+				return false;
+			}
+
+			if (csave.Begin_Chunk(W3DChunkType::SECONDARY_VERTICES))
+			{
+				W3dVectorStruct* vertices = csave.Reserve_Array<W3dVectorStruct>(MeshBuilder.Get_Vertex_Count());
+
+				for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+				{
+					Vector3 v = MeshBuilder.Get_Vertex(i).Vertexes[1];
+					vertices[i].X = v.X;
+					vertices[i].Y = v.Y;
+					vertices[i].Z = v.Z;
+				}
+
+				return !csave.End_Chunk();
+			}
+
+			return true;
+		}
+
+		bool SaveVertexNormals(ChunkSaveClass& csave)
+		{
+			if (!(Header.VertexChannels & W3D_VERTEX_CHANNEL_NORMAL))
+			{
+				return false;
+			}
+
+			TT_PROFILER_SCOPE("MeshSave::SaveVertexNormals");
+			auto normal = [this](int i)
 			{
 				W3dVectorStruct buf;
 
-				if (enum_has_flags(W3DUtilities::GetOrCreateW3DAppDataChunk(*Node).GeometryFlags, W3DGeometryFlags::ZNormal))
+				if (IsZNormal)
 				{
 					buf.X = 0.0f;
 					buf.Y = 0.0f;
@@ -6440,47 +7409,41 @@ namespace W3D::MaxTools
 					buf.Z = v.Z;
 				}
 
-				if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
-				{
-					return true;
-				}
+				return buf;
+			};
+
+			if (SaveUnitVectors(csave, W3DChunkType::VERTEX_NORMALS, W3DChunkType::QUANTIZED_VERTEX_NORMALS, normal))
+			{
+				return true;
 			}
 
-			if (csave.End_Chunk())
+			if (!HasSmoothSkin)
 			{
-				if (!HasSmoothSkin)
-				{
-					return false;
-				}
+				return false;
+			}
 
-				if (csave.Begin_Chunk(W3DChunkType::SECONDARY_VERTEX_NORMALS))
+			if (csave.Begin_Chunk(W3DChunkType::SECONDARY_VERTEX_NORMALS))
+			{
+				W3dVectorStruct* normals = csave.Reserve_Array<W3dVectorStruct>(MeshBuilder.Get_Vertex_Count());
+
+				for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
 				{
-					for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+					if (IsZNormal)
 					{
-						W3dVectorStruct buf;
-
-						if (enum_has_flags(W3DUtilities::GetOrCreateW3DAppDataChunk(*Node).GeometryFlags, W3DGeometryFlags::ZNormal))
-						{
-							buf.X = 0.0f;
-							buf.Y = 0.0f;
-							buf.Z = 1.0f;
-						}
-						else
-						{
-							Vector3 v = MeshBuilder.Get_Vertex(i).Normals[1];
-							buf.X = v.X;
-							buf.Y = v.Y;
-							buf.Z = v.Z;
-						}
-
-						if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
-						{
-							return true;
-						}
+						normals[i].X = 0.0f;
+						normals[i].Y = 0.0f;
+						normals[i].Z = 1.0f;
+					}
+					else
+					{
+						Vector3 v = MeshBuilder.Get_Vertex(i).Normals[1];
+						normals[i].X = v.X;
+						normals[i].Y = v.Y;
+						normals[i].Z = v.Z;
 					}
-
-					return !csave.End_Chunk();
 				}
+
+				return !csave.End_Chunk();
 			}
 
 			return true;
@@ -6493,47 +7456,27 @@ namespace W3D::MaxTools
 				return false;
 			}
 
-			if (!csave.Begin_Chunk(W3DChunkType::TANGENTS))
-			{
-				return true;
-			}
-
 			TT_PROFILER_SCOPE("MeshSave::SaveTangentsBinormals");
-
-			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+			auto tangent = [this](int i)
 			{
 				W3dVectorStruct buf;
 				Vector3 v = MeshBuilder.Get_Vertex(i).Tangent;
 				buf.X = v.X;
 				buf.Y = v.Y;
 				buf.Z = v.Z;
-
-				if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
-				{
-					return true;
-				}
-			}
-
-			if (!csave.End_Chunk() || !csave.Begin_Chunk(W3DChunkType::BINORMALS))
-			{
-				return true;
-			}
-
-			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
+				return buf;
+			};
+			auto binormal = [this](int i)
 			{
 				W3dVectorStruct buf;
 				Vector3 v = MeshBuilder.Get_Vertex(i).Binormal;
 				buf.X = v.X;
 				buf.Y = v.Y;
 				buf.Z = v.Z;
+				return buf;
+			};
 
-				if (csave.Write(&buf, sizeof(W3dVectorStruct)) != sizeof(W3dVectorStruct))
-				{
-					return true;
-				}
-			}
-
-			return !csave.End_Chunk();
+			return SaveUnitVectors(csave, W3DChunkType::TANGENTS, W3DChunkType::QUANTIZED_TANGENTS, tangent) || SaveUnitVectors(csave, W3DChunkType::BINORMALS, W3DChunkType::QUANTIZED_BINORMALS, binormal);
 		}
 
 		bool SaveVertexInfluences(ChunkSaveClass& csave)
@@ -6558,6 +7501,45 @@ namespace W3D::MaxTools
 			return true;
 		}
 
+		bool SaveBonePalettes(ChunkSaveClass& csave)
+		{
+			if (BonePalettes.Palettes.empty())
+			{
+				return false;
+			}
+
+			TT_PROFILER_SCOPE("MeshSave::SaveBonePalettes");
+			W3dBonePaletteHeaderStruct header;
+			memset(&header, 0, sizeof(header));
+			header.PaletteSize = BonePalettes.PaletteSize;
+			header.PaletteCount = (uint32)BonePalettes.Palettes.size();
+			header.SplitVertexCount = BonePalettes.SplitVertexCount;
+
+			if (!csave.Begin_Chunk(W3DChunkType::BONE_PALETTES) || !csave.Begin_Chunk(W3DChunkType::BONE_PALETTE_HEADER) || csave.Write(&header, sizeof(header)) != sizeof(header) || !csave.End_Chunk())
+			{
+				return true;
+			}
+
+			for (auto& palette : BonePalettes.Palettes)
+			{
+				unsigned long size = (unsigned long)(palette.size() * sizeof(uint16));
+
+				if (!csave.Begin_Chunk(W3DChunkType::BONE_PALETTE) || csave.Write(palette.data(), size) != size || !csave.End_Chunk())
+				{
+					return true;
+				}
+			}
+
+			unsigned long size = (unsigned long)(BonePalettes.FacePalettes.size() * sizeof(uint16));
+
+			if (!csave.Begin_Chunk(W3DChunkType::BONE_PALETTE_IDS) || csave.Write(BonePalettes.FacePalettes.data(), size) != size || !csave.End_Chunk())
+			{
+				return true;
+			}
+
+			return !csave.End_Chunk();
+		}
+
 		bool SaveTriangles(ChunkSaveClass& csave)
 		{
 			if (!csave.Begin_Chunk(W3DChunkType::TRIANGLES))
@@ -6566,11 +7548,12 @@ namespace W3D::MaxTools
 			}
 
 			TT_PROFILER_SCOPE("MeshSave::SaveTriangles");
+			// NOTE: Reserve hands back zeroed memory, which covers the padding the memset used to clear
+			W3dTriStruct* tris = csave.Reserve_Array<W3dTriStruct>(MeshBuilder.Get_Face_Count());
 
 			for (int i = 0; i < MeshBuilder.Get_Face_Count(); i++)
 			{
-				W3dTriStruct tri;
-				memset(&tri, 0, sizeof(tri));
+				W3dTriStruct& tri = tris[i];
 				tri.Vindex[0] = MeshBuilder.Get_Face(i).VertIdx[0];
 				tri.Vindex[1] = MeshBuilder.Get_Face(i).VertIdx[1];
 				tri.Vindex[2] = MeshBuilder.Get_Face(i).VertIdx[2];
@@ -6579,11 +7562,6 @@ namespace W3D::MaxTools
 				tri.Normal.Y = MeshBuilder.Get_Face(i).Normal.Y;
 				tri.Normal.Z = MeshBuilder.Get_Face(i).Normal.Z;
 				tri.Dist = MeshBuilder.Get_Face(i).Dist;
-
-				if (csave.Write(&tri, sizeof(W3dTriStruct)) != sizeof(W3dTriStruct))
-				{
-					return true;
-				}
 			}
 
 			return !csave.End_Chunk();
@@ -6602,15 +7580,11 @@ namespace W3D::MaxTools
 			}
 
 			TT_PROFILER_SCOPE("MeshSave::SaveVertexShadeIndices");
+			int* shades = csave.Reserve_Array<int>(MeshBuilder.Get_Vertex_Count());
 
 			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
 			{
-				int shade = MeshBuilder.Get_Vertex(i).ShadeIndex;
-
-				if (csave.Write(&shade, sizeof(shade)) != sizeof(shade))
-				{
-					return true;
-				}
+				shades[i] = MeshBuilder.Get_Vertex(i).ShadeIndex;
 			}
 
 			return !csave.End_Chunk();
@@ -6856,19 +7830,14 @@ namespace W3D::MaxTools
 			}
 
 			TT_PROFILER_SCOPE("MeshSave::SaveDCG");
+			W3dRGBAStruct* colors = csave.Reserve_Array<W3dRGBAStruct>(MeshBuilder.Get_Vertex_Count());
 
 			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
 			{
-				W3dRGBAStruct rgba;
-				rgba.R = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].X * 255.0f);
-				rgba.G = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].Y * 255.0f);
-				rgba.B = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].Z * 255.0f);
-				rgba.A = (uint8)(MeshBuilder.Get_Vertex(i).Alpha[pass] * 255.0f);
-
-				if (csave.Write(&rgba, sizeof(W3dRGBAStruct)) != sizeof(W3dRGBAStruct))
-				{
-					return true;
-				}
+				colors[i].R = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].X * 255.0f);
+				colors[i].G = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].Y * 255.0f);
+				colors[i].B = (uint8)(MeshBuilder.Get_Vertex(i).DiffuseColor[pass].Z * 255.0f);
+				colors[i].A = (uint8)(MeshBuilder.Get_Vertex(i).Alpha[pass] * 255.0f);
 			}
 
 			return !csave.End_Chunk();
@@ -6884,15 +7853,11 @@ namespace W3D::MaxTools
 			if (MeshBuilder.Get_Mesh_Stats().HasPerPolyTexture[pass][stage])
 			{
 				TT_PROFILER_SCOPE("MeshSave::SaveTextureIDs");
+				int* ids = csave.Reserve_Array<int>(MeshBuilder.Get_Face_Count());
 
 				for (int i = 0; i < MeshBuilder.Get_Face_Count(); i++)
 				{
-					int id = MeshBuilder.Get_Face(i).TextureIndex[pass][stage];
-
-					if (csave.Write(&id, sizeof(id)) != sizeof(id))
-					{
-						return true;
-					}
+					ids[i] = MeshBuilder.Get_Face(i).TextureIndex[pass][stage];
 				}
 
 				return !csave.End_Chunk();
@@ -6915,23 +7880,25 @@ namespace W3D::MaxTools
 				return false;
 			}
 
+			TT_PROFILER_SCOPE("MeshSave::SaveStageTexcoords");
+			std::vector<unsigned char> quantized;
+
+			if (QuantizeVertices && QuantizeTexCoords(quantized, pass, stage))
+			{
+				return SaveChunkData(csave, W3DChunkType::QUANTIZED_STAGE_TEXCOORDS, quantized);
+			}
+
 			if (!csave.Begin_Chunk(W3DChunkType::STAGE_TEXCOORDS))
 			{
 				return true;
 			}
 
-			TT_PROFILER_SCOPE("MeshSave::SaveStageTexcoords");
+			W3dTexCoordStruct* texcoords = csave.Reserve_Array<W3dTexCoordStruct>(MeshBuilder.Get_Vertex_Count());
 
 			for (int i = 0; i < MeshBuilder.Get_Vertex_Count(); i++)
 			{
-				W3dTexCoordStruct buf;
-				buf.U = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage].X;
-				buf.V = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage].Y;
-
-				if (csave.Write(&buf, sizeof(W3dTexCoordStruct)) != sizeof(W3dTexCoordStruct))
-				{
-					return true;
-				}
+				texcoords[i].U = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage].X;
+				texcoords[i].V = MeshBuilder.Get_Vertex(i).TexCoord[pass][stage].Y;
 			}
 
 			return !csave.End_Chunk();
@@ -6940,6 +7907,17 @@ namespace W3D::MaxTools
 		int GenerateAABTree(ChunkSaveClass& csave, bool new_format)
 		{
 			TT_PROFILER_SCOPE("MeshSave::GenerateAABTree");
+
+			if (CacheHit)
+			{
+				if (CachedAABTree.size())
+				{
+					csave.Write(CachedAABTree.data(), (unsigned long)CachedAABTree.size());
+				}
+
+				return 0;
+			}
+
 			int facecount = MeshBuilder.Get_Face_Count();
 
 			if (facecount >= 8 && (Header.Attributes & W3D_MESH_FLAG_GEOMETRY_TYPE_MASK) == W3D_MESH_FLAG_GEOMETRY_TYPE_NORMAL)
@@ -6962,7 +7940,22 @@ namespace W3D::MaxTools
 
 				AABTreeBuilderClass builder;
 				builder.Build_AABTree(facecount, polys, vertcount, verts, new_format);
-				builder.Export(csave);
+
+				if (UseCache)
+				{
+					RAMFileClass file(nullptr, 65536);
+					file.Set_Reallocate(true);
+					file.Open(2);
+					ChunkSaveClass cachesave(&file);
+					builder.Export(cachesave);
+					CachedAABTree.assign(file.Get_Buffer(), file.Get_Buffer() + file.Get_Length());
+					csave.Write(CachedAABTree.data(), (unsigned long)CachedAABTree.size());
+				}
+				else
+				{
+					builder.Export(csave);
+				}
+
 				delete[] verts;
 				delete[] polys;
 			}
@@ -7106,7 +8099,6 @@ namespace W3D::MaxTools
 		void BuildMesh(Mesh* mesh, Mtl* material)
 		{
 			TT_PROFILER_SCOPE("MeshSave::BuildMesh");
-			TT_PROFILER_SCOPE_START("Prepare Data");
 			MeshBuilder.Reset(1, mesh->numFaces, mesh->numFaces / 3);
 #ifndef W3X
 			float* AlphaModifierData;
@@ -7406,15 +8398,8 @@ namespace W3D::MaxTools
 				MeshBuilder.Add_Face(&face);
 			}
 
-			TT_PROFILER_SCOPE_STOP();
-			MeshBuilder.Build_Mesh(keepnormals);
-			LogDataDialogClass::WriteLogWindow(L" triangle count: %d\n", mesh->numFaces);
-			LogDataDialogClass::WriteLogWindow(L" final vertex count: %d\n", MeshBuilder.Get_Vertex_Count());
-			LogDataDialogClass::WriteLogWindow(L" vertex/triangle ratio: %f\n", (float)MeshBuilder.Get_Vertex_Count() / (float)mesh->numFaces);
-			LogDataDialogClass::WriteLogWindow(L" strip count: %d\n", MeshBuilder.Get_Mesh_Stats().StripCount);
-			LogDataDialogClass::WriteLogWindow(L" average strip length: %f\n", MeshBuilder.Get_Mesh_Stats().AvgStripLength);
-			LogDataDialogClass::WriteLogWindow(L" longest strip: %d\n", MeshBuilder.Get_Mesh_Stats().MaxStripLength);
-			LogDataDialogClass::AddToTotalVertexCount(MeshBuilder.Get_Vertex_Count());
+			KeepNormals = keepnormals;
+			InputFaceCount = mesh->numFaces;
 		}
 
 		void CalculateSkinData()
@@ -7694,7 +8679,7 @@ namespace W3D::MaxTools
 				SaveTextureStage(csave, pass, 1);
 			}
 
-			if (!pass && IsMeshNPatchable(Node))
+			if (!pass && IsNPatchable)
 			{
 				SaveTangentsBinormals(csave);
 			}
@@ -7749,6 +8734,11 @@ namespace W3D::MaxTools
 				return true;
 			}
 
+			if (SaveBonePalettes(csave))
+			{
+				return true;
+			}
+
 			if (SaveVertexShadeIndices(csave))
 			{
 				return true;
@@ -7795,6 +8785,25 @@ namespace W3D::MaxTools
 			return !csave.End_Chunk();
 		}
 
+		void StoreCache()
+		{
+			if (UseCache && !CacheHit)
+			{
+				StoreExportCache(CacheFileName, MeshBuilder, CachedAABTree);
+			}
+		}
+
+		// Same as Save but without the names and the AABTree, so two meshes with identical geometry produce identical bytes
+		bool SaveContent(ChunkSaveClass& csave)
+		{
+			W3dMeshHeader3Struct header = Header;
+			memset(Header.MeshName, 0, sizeof(Header.MeshName));
+			memset(Header.ContainerName, 0, sizeof(Header.ContainerName));
+			bool result = Save(csave, false, false);
+			Header = header;
+			return result;
+		}
+
 #else
 		bool SaveMeshHeader(XMLWriter& csave)
 		{
@@ -8512,11 +9521,21 @@ namespace W3D::MaxTools
 		Point3 Point1;
 		Point3 Point2;
 		Box3 Box;
+		Matrix3 ObjectTM;
 		bool ValidMesh = false;
 		bool ExportMesh = true;
+		MaxWorldInfoClass Info;
+		MeshSave* MeshData = nullptr;
+		WideStringClass BuildError;
+#ifndef W3X
+		uint64 ContentHash = 0;
+		std::vector<unsigned char> Content;
+		std::vector<unsigned char> Output;
+		bool OutputFailed = false;
+#endif
 
 	public:
-		MeshGeometryExportTaskClass(INode* node, LodData& lod) : GeometryExportTaskClass(node, lod), Material(nullptr)
+		MeshGeometryExportTaskClass(INode* node, LodData& lod) : GeometryExportTaskClass(node, lod), Material(nullptr), Info(*lod.Info)
 		{
 			TT_PROFILER_SCOPE("MeshGeometryExportTaskClass()");
 			W3DAppDataChunk* data = &W3DUtilities::GetOrCreateW3DAppDataChunk(*Node);
@@ -8646,25 +9665,136 @@ namespace W3D::MaxTools
 			Point1 = (p2 + p1) * 0.5f;
 			Point2 = (p2 - p1) * 0.5f;
 			Box3 box(p1, p2);
-			Box = box * Node->GetObjectTM(Time);
+			ObjectTM = Node->GetObjectTM(Time);
+			Box = box * ObjectTM;
 		}
 
-		virtual void Save(LodData& lod)
+		~MeshGeometryExportTaskClass()
+		{
+			if (MeshData)
+			{
+				delete MeshData;
+			}
+		}
+
+		virtual void Prepare(LodData& lod)
 		{
 			if (ExportMesh)
 			{
-				lod.Info->Set_Current_Geometry_Task(this);
-				lod.Info->Set_Transform(Transform);
+				// NOTE: Every task gets its own copy of the world info since meshes are built in parallel.
+				Info.Set_Current_Geometry_Task(this);
+				Info.Set_Transform(Transform);
+#ifndef W3X
+				MeshData = new MeshSave(Name, ContainerName, Node, &Mesh, &Transform, &ExportFlags, lod.ExportData, lod.Hierarchy, lod.Time, &Info);
+#else
+				MeshData = new MeshSave(Name, ContainerName, Node, &Mesh, &Transform, &ExportFlags, lod.ExportData, lod.Includes, lod.Hierarchy, lod.Time, &Info);
+#endif
+			}
+		}
+
+		virtual void Build(LodData& lod)
+		{
+			if (!MeshData)
+			{
+				return;
+			}
+
+			try
+			{
+				MeshData->Build();
+#ifndef W3X
+
+				if (MeshDeduplication)
+				{
+					if (SaveToBuffer(Content, [this](ChunkSaveClass& csave) { return MeshData->SaveContent(csave); }))
+					{
+						Content.clear();
+					}
+					else
+					{
+						ContentHash = LargeByteHashFunc64(Content.data(), Content.size());
+					}
+				}
+
+				OutputFailed = SaveToBuffer(Output, [this, &lod](ChunkSaveClass& csave) { return MeshData->Save(csave, lod.ExportData->OptimiseCollisions, lod.ExportData->NewAABTree); });
+#endif
+			}
+			catch (ErrorClass& e)
+			{
+				BuildError = e.GetError();
+			}
+		}
+
+		virtual void Save(LodData& lod)
+		{
+			if (!MeshData)
+			{
+				return;
+			}
+
+			if (!BuildError.Is_Empty())
+			{
+				delete MeshData;
+				MeshData = nullptr;
+				throw ErrorClass(L"%s", BuildError.Peek_Buffer());
+			}
+
+			MeshData->LogBuild();
 #ifndef W3X
-				MeshSave* m = new MeshSave(Name, ContainerName, Node, &Mesh, &Transform, &ExportFlags, lod.ExportData, lod.Hierarchy, lod.Time, lod.Info);
-				m->Save(*lod.ChunkSave, lod.ExportData->OptimiseCollisions, lod.ExportData->NewAABTree);
+
+			if (!MeshDeduplication || !FindSharedMesh())
+			{
+				bool written = !Output.empty() && lod.ChunkSave->Write_Chunk(Output);
+
+				if (written && !OutputFailed)
+				{
+					MeshData->StoreCache();
+				}
+			}
+
+			Content.clear();
+			Output.clear();
 #else
-				MeshSave* m = new MeshSave(Name, ContainerName, Node, &Mesh, &Transform, &ExportFlags, lod.ExportData, lod.Includes, lod.Hierarchy, lod.Time, lod.Info);
-				m->Save(*lod.ChunkSave, lod.ExportData->OptimiseCollisions);
+			MeshData->Save(*lod.ChunkSave, lod.ExportData->OptimiseCollisions);
 #endif
-				delete m;
+			delete MeshData;
+			MeshData = nullptr;
+		}
+
+#ifndef W3X
+		// Catches copies of the same geometry that ObjectMap misses because they are not instances.
+		// Renames this task to the first mesh with the same content so the HLOD references that one instead.
+		bool FindSharedMesh()
+		{
+			TT_PROFILER_SCOPE("MeshGeometryExportTaskClass::FindSharedMesh");
+
+			if (Content.empty())
+			{
+				return false;
+			}
+
+			const byte* data = Content.data();
+			size_t length = Content.size();
+			auto range = MeshContentMap.equal_range(ContentHash);
+
+			for (auto i = range.first; i != range.second; ++i)
+			{
+				if (i->second.Data.size() == length && !memcmp(i->second.Data.data(), data, length))
+				{
+					LogDataDialogClass::WriteLogWindow(L"Mesh %S has the same content as %S.%S, sharing it\n", Name, i->second.ContainerName, i->second.Name);
+					memcpy(Name, i->second.Name, W3D_NAME_LEN);
+					memcpy(ContainerName, i->second.ContainerName, W3D_NAME_LEN);
+					return true;
+				}
 			}
+
+			MeshContentStruct& content = MeshContentMap.emplace(ContentHash, MeshContentStruct())->second;
+			memcpy(content.Name, Name, W3D_NAME_LEN);
+			memcpy(content.ContainerName, ContainerName, W3D_NAME_LEN);
+			content.Data = std::move(Content);
+			return false;
 		}
+#endif
 
 		virtual Point3 Build_Vertex_Normal_For_Point(Point3& point, int smoothing)
 		{
@@ -8673,7 +9803,7 @@ namespace W3D::MaxTools
 
 			if (Box.Contains(point))
 			{
-				Matrix3 tm = Node->GetObjectTM(Time);
+				Matrix3 tm = ObjectTM;
 				Point3 p2 = point * Inverse(tm);
 
 				for (int i = 0; i < Mesh.numFaces; i++)
@@ -9204,7 +10334,13 @@ namespace W3D::MaxTools
 			return;
 		}
 
-		if (!ExportAnimation(name, writer, node))
+#ifndef W3X
+		bool animation = m_Settings.ExportType == W3DExportType::PureAnimation && m_Settings.BatchTakes ? ExportTakes(node) : ExportAnimation(name, writer, node);
+#else
+		bool animation = ExportAnimation(name, writer, node);
+#endif
+
+		if (!animation)
 		{
 			MessageBox(nullptr, L"Animation Export Failure!", L"Error", MB_SETFOREGROUND);
 			return;
@@ -9403,14 +10539,20 @@ namespace W3D::MaxTools
 		return p2;
 	}
 
-#ifndef W3X
-	AnimationSave::AnimationSave(IScene* scene, INode* node, HierarchySave* hierarchy, W3DExportSettings* exportstr, int framerate, const char* name, Matrix3& mat) : Scene(scene), Node(node), Tree(nullptr), Hierarchy(hierarchy), StartFrame(exportstr->AnimFramesStart), EndFrame(exportstr->AnimFramesEnd), FrameRate(framerate), Matrix(mat)
-#else
 	AnimationSave::AnimationSave(IScene* scene, INode* node, HierarchySave* hierarchy, W3DExportSettings* exportstr, int framerate, const char* name, Matrix3& mat) : Scene(scene), Node(node), Tree(nullptr), Hierarchy(hierarchy), StartFrame(exportstr->AnimFramesStart), EndFrame(exportstr->AnimFramesEnd), FrameRate(framerate), Matrix(mat), ExportStr(exportstr)
-#endif
 	{
+#ifndef W3X
+		Flavor = ANIM_FLAVOR_VALID;
+		WithinTolerance = true;
+#endif
 		LogDataDialogClass::WriteLogWindow(L"Initializing Capture....\n");
 		CaptureBones();
+#ifndef W3X
+		if (exportstr->TargetFrameRate > 0 && exportstr->TargetFrameRate != FrameRate)
+		{
+			Resample(exportstr->TargetFrameRate);
+		}
+#endif
 		CopyW3DName(Name, name);
 	}
 
@@ -9419,85 +10561,21 @@ namespace W3D::MaxTools
 		NumFrames = EndFrame - StartFrame + 1;
 		LogDataDialogClass::WriteLogWindow(L"Extracting %d frames of animation from Max\n", NumFrames);
 		LogDataDialogClass::WriteLogWindow(L"\n");
-		Transforms = new Matrix3 * [Hierarchy->GetBoneCount()];
-
-		if (!Transforms)
-		{
-			throw ErrorClass(L"Out Of Memory!");
-		}
-
-		Angles = new Point3 * [Hierarchy->GetBoneCount()];
-
-		if (!Angles)
-		{
-			throw ErrorClass(L"Out Of Memory!");
-		}
-
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
-		{
-			Transforms[i] = new Matrix3[NumFrames];
-
-			if (!Transforms[i])
-			{
-				throw ErrorClass(L"Out Of Memory!");
-			}
-
-			for (int j = 0; j < NumFrames; j++)
-			{
-				Transforms[i][j];
-			}
-		}
-
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
-		{
-			Angles[i] = new Point3[NumFrames];
-
-			if (!Angles[i])
-			{
-				throw ErrorClass(L"Out Of Memory!");
-			}
-
-			for (int j = 0; j < NumFrames; j++)
-			{
-				Angles[i][j].x = 0.0f;
-				Angles[i][j].y = 0.0f;
-				Angles[i][j].z = 0.0f;
-			}
-		}
-
-		BitChannels = new BooleanVectorClass[Hierarchy->GetBoneCount()];
-		VisibilityChannels = new VectorClass<float>[Hierarchy->GetBoneCount()];
+		int frames = Hierarchy->GetBoneCount() * NumFrames;
+		Translations.assign(frames * 3, 0.0f);
+		Rotations.resize(frames * 4);
 
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
-		{
-			BitChannels[i].Resize(NumFrames);
-			VisibilityChannels[i].Resize(NumFrames);
-
-			for (int j = 0; j < NumFrames; j++)
-			{
-				BitChannels[i][j] = true;
-				VisibilityChannels[i][j] = 1.0f;
-			}
-		}
-
-		BinaryMove = new BooleanVectorClass[Hierarchy->GetBoneCount()];
-
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
+		for (int i = 0; i < frames; i++)
 		{
-			BinaryMove[i].Resize(NumFrames);
-
-			for (int j = 0; j < NumFrames; j++)
-			{
-				BinaryMove[i][j] = true;
-			}
+			Rotations[i * 4] = 0.0f;
+			Rotations[i * 4 + 1] = 0.0f;
+			Rotations[i * 4 + 2] = 0.0f;
+			Rotations[i * 4 + 3] = 1.0f;
 		}
 
-		HasData.Resize(Hierarchy->GetBoneCount());
-
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
-		{
-			HasData[i] = false;
-		}
+		Visibility.assign(frames, 1.0f);
+		FrameFlags.assign(frames, FRAME_VISIBLE | FRAME_BINARY_MOVE);
+		HasData.assign(Hierarchy->GetBoneCount(), false);
 
 		for (int j = 0; j < NumFrames; j++)
 		{
@@ -9535,11 +10613,6 @@ namespace W3D::MaxTools
 			{
 				Matrix3& m3 = DoMatrixFixup(new_hierarchy->GetTransform(i) * Inverse(Hierarchy->GetTransform(pivot)));
 				CopyTransform(pivot, frame, m3);
-				Matrix3D m4;
-				MakeMatrix3D(m3, m4);
-				EulerAngles e;
-				e.FromMatrix3D(m4);
-				SetAngles(pivot, frame, (float)e[0], (float)e[1], (float)e[2]);
 				node = new_hierarchy->GetNode(i);
 				float floatvis = 1.0f;
 				bool vis = true;
@@ -9585,7 +10658,10 @@ namespace W3D::MaxTools
 					}
 				}
 
-				BinaryMove[pivot][frame] = move;
+				if (!move)
+				{
+					FrameFlags[pivot * NumFrames + frame] &= ~FRAME_BINARY_MOVE;
+				}
 			}
 		}
 
@@ -9594,67 +10670,170 @@ namespace W3D::MaxTools
 
 	void AnimationSave::CopyTransform(int bone, int frame, Matrix3& transform)
 	{
-		Transforms[bone][frame] = transform;
+		Quat q;
+		Point3 p;
+		Point3 scale;
+		DecomposeMatrix(transform, p, q, scale);
+		float* translation = &Translations[bone * NumFrames * 3 + frame];
+		translation[0] = p.x;
+		translation[NumFrames] = p.y;
+		translation[NumFrames * 2] = p.z;
+		int index = bone * NumFrames + frame;
+		Rotations[index * 4] = -q.x;
+		Rotations[index * 4 + 1] = -q.y;
+		Rotations[index * 4 + 2] = -q.z;
+		Rotations[index * 4 + 3] = q.w;
 		HasData[bone] = true;
 	}
 
-	void AnimationSave::SetAngles(int bone, int frame, float xrot, float yrot, float zrot)
+	void AnimationSave::CopyVisibility(int bone, int frame, bool vis, float floatvis)
 	{
-		if (frame > 0)
+		int index = bone * NumFrames + frame;
+		Visibility[index] = floatvis;
+
+		if (!vis)
 		{
-			float x = xrot + 3.1415927f;
-			float y = 3.1415927f - yrot;
-			float z = zrot + 3.1415927f;
+			FrameFlags[index] &= ~FRAME_VISIBLE;
+		}
 
-			if (x > 3.1415926535f)
-			{
-				x = x - 6.283185307f;
-			}
+		HasData[bone] = true;
+	}
 
-			if (y > 3.1415926535f)
-			{
-				y = y - 6.283185307f;
-			}
+#ifndef W3X
+	void AnimationSave::Resample(int framerate)
+	{
+		TT_PROFILER_SCOPE("Resample Animation");
+		// NOTE: Both ends of the range are kept, the last output frame lands on or just before the last captured frame
+		int numframes = (int)((__int64)(NumFrames - 1) * framerate / FrameRate) + 1;
+		int bones = Hierarchy->GetBoneCount();
+		std::vector<float> translations(bones * numframes * 3);
+		std::vector<float> rotations(bones * numframes * 4);
+		std::vector<float> visibility(bones * numframes);
+		std::vector<unsigned char> flags(bones * numframes);
+
+		for (int bone = 0; bone < bones; bone++)
+		{
+			const float* srctranslation = &Translations[bone * NumFrames * 3];
+			const float* srcrotation = &Rotations[bone * NumFrames * 4];
+			const float* srcvisibility = &Visibility[bone * NumFrames];
+			const unsigned char* srcflags = &FrameFlags[bone * NumFrames];
+			float* translation = &translations[bone * numframes * 3];
+			float* rotation = &rotations[bone * numframes * 4];
+			int previous = -1;
 
-			if (z > 3.1415926535f)
+			for (int frame = 0; frame < numframes; frame++)
 			{
-				z = z - 6.283185307f;
-			}
+				__int64 position = (__int64)frame * FrameRate;
+				int i = (int)(position / framerate);
+				float alpha = (float)(position % framerate) / framerate;
+				int next = i + 1 < NumFrames ? i + 1 : i;
 
-			float xangle = Angles[bone][frame - 1].x;
-			float yangle = Angles[bone][frame - 1].y;
-			float zangle = Angles[bone][frame - 1].z;
+				// NOTE: A binary move or a visibility change between the two source frames is a cut, interpolating across it would blend two unrelated poses
+				if ((srcflags[next] & FRAME_BINARY_MOVE) || ((srcflags[i] ^ srcflags[next]) & FRAME_VISIBLE))
+				{
+					alpha = 0.0f;
+				}
 
-			if ((z - zangle) * (z - zangle) + (y - yangle) * (y - yangle) + (x - xangle) * (x - xangle) < (zrot - zangle) * (zrot - zangle) + (yrot - yangle) * (yrot - yangle) + (xrot - xangle) * (xrot - xangle))
-			{
-				xrot = x;
-				yrot = y;
-				zrot = z;
-			}
-		}
+				for (int axis = 0; axis < 3; axis++)
+				{
+					const float* src = srctranslation + axis * NumFrames;
+					translation[axis * numframes + frame] = src[i] + (src[next] - src[i]) * alpha;
+				}
 
-		Angles[bone][frame].x = xrot;
-		Angles[bone][frame].y = yrot;
-		Angles[bone][frame].z = zrot;
-		HasData[bone] = true;
-	}
+				const float* q0 = srcrotation + i * 4;
+				const float* q1 = srcrotation + next * 4;
+				float cosom = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+				float sign = 1.0f;
 
-	void AnimationSave::CopyVisibility(int bone, int frame, bool vis, float floatvis)
-	{
-		BitChannels[bone][frame] = vis;
-		VisibilityChannels[bone][frame] = floatvis;
-		HasData[bone] = true;
-	}
+				if (cosom < 0.0f)
+				{
+					cosom = -cosom;
+					sign = -1.0f;
+				}
 
-	Matrix3 AnimationSave::GetTransform(int node, int frame)
-	{
-		return Transforms[node][frame];
+				float scale0 = 1.0f - alpha;
+				float scale1 = alpha;
+
+				if (alpha > 0.0f && cosom < 0.9999f)
+				{
+					float omega = acosf(cosom);
+					float sinom = sinf(omega);
+					scale0 = sinf((1.0f - alpha) * omega) / sinom;
+					scale1 = sinf(alpha * omega) / sinom;
+				}
+
+				float* q = rotation + frame * 4;
+				float length = 0.0f;
+
+				for (int k = 0; k < 4; k++)
+				{
+					q[k] = q0[k] * scale0 + q1[k] * scale1 * sign;
+					length += q[k] * q[k];
+				}
+
+				length = 1.0f / sqrtf(length);
+
+				for (int k = 0; k < 4; k++)
+				{
+					q[k] *= length;
+				}
+
+				int index = bone * numframes + frame;
+				visibility[index] = srcvisibility[i] + (srcvisibility[next] - srcvisibility[i]) * alpha;
+				// NOTE: Visibility is a step function, it holds the value of the source frame at or before the sample
+				flags[index] = srcflags[i] & FRAME_VISIBLE;
+
+				// NOTE: Every source binary move since the previous output frame is carried onto this one so that no cut gets lost when frames are dropped
+				for (int k = previous + 1; k <= i; k++)
+				{
+					if (srcflags[k] & FRAME_BINARY_MOVE)
+					{
+						flags[index] |= FRAME_BINARY_MOVE;
+					}
+				}
+
+				previous = i;
+			}
+		}
+
+		LogDataDialogClass::WriteLogWindow(L"Resampled %d frames at %d fps to %d frames at %d fps\n", NumFrames, FrameRate, numframes, framerate);
+		Translations.swap(translations);
+		Rotations.swap(rotations);
+		Visibility.swap(visibility);
+		FrameFlags.swap(flags);
+		NumFrames = numframes;
+		FrameRate = framerate;
 	}
 
-#ifndef W3X
 	bool AnimationSave::WriteAnimationHeader(ChunkSaveClass& csave)
 	{
 		LogDataDialogClass::WriteLogWindow(L"Save Header Type: ");
+
+		if (Flavor < ANIM_FLAVOR_VALID)
+		{
+			LogDataDialogClass::WriteLogWindow(Flavor == ANIM_FLAVOR_TIMECODED ? L"Compressed: Time-coded.\n" : L"Compressed: Adaptive Delta.\n");
+
+			if (!csave.Begin_Chunk(W3DChunkType::COMPRESSED_ANIMATION_HEADER))
+			{
+				return false;
+			}
+
+			W3dCompressedAnimHeaderStruct header;
+			header.Version = W3D_CURRENT_COMPRESSED_HANIM_VERSION;
+			CopyW3DName(header.Name, Name);
+			CopyW3DName(header.HierarchyName, Hierarchy->GetHierarchyName());
+			header.NumFrames = NumFrames;
+			header.FrameRate = (uint16)FrameRate;
+			header.Flavor = (uint16)Flavor;
+
+			if (csave.Write(&header, sizeof(W3dCompressedAnimHeaderStruct)) != sizeof(W3dCompressedAnimHeaderStruct))
+			{
+				return false;
+			}
+
+			return csave.End_Chunk();
+		}
+
 		LogDataDialogClass::WriteLogWindow(L"Non-Compressed.\n");
 
 		if (!csave.Begin_Chunk(W3DChunkType::ANIMATION_HEADER))
@@ -9708,19 +10887,20 @@ namespace W3D::MaxTools
 		int NumFrames;
 		bool HasNoData;
 		bool DefaultVal;
-		BooleanVectorClass Vector;
+		const unsigned char* Vector;
+		unsigned char Mask;
 		int FirstFrame;
 		int LastFrame;
 
 	public:
 		bool GetData(int frame);
+		int NextToggle(int frame);
 		void UpdateStartEnd();
-		void SetData(int frame, bool data);
-		void Init(BooleanVectorClass& vector);
 #ifndef W3X
 		bool WriteChannel(ChunkSaveClass& csave);
+		bool WriteTimeCodedChannel(ChunkSaveClass& csave);
 #endif
-		BitChannel(int pivot, int numframes, int flags, bool defaultval);
+		BitChannel(int pivot, int numframes, int flags, bool defaultval, const unsigned char* vector, unsigned char mask);
 		~BitChannel();
 
 		friend class AnimationSave;
@@ -9728,43 +10908,40 @@ namespace W3D::MaxTools
 
 	bool BitChannel::GetData(int frame)
 	{
-		return Vector[frame];
+		return (Vector[frame] & Mask) != 0;
 	}
 
-	void BitChannel::UpdateStartEnd()
+	int BitChannel::NextToggle(int frame)
 	{
-		for (FirstFrame = 0; FirstFrame < NumFrames; FirstFrame++)
-		{
-			if (Vector[FirstFrame] != DefaultVal)
-			{
-				break;
-			}
-		}
+		unsigned char value = Vector[frame] & Mask;
 
-		for (LastFrame = NumFrames - 1; LastFrame >= 0; LastFrame--)
+		for (frame++; frame < NumFrames; frame++)
 		{
-			if (Vector[LastFrame] != DefaultVal)
+			if ((Vector[frame] & Mask) != value)
 			{
 				break;
 			}
 		}
+
+		return frame;
 	}
 
-	void BitChannel::SetData(int frame, bool data)
+	void BitChannel::UpdateStartEnd()
 	{
-		Vector[frame] = data;
-
-		if (data != DefaultVal)
+		for (FirstFrame = 0; FirstFrame < NumFrames; FirstFrame++)
 		{
-			HasNoData = false;
+			if (GetData(FirstFrame) != DefaultVal)
+			{
+				break;
+			}
 		}
-	}
 
-	void BitChannel::Init(BooleanVectorClass& vector)
-	{
-		for (int i = 0; i < vector.Length(); i++)
+		for (LastFrame = NumFrames - 1; LastFrame >= 0; LastFrame--)
 		{
-			SetData(i, vector[i]);
+			if (GetData(LastFrame) != DefaultVal)
+			{
+				break;
+			}
 		}
 	}
 
@@ -9783,23 +10960,26 @@ namespace W3D::MaxTools
 
 		UpdateStartEnd();
 		int length = (LastFrame - FirstFrame + 8) / 8 + 9;
-		char* c = new char[length];
-		W3dBitChannelStruct* w = (W3dBitChannelStruct*)c;
-
-		if (!w)
-		{
-			return false;
-		}
-
+		std::vector<unsigned char> buffer(length, 0);
+		W3dBitChannelStruct* w = (W3dBitChannelStruct*)buffer.data();
 		w->FirstFrame = FirstFrame;
 		w->LastFrame = LastFrame;
 		w->Flags = Flags;
 		w->Pivot = Pivot;
 		w->DefaultVal = DefaultVal;
 
-		for (int i = 0; i < LastFrame - FirstFrame + 1; i++)
+		// NOTE: The bits are filled a run at a time, the buffer starts out cleared so only the runs of set frames touch it
+		for (int i = FirstFrame; i <= LastFrame;)
 		{
-			Set_Bit(w->Data, i, Vector[i + FirstFrame]);
+			int next = NextToggle(i);
+			next = next <= LastFrame ? next : LastFrame + 1;
+
+			if (GetData(i))
+			{
+				Set_Bit_Run(w->Data, i - FirstFrame, next - i);
+			}
+
+			i = next;
 		}
 
 		if (csave.Write(w, length) != length)
@@ -9807,205 +10987,823 @@ namespace W3D::MaxTools
 			return false;
 		}
 
-		delete[] c;
-		return csave.End_Chunk();
-	}
-#endif
+		return csave.End_Chunk();
+	}
+
+	bool BitChannel::WriteTimeCodedChannel(ChunkSaveClass& csave)
+	{
+		if (HasNoData)
+		{
+			return true;
+		}
+
+		// NOTE: Only the frames where the bit changes are stored, the first one always holds the value at frame 0.
+		std::vector<uint32> timecodes;
+		timecodes.push_back(GetData(0) ? W3D_TIMECODED_BIT_MASK : 0);
+
+		for (int i = NextToggle(0); i < NumFrames; i = NextToggle(i))
+		{
+			timecodes.push_back(i | (GetData(i) ? W3D_TIMECODED_BIT_MASK : 0));
+		}
+
+		if (!csave.Begin_Chunk(W3DChunkType::COMPRESSED_BIT_CHANNEL))
+		{
+			return false;
+		}
+
+		W3dTimeCodedBitChannelStruct w;
+		w.NumTimeCodes = (uint32)timecodes.size();
+		w.Pivot = (uint16)Pivot;
+		w.Flags = (uint8)Flags;
+		w.DefaultVal = DefaultVal;
+		int headersize = sizeof(W3dTimeCodedBitChannelStruct) - sizeof(uint32);
+		int datasize = (int)(timecodes.size() * sizeof(uint32));
+
+		if (csave.Write(&w, headersize) != headersize || csave.Write(timecodes.data(), datasize) != datasize)
+		{
+			return false;
+		}
+
+		return csave.End_Chunk();
+	}
+#endif
+
+	BitChannel::BitChannel(int pivot, int numframes, int flags, bool defaultval, const unsigned char* vector, unsigned char mask) : Pivot(pivot), Flags(flags), NumFrames(numframes), HasNoData(true), DefaultVal(defaultval), Vector(vector), Mask(mask), FirstFrame(NumFrames), LastFrame(0)
+	{
+		for (int i = 0; i < NumFrames && HasNoData; i++)
+		{
+			if (GetData(i) != DefaultVal)
+			{
+				HasNoData = false;
+			}
+		}
+	}
+
+	BitChannel::~BitChannel()
+	{
+	}
+
+	class AnimChannel
+	{
+		int Pivot;
+		int Flags;
+		int NumFrames;
+		int VectorLen;
+		bool HasNoData;
+		float* DefaultVector;
+		float* Vector; // NOTE: Points into the capture streams of AnimationSave, the channel does not own it
+		int FirstFrame;
+		int LastFrame;
+
+	public:
+		enum
+		{
+			CHANNEL_CONSTANT,
+			CHANNEL_LINEAR,
+			CHANNEL_PIECEWISE_LINEAR,
+		};
+
+		AnimChannel(int pivot, int numframes, int flags, int vectorlen, float* defaultvector, float* vector);
+		~AnimChannel();
+		bool IsDefault(float* value);
+		void UpdateStartEnd();
+		void ApplyVisibility(BitChannel& channel);
+#ifndef W3X
+		bool WriteChannel(ChunkSaveClass& csave, BitChannel* bmove);
+		float KeyError(int key1, int key2, int frame, const float* source = nullptr);
+		float SpanError(int key1, int key2, const float* source = nullptr);
+		int Classify(BitChannel* bmove, float maxerror);
+		void ReduceKeys(std::vector<int>& keys, BitChannel* bmove, float maxerror, int maxkeys);
+		void ReduceKeyPrecision(const std::vector<int>& keys, float maxerror);
+		bool WriteTimeCodedChannel(ChunkSaveClass& csave, BitChannel* bmove, float maxerror, int maxkeys, int shape, bool reduceprecision, int& keycount);
+		void AlignQuaternions();
+		bool EncodeAdaptiveDelta(std::vector<unsigned char>& data, float& scale, float maxerror);
+		bool WriteAdaptiveDeltaChannel(ChunkSaveClass& csave, float maxerror, bool& withintolerance);
+#else
+		bool WriteChannel(XMLWriter& csave, BitChannel* bmove);
+#endif
+
+		friend class AnimationSave;
+	};
+
+	AnimChannel::AnimChannel(int pivot, int numframes, int flags, int vectorlen, float* defaultvector, float* vector) : Pivot(pivot), Flags(flags), NumFrames(numframes), VectorLen(vectorlen), HasNoData(true), DefaultVector(nullptr), Vector(vector), FirstFrame(0), LastFrame(0)
+	{
+		DefaultVector = new float[vectorlen];
+		memcpy(DefaultVector, defaultvector, vectorlen * 4);
+		FirstFrame = NumFrames;
+		LastFrame = 0;
+
+		for (int i = 0; i < NumFrames && HasNoData; i++)
+		{
+			if (!IsDefault(&Vector[i * VectorLen]))
+			{
+				HasNoData = false;
+			}
+		}
+	}
+
+	AnimChannel::~AnimChannel()
+	{
+		if (DefaultVector)
+		{
+			delete[] DefaultVector;
+		}
+	}
+
+	bool AnimChannel::IsDefault(float* value)
+	{
+		float f = 0.0f;
+
+		for (int i = VectorLen; i; i--)
+		{
+			float f2 = value[i - 1] - DefaultVector[i - 1];
+			f = f + f2 * f2;
+		}
+
+		if (f < 0.0000000025f)
+		{
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	void AnimChannel::UpdateStartEnd()
+	{
+		for (FirstFrame = 0; FirstFrame < NumFrames; FirstFrame++)
+		{
+			if (!IsDefault(&Vector[FirstFrame * VectorLen]))
+			{
+				break;
+			}
+		}
+
+		for (LastFrame = NumFrames - 1; LastFrame >= 0; LastFrame--)
+		{
+			if (!IsDefault(&Vector[LastFrame * VectorLen]))
+			{
+				break;
+			}
+		}
+	}
+
+	void AnimChannel::ApplyVisibility(BitChannel& channel)
+	{
+		bool data = channel.GetData(0);
+		float* vector = Vector;
+
+		for (int i = 0; i < NumFrames; i++)
+		{
+			bool b = channel.GetData(i);
+
+			if (b != data)
+			{
+				data = b;
+				vector = &Vector[i * VectorLen];
+			}
+
+			if (!b)
+			{
+				for (int j = 0; j < VectorLen; j++)
+				{
+					Vector[j + i * VectorLen] = vector[j];
+				}
+
+				if (!IsDefault(vector))
+				{
+					HasNoData = false;
+				}
+			}
+		}
+	}
+
+#ifndef W3X
+	bool AnimChannel::WriteChannel(ChunkSaveClass& csave, BitChannel* bmove)
+	{
+		if (HasNoData)
+		{
+			return true;
+		}
+
+		UpdateStartEnd();
+
+		if (LastFrame < FirstFrame)
+		{
+			HasNoData = true;
+			return true;
+		}
+
+		if (!csave.Begin_Chunk(W3DChunkType::ANIMATION_CHANNEL))
+		{
+			return false;
+		}
+
+		int frames = LastFrame - FirstFrame + 1;
+		int frames2 = 4 * frames * VectorLen + 12;
+		char* c = new char[frames2];
+		W3dAnimChannelStruct* w = (W3dAnimChannelStruct*)c;
+
+		if (!w)
+		{
+			return false;
+		}
+
+		w->FirstFrame = FirstFrame;
+		w->LastFrame = LastFrame;
+		w->VectorLen = VectorLen;
+		w->Pivot = Pivot;
+		w->Flags = Flags;
+		w->pad = 0; // fill padding with zeros to have a deterministic output
+
+		for (int i = 0; i < frames; i++)
+		{
+			for (int j = 0; j < VectorLen; j++)
+			{
+				w->Data[j + i * VectorLen] = Vector[j + VectorLen * (i + FirstFrame)];
+			}
+		}
+
+		if (csave.Write(w, frames2) == frames2)
+		{
+			delete[] w;
+			return csave.End_Chunk();
+		}
+
+		return false;
+	}
+
+	// Error at frame when it is interpolated from the keys at key1 and key2, in units for scalar channels and degrees for quaternions.
+	// The expected value comes from source when the keys in Vector no longer hold the captured values.
+	float AnimChannel::KeyError(int key1, int key2, int frame, const float* source)
+	{
+		float t = (float)(frame - key1) / (float)(key2 - key1);
+		float* v1 = &Vector[key1 * VectorLen];
+		float* v2 = &Vector[key2 * VectorLen];
+		const float* v = &(source ? source : Vector)[frame * VectorLen];
+
+		if (VectorLen != 4)
+		{
+			return fabsf(v1[0] + (v2[0] - v1[0]) * t - v[0]);
+		}
+
+		float cosom = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2] + v1[3] * v2[3];
+		float sign = 1.0f;
+
+		if (cosom < 0.0f)
+		{
+			cosom = -cosom;
+			sign = -1.0f;
+		}
+
+		float s1 = 1.0f - t;
+		float s2 = t;
+
+		if (cosom < 0.9999f)
+		{
+			float omega = acosf(cosom);
+			float sinom = sinf(omega);
+			s1 = sinf(s1 * omega) / sinom;
+			s2 = sinf(s2 * omega) / sinom;
+		}
+
+		s2 *= sign;
+		float q[4];
+		float len = 0.0f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			q[i] = v1[i] * s1 + v2[i] * s2;
+			len += q[i] * q[i];
+		}
+
+		// NOTE: The angle comes from the chord length, acos of the dot product is too imprecise for errors this small
+		len = sqrtf(len);
+
+		if (q[0] * v[0] + q[1] * v[1] + q[2] * v[2] + q[3] * v[3] < 0.0f)
+		{
+			len = -len;
+		}
+
+		float d = 0.0f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			float f = q[i] / len - v[i];
+			d += f * f;
+		}
+
+		d = sqrtf(d) * 0.5f;
+
+		if (d > 1.0f)
+		{
+			d = 1.0f;
+		}
+
+		return asinf(d) * 4.0f * 57.29578f;
+	}
+
+	float AnimChannel::SpanError(int key1, int key2, const float* source)
+	{
+		float error = 0.0f;
+
+		for (int i = key1 + 1; i < key2; i++)
+		{
+			float e = KeyError(key1, key2, i, source);
+
+			if (e > error)
+			{
+				error = e;
+			}
+		}
+
+		return error;
+	}
+
+	// Checks whether a key on the first and the last frame reproduce the channel within maxerror, constant channels are the ones where
+	// the first key alone does. Binary moves need keys of their own and always count as piecewise linear.
+	int AnimChannel::Classify(BitChannel* bmove, float maxerror)
+	{
+		int last = NumFrames - 1;
+
+		for (int i = 1; bmove && i <= last; i++)
+		{
+			if (bmove->GetData(i))
+			{
+				return CHANNEL_PIECEWISE_LINEAR;
+			}
+		}
+
+		if (last < 1)
+		{
+			return CHANNEL_CONSTANT;
+		}
+
+		AlignQuaternions();
+
+		if (VectorLen == 4)
+		{
+			// NOTE: Slerp needs the angle of every frame, so quaternions are checked one frame at a time
+			bool constant = true;
+			__m128 q1 = _mm_loadu_ps(Vector);
+
+			for (int i = 1; i <= last; i++)
+			{
+				if (i < last && KeyError(0, last, i) > maxerror)
+				{
+					return CHANNEL_PIECEWISE_LINEAR;
+				}
+
+				// NOTE: q and -q are the same rotation and only neighbouring frames are aligned, so the closer of the two counts
+				__m128 q2 = _mm_loadu_ps(&Vector[i * 4]);
+				__m128 d1 = _mm_sub_ps(q1, q2);
+				__m128 d2 = _mm_add_ps(q1, q2);
+				d1 = _mm_mul_ps(d1, d1);
+				d2 = _mm_mul_ps(d2, d2);
+				d1 = _mm_add_ps(d1, _mm_movehl_ps(d1, d1));
+				d2 = _mm_add_ps(d2, _mm_movehl_ps(d2, d2));
+				d1 = _mm_add_ss(d1, _mm_shuffle_ps(d1, d1, 1));
+				d2 = _mm_add_ss(d2, _mm_shuffle_ps(d2, d2, 1));
+				float e = sqrtf(_mm_cvtss_f32(_mm_min_ss(d1, d2))) * 0.5f;
+
+				if (asinf(e > 1.0f ? 1.0f : e) * 4.0f * 57.29578f > maxerror)
+				{
+					constant = false;
+				}
+			}
+
+			return constant ? CHANNEL_CONSTANT : CHANNEL_LINEAR;
+		}
+
+		// Scalar channels are checked four frames at a time against the line through the first and the last frame
+		float first = Vector[0];
+		float slope = (Vector[last] - first) / (float)last;
+		__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		__m128 base = _mm_set1_ps(first);
+		__m128 step = _mm_set1_ps(slope);
+		__m128 frame = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		__m128 four = _mm_set1_ps(4.0f);
+		__m128 error = _mm_setzero_ps();
+		__m128 deviation = _mm_setzero_ps(); // from the first frame
+		int i = 0;
+
+		for (; i + 4 <= NumFrames; i += 4)
+		{
+			__m128 v = _mm_loadu_ps(&Vector[i]);
+			__m128 line = _mm_add_ps(base, _mm_mul_ps(step, frame));
+			error = _mm_max_ps(error, _mm_and_ps(_mm_sub_ps(v, line), mask));
+			deviation = _mm_max_ps(deviation, _mm_and_ps(_mm_sub_ps(v, base), mask));
+			frame = _mm_add_ps(frame, four);
+		}
+
+		error = _mm_max_ps(error, _mm_movehl_ps(error, error));
+		error = _mm_max_ss(error, _mm_shuffle_ps(error, error, 1));
+		deviation = _mm_max_ps(deviation, _mm_movehl_ps(deviation, deviation));
+		deviation = _mm_max_ss(deviation, _mm_shuffle_ps(deviation, deviation, 1));
+		float maxdiff = _mm_cvtss_f32(error);
+		float maxdeviation = _mm_cvtss_f32(deviation);
+
+		for (; i < NumFrames; i++)
+		{
+			float e = fabsf(Vector[i] - (first + slope * i));
+			float d = fabsf(Vector[i] - first);
+
+			if (e > maxdiff)
+			{
+				maxdiff = e;
+			}
+
+			if (d > maxdeviation)
+			{
+				maxdeviation = d;
+			}
+		}
+
+		if (maxdiff > maxerror)
+		{
+			return CHANNEL_PIECEWISE_LINEAR;
+		}
+
+		return maxdeviation <= maxerror ? CHANNEL_CONSTANT : CHANNEL_LINEAR;
+	}
+
+	void AnimChannel::ReduceKeys(std::vector<int>& keys, BitChannel* bmove, float maxerror, int maxkeys)
+	{
+		// NOTE: Spans are grown greedily from the last key and are capped so the error checks stay linear in the frame count.
+		//       A binary move is stored as a key holding the previous frame plus a flagged key on the frame itself.
+		const int maxspan = 256;
+		keys.clear();
+		keys.push_back(0);
+		int key = 0;
+
+		while (key < NumFrames - 1)
+		{
+			int next = key + 1;
+
+			if (!bmove || !bmove->GetData(next))
+			{
+				while (next + 1 < NumFrames && next + 1 - key <= maxspan && (!bmove || !bmove->GetData(next + 1)) && SpanError(key, next + 1) <= maxerror)
+				{
+					next++;
+				}
+			}
+
+			keys.push_back(next);
+			key = next;
+		}
+
+		if ((int)keys.size() <= maxkeys)
+		{
+			return;
+		}
+
+		// Forced key reduction, keep removing the key that adds the least error until the budget is met
+		std::vector<float> errors(keys.size(), FLT_MAX);
+		auto update = [&](int i)
+		{
+			errors[i] = FLT_MAX;
+
+			if (i > 0 && i < (int)keys.size() - 1 && (!bmove || (!bmove->GetData(keys[i]) && !bmove->GetData(keys[i + 1]))))
+			{
+				errors[i] = SpanError(keys[i - 1], keys[i + 1]);
+			}
+		};
+
+		for (int i = 0; i < (int)keys.size(); i++)
+		{
+			update(i);
+		}
+
+		while ((int)keys.size() > maxkeys)
+		{
+			int best = -1;
+
+			for (int i = 1; i < (int)keys.size() - 1; i++)
+			{
+				if (errors[i] != FLT_MAX && (best == -1 || errors[i] < errors[best]))
+				{
+					best = i;
+				}
+			}
+
+			if (best == -1)
+			{
+				break;
+			}
+
+			keys.erase(keys.begin() + best);
+			errors.erase(errors.begin() + best);
+			update(best - 1);
+			update(best);
+		}
+	}
+
+	// Rounds off as many low mantissa bits of each key as the error budget allows. The chunk stays the same size,
+	// but the zeroed bits make the keys far more compressible once the file is packed.
+	void AnimChannel::ReduceKeyPrecision(const std::vector<int>& keys, float maxerror)
+	{
+		if (keys.size() < 2)
+		{
+			return;
+		}
+
+		std::vector<float> source(Vector, Vector + NumFrames * VectorLen);
 
-	BitChannel::BitChannel(int pivot, int numframes, int flags, bool defaultval) : Pivot(pivot), Flags(flags), NumFrames(numframes), HasNoData(true), DefaultVal(defaultval), Vector(numframes), FirstFrame(NumFrames), LastFrame(0)
-	{
-	}
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			int key = keys[i];
+			int prev = i > 0 ? keys[i - 1] : -1;
+			int next = i + 1 < keys.size() ? keys[i + 1] : -1;
+			float* v = &Vector[key * VectorLen];
 
-	BitChannel::~BitChannel()
-	{
-	}
+			for (int bits = 20; bits > 0; bits -= 2)
+			{
+				float len = 0.0f;
 
-	class AnimChannel
-	{
-		int Pivot;
-		int Flags;
-		int NumFrames;
-		int VectorLen;
-		bool HasNoData;
-		float* DefaultVector;
-		float* Vector;
-		int FirstFrame;
-		int LastFrame;
+				for (int j = 0; j < VectorLen; j++)
+				{
+					uint32 u;
+					memcpy(&u, &source[key * VectorLen + j], sizeof(u));
+					u = (u + (1u << (bits - 1))) & ~((1u << bits) - 1);
+					memcpy(&v[j], &u, sizeof(u));
+					len += v[j] * v[j];
+				}
 
-	public:
-		AnimChannel(int pivot, int numframes, int flags, int vectorlen, float* defaultvector);
-		~AnimChannel();
-		bool IsDefault(float* value);
-		void UpdateStartEnd();
-		void SetData(int frame, float* data);
-		void ApplyVisibility(BitChannel& channel);
-#ifndef W3X
-		bool WriteChannel(ChunkSaveClass& csave, BitChannel* bmove);
-#else
-		bool WriteChannel(XMLWriter& csave, BitChannel* bmove);
-#endif
+				// NOTE: The runtime does not renormalize the keys, so a quaternion that is no longer unit length would scale the bone
+				bool valid = VectorLen != 4 || fabsf(len - 1.0f) < 0.0001f;
+				valid = valid && (next != -1 ? KeyError(key, next, key, source.data()) : KeyError(prev, key, key, source.data())) <= maxerror;
+				valid = valid && (prev == -1 || SpanError(prev, key, source.data()) <= maxerror);
+				valid = valid && (next == -1 || SpanError(key, next, source.data()) <= maxerror);
 
-		friend class AnimationSave;
-	};
+				if (valid)
+				{
+					break;
+				}
 
-	AnimChannel::AnimChannel(int pivot, int numframes, int flags, int vectorlen, float* defaultvector) : Pivot(pivot), Flags(flags), NumFrames(numframes), VectorLen(vectorlen), HasNoData(true), DefaultVector(nullptr), Vector(nullptr), FirstFrame(0), LastFrame(0)
-	{
-		DefaultVector = new float[vectorlen];
-		Vector = new float[vectorlen * numframes];
-		memcpy(DefaultVector, defaultvector, vectorlen * 4);
-		memset(Vector, 0, 4 * VectorLen * NumFrames);
-		FirstFrame = NumFrames;
-		LastFrame = 0;
+				memcpy(v, &source[key * VectorLen], VectorLen * sizeof(float));
+			}
+		}
 	}
 
-	AnimChannel::~AnimChannel()
+	bool AnimChannel::WriteTimeCodedChannel(ChunkSaveClass& csave, BitChannel* bmove, float maxerror, int maxkeys, int shape, bool reduceprecision, int& keycount)
 	{
-		if (Vector)
+		if (HasNoData)
 		{
-			delete[] Vector;
+			return true;
 		}
 
-		if (DefaultVector)
+		AlignQuaternions();
+		std::vector<int> keys;
+
+		if (shape == CHANNEL_PIECEWISE_LINEAR)
 		{
-			delete[] DefaultVector;
+			ReduceKeys(keys, bmove, maxerror, maxkeys);
 		}
-	}
+		else
+		{
+			// NOTE: The greedy reduction caps its spans, a linear channel gets away with the two end keys and a constant one with the first
+			keys.push_back(0);
 
-	bool AnimChannel::IsDefault(float* value)
-	{
-		float f = 0.0f;
+			if (shape == CHANNEL_LINEAR)
+			{
+				keys.push_back(NumFrames - 1);
+			}
+		}
 
-		for (int i = VectorLen; i; i--)
+		keycount = (int)keys.size();
+		std::vector<float> source;
+
+		if (reduceprecision)
 		{
-			float f2 = value[i - 1] - DefaultVector[i - 1];
-			f = f + f2 * f2;
+			// NOTE: Vector is the captured animation, the other flavors still need it unrounded
+			source.assign(Vector, Vector + NumFrames * VectorLen);
+			ReduceKeyPrecision(keys, maxerror);
 		}
 
-		if (f < 0.0000000025f)
+		int packetsize = VectorLen + 1;
+		std::vector<uint32> packets(keys.size() * packetsize);
+
+		for (size_t i = 0; i < keys.size(); i++)
 		{
-			return true;
+			int frame = keys[i];
+			packets[i * packetsize] = frame;
+
+			if (frame && bmove && bmove->GetData(frame))
+			{
+				packets[i * packetsize] |= W3D_TIMECODED_BINARY_MOVEMENT_FLAG;
+			}
+
+			memcpy(&packets[i * packetsize + 1], &Vector[frame * VectorLen], VectorLen * sizeof(float));
 		}
-		else
+
+		if (!source.empty())
 		{
-			return false;
+			memcpy(Vector, source.data(), source.size() * sizeof(float));
 		}
-	}
 
-	void AnimChannel::UpdateStartEnd()
-	{
-		for (FirstFrame = 0; FirstFrame < NumFrames; FirstFrame++)
+		if (!csave.Begin_Chunk(W3DChunkType::COMPRESSED_ANIMATION_CHANNEL))
 		{
-			if (!IsDefault(&Vector[FirstFrame * VectorLen]))
-			{
-				break;
-			}
+			return false;
 		}
 
-		for (LastFrame = NumFrames - 1; LastFrame >= 0; LastFrame--)
+		W3dTimeCodedAnimChannelStruct w;
+		w.NumTimeCodes = (uint32)keys.size();
+		w.Pivot = (uint16)Pivot;
+		w.VectorLen = (uint8)VectorLen;
+		w.Flags = (uint8)Flags;
+		int headersize = sizeof(W3dTimeCodedAnimChannelStruct) - sizeof(uint32);
+		int datasize = (int)(packets.size() * sizeof(uint32));
+
+		if (csave.Write(&w, headersize) != headersize || csave.Write(packets.data(), datasize) != datasize)
 		{
-			if (!IsDefault(&Vector[LastFrame * VectorLen]))
-			{
-				break;
-			}
+			return false;
 		}
+
+		return csave.End_Chunk();
 	}
 
-	void AnimChannel::SetData(int frame, float* data)
+	// Keeps neighbouring quaternions in the same hemisphere so interpolation and deltas take the short way
+	void AnimChannel::AlignQuaternions()
 	{
-		for (int i = 0; i < VectorLen; i++)
+		if (VectorLen != 4)
 		{
-			Vector[i + frame * VectorLen] = data[i];
+			return;
 		}
 
-		if (!IsDefault(data))
+		for (int i = 1; i < NumFrames; i++)
 		{
-			HasNoData = false;
+			float* q1 = &Vector[(i - 1) * 4];
+			float* q2 = &Vector[i * 4];
+
+			if (q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3] < 0.0f)
+			{
+				q2[0] = -q2[0];
+				q2[1] = -q2[1];
+				q2[2] = -q2[2];
+				q2[3] = -q2[3];
+			}
 		}
 	}
 
-	void AnimChannel::ApplyVisibility(BitChannel& channel)
+	// Fills data with the adaptive delta stream described in w3d.h, false if any frame decodes further than maxerror from Vector
+	bool AnimChannel::EncodeAdaptiveDelta(std::vector<unsigned char>& data, float& scale, float maxerror)
 	{
-		bool data = channel.GetData(0);
-		float* vector = Vector;
-
-		for (int i = 0; i < NumFrames; i++)
+		static const std::vector<float> filters = []()
 		{
-			bool b = channel.GetData(i);
+			std::vector<float> table(256);
 
-			if (b != data)
+			for (int i = 0; i < 256; i++)
 			{
-				data = b;
-				vector = &Vector[i * VectorLen];
+				table[i] = W3d_Adaptive_Delta_Filter(i);
 			}
 
-			if (!b)
+			return table;
+		}();
+
+		float largest = 0.0f;
+
+		for (int i = 1; i < NumFrames; i++)
+		{
+			for (int j = 0; j < VectorLen; j++)
 			{
-				for (int j = 0; j < VectorLen; j++)
+				float d = fabsf(Vector[i * VectorLen + j] - Vector[(i - 1) * VectorLen + j]);
+
+				if (d > largest)
 				{
-					Vector[j + i * VectorLen] = vector[j];
+					largest = d;
 				}
+			}
+		}
 
-				if (!IsDefault(vector))
+		scale = largest / 7.0f;
+		int blocks = (NumFrames + 15) >> 4;
+		int packetsize = 9;
+		data.assign(VectorLen * sizeof(float) + blocks * VectorLen * packetsize, 0);
+		memcpy(data.data(), Vector, VectorLen * sizeof(float));
+		unsigned char* packet = data.data() + VectorLen * sizeof(float);
+
+		// NOTE: Deltas are taken from the decoded values rather than the source so rounding does not accumulate over the blocks
+		std::vector<float> values(Vector, Vector + VectorLen);
+		float error = 0.0f;
+		int deltas[16];
+		int bestdeltas[16];
+
+		for (int i = 0; i < blocks; i++)
+		{
+			for (int j = 0; j < VectorLen; j++)
+			{
+				int bestfilter = 0;
+				float besterror = FLT_MAX;
+				float bestvalue = values[j];
+
+				for (int f = 0; f < 256 && besterror > 0.0f; f++)
 				{
-					HasNoData = false;
+					float step = filters[f] * scale;
+					float value = values[j];
+					float e = 0.0f;
+
+					for (int k = 0; k < 16 && e < besterror; k++)
+					{
+						int frame = i * 16 + k + 1;
+						deltas[k] = 0;
+
+						if (frame >= NumFrames)
+						{
+							continue;
+						}
+
+						float target = Vector[frame * VectorLen + j];
+
+						if (step > 0.0f)
+						{
+							float q = floorf((target - value) / step + 0.5f);
+							deltas[k] = q < -8.0f ? -8 : (q > 7.0f ? 7 : (int)q);
+							value += step * deltas[k];
+						}
+
+						float d = fabsf(value - target);
+
+						if (d > e)
+						{
+							e = d;
+						}
+					}
+
+					if (e < besterror)
+					{
+						besterror = e;
+						bestfilter = f;
+						bestvalue = value;
+						memcpy(bestdeltas, deltas, sizeof(deltas));
+					}
+				}
+
+				packet[0] = (unsigned char)bestfilter;
+
+				for (int k = 0; k < 16; k++)
+				{
+					packet[1 + k / 2] |= (bestdeltas[k] & 0xF) << ((k & 1) * 4);
+				}
+
+				values[j] = bestvalue;
+				packet += packetsize;
+
+				if (besterror > error)
+				{
+					error = besterror;
 				}
 			}
 		}
+
+		return error <= maxerror;
 	}
 
-#ifndef W3X
-	bool AnimChannel::WriteChannel(ChunkSaveClass& csave, BitChannel* bmove)
+	// withintolerance is false if some frame would decode further than maxerror from Vector, nothing is written then
+	bool AnimChannel::WriteAdaptiveDeltaChannel(ChunkSaveClass& csave, float maxerror, bool& withintolerance)
 	{
+		withintolerance = true;
+
 		if (HasNoData)
 		{
 			return true;
 		}
 
-		UpdateStartEnd();
+		AlignQuaternions();
+		std::vector<unsigned char> data;
+		float scale = 0.0f;
 
-		if (LastFrame < FirstFrame)
+		// NOTE: The runtime only decodes 4 bit deltas, so a channel that needs more precision makes the animation fall back to time-coded
+		if (!EncodeAdaptiveDelta(data, scale, maxerror))
 		{
-			HasNoData = true;
+			withintolerance = false;
 			return true;
 		}
 
-		if (!csave.Begin_Chunk(W3DChunkType::ANIMATION_CHANNEL))
+		if (!csave.Begin_Chunk(W3DChunkType::COMPRESSED_ANIMATION_CHANNEL))
 		{
 			return false;
 		}
 
-		int frames = LastFrame - FirstFrame + 1;
-		int frames2 = 4 * frames * VectorLen + 12;
-		char* c = new char[frames2];
-		W3dAnimChannelStruct* w = (W3dAnimChannelStruct*)c;
+		W3dAdaptiveDeltaAnimChannelStruct w;
+		w.NumFrames = NumFrames;
+		w.Pivot = (uint16)Pivot;
+		w.VectorLen = (uint8)VectorLen;
+		w.Flags = (uint8)Flags;
+		w.Scale = scale;
+		int headersize = sizeof(W3dAdaptiveDeltaAnimChannelStruct) - sizeof(uint32);
 
-		if (!w)
+		if (csave.Write(&w, headersize) != headersize)
 		{
 			return false;
 		}
 
-		w->FirstFrame = FirstFrame;
-		w->LastFrame = LastFrame;
-		w->VectorLen = VectorLen;
-		w->Pivot = Pivot;
-		w->Flags = Flags;
-		w->pad = 0; // fill padding with zeros to have a deterministic output
-
-		for (int i = 0; i < frames; i++)
-		{
-			for (int j = 0; j < VectorLen; j++)
-			{
-				w->Data[j + i * VectorLen] = Vector[j + VectorLen * (i + FirstFrame)];
-			}
-		}
-
-		if (csave.Write(w, frames2) == frames2)
+		if (csave.Write(data.data(), (unsigned long)data.size()) != data.size())
 		{
-			delete[] w;
-			return csave.End_Chunk();
+			return false;
 		}
 
-		return false;
+		return csave.End_Chunk();
 	}
 #else
 
@@ -10097,16 +11895,163 @@ namespace W3D::MaxTools
 					return false;
 				}
 
-				if (!csave.WriteClosingTag())
-				{
-					return false;
-				}
-			}
+				if (!csave.WriteClosingTag())
+				{
+					return false;
+				}
+			}
+		}
+
+		return csave.WriteClosingTag();
+	}
+#endif
+
+#ifndef W3X
+	void AnimationSave::WriteBoneChannels(ChunkSaveClass& csave, int bone, int maxkeys, BoneChannelStats& stats)
+#else
+	void AnimationSave::WriteBoneChannels(XMLWriter& csave, int bone, int maxkeys, BoneChannelStats& stats)
+#endif
+	{
+		float defaultvector[4];
+		defaultvector[0] = 0.0f;
+		defaultvector[1] = 0.0f;
+		defaultvector[2] = 0.0f;
+		defaultvector[3] = 1.0f;
+		float defaultvis = 1.0;
+		float* translation = &Translations[bone * NumFrames * 3];
+		int index = bone * NumFrames;
+
+		AnimChannel xchannel(bone, NumFrames, ANIM_CHANNEL_X, 1, defaultvector, translation);
+		AnimChannel ychannel(bone, NumFrames, ANIM_CHANNEL_Y, 1, defaultvector, translation + NumFrames);
+		AnimChannel zchannel(bone, NumFrames, ANIM_CHANNEL_Z, 1, defaultvector, translation + NumFrames * 2);
+		AnimChannel qchannel(bone, NumFrames, ANIM_CHANNEL_Q, 4, defaultvector, &Rotations[index * 4]);
+		BitChannel vchannel(bone, NumFrames, BIT_CHANNEL_VIS, true, &FrameFlags[index], FRAME_VISIBLE);
+		AnimChannel vfchannel(bone, NumFrames, ANIM_CHANNEL_VIS, 1, &defaultvis, &Visibility[index]);
+		BitChannel bmovechannel(bone, NumFrames, BIT_CHANNEL_VIS, false, &FrameFlags[index], FRAME_BINARY_MOVE);
+
+		if (!vchannel.HasNoData)
+		{
+			if (!xchannel.HasNoData)
+			{
+				xchannel.ApplyVisibility(vchannel);
+			}
+
+			if (!ychannel.HasNoData)
+			{
+				ychannel.ApplyVisibility(vchannel);
+			}
+
+			if (!zchannel.HasNoData)
+			{
+				zchannel.ApplyVisibility(vchannel);
+			}
+
+			if (!qchannel.HasNoData)
+			{
+				qchannel.ApplyVisibility(vchannel);
+			}
+
+			if (!vfchannel.HasNoData)
+			{
+				vfchannel.ApplyVisibility(vchannel);
+			}
+		}
+
+#ifndef W3X
+		if (Flavor < ANIM_FLAVOR_VALID)
+		{
+			AnimChannel* channels[] = { &xchannel, &ychannel, &zchannel, &qchannel, &vfchannel };
+			const wchar_t* names[] = { L"x", L"y", L"z", L"q", L"vf" };
+			float rotationerror = ExportStr->MaxRotationError;
+			float length = Hierarchy->GetBoneLength(bone);
+
+			// NOTE: The rotation budget is the angle that moves the tip of the bone by MaxTranslationError, MaxRotationError is the floor.
+			//       Bones without children have no tip and only use MaxRotationError.
+			if (length > 0.0f && ExportStr->MaxTranslationError / length * 57.29578f > rotationerror)
+			{
+				rotationerror = ExportStr->MaxTranslationError / length * 57.29578f;
+			}
+
+			float errors[] = { ExportStr->MaxTranslationError, ExportStr->MaxTranslationError, ExportStr->MaxTranslationError, rotationerror, ExportStr->MaxVisibilityError };
+
+			for (int j = 0; j < 5; j++)
+			{
+				if (!channels[j]->HasNoData)
+				{
+					stats.Log += names[j];
+					BitChannel* bmove = j < 4 ? &bmovechannel : nullptr;
+					int shape = channels[j]->Classify(bmove, errors[j]);
+					stats.Shapes[shape]++;
+
+					if (Flavor == ANIM_FLAVOR_TIMECODED)
+					{
+						int keys = 0;
+						channels[j]->WriteTimeCodedChannel(csave, bmove, errors[j], maxkeys, shape, ExportStr->ReduceKeyPrecision != FALSE, keys);
+						stats.Keys += keys;
+						stats.Frames += NumFrames;
+					}
+					else
+					{
+						bool withintolerance = true;
+						channels[j]->WriteAdaptiveDeltaChannel(csave, ExportStr->MaxAdaptiveDeltaError, withintolerance);
+
+						if (!withintolerance)
+						{
+							stats.WithinTolerance = false;
+							stats.MissedChannels++;
+						}
+					}
+				}
+			}
+
+			if (!vchannel.HasNoData)
+			{
+				stats.Log += L"v";
+				vchannel.WriteTimeCodedChannel(csave);
+			}
+
+			return;
+		}
+#endif
+
+		if (!xchannel.HasNoData)
+		{
+			stats.Log += L"x";
+			xchannel.WriteChannel(csave, &bmovechannel);
+		}
+
+		if (!ychannel.HasNoData)
+		{
+			stats.Log += L"y";
+			ychannel.WriteChannel(csave, &bmovechannel);
+		}
+
+		if (!zchannel.HasNoData)
+		{
+			stats.Log += L"z";
+			zchannel.WriteChannel(csave, &bmovechannel);
+		}
+
+		if (!qchannel.HasNoData)
+		{
+			stats.Log += L"q";
+			qchannel.WriteChannel(csave, &bmovechannel);
+		}
+
+#ifndef W3X
+		if (!vchannel.HasNoData)
+		{
+			stats.Log += L"v";
+			vchannel.WriteChannel(csave);
 		}
+#endif
 
-		return csave.WriteClosingTag();
+		if (!vfchannel.HasNoData)
+		{
+			stats.Log += L"vf";
+			vfchannel.WriteChannel(csave, nullptr);
+		}
 	}
-#endif
 
 #ifndef W3X
 	bool AnimationSave::WriteAnimationChannels(ChunkSaveClass& csave)
@@ -10124,137 +12069,78 @@ namespace W3D::MaxTools
 		}
 #endif
 
-		float data[4];
-		data[0] = 0.0f;
-
-		for (int i = 0; i < BoneCount; i++)
+		int maxkeys = NumFrames;
+#ifndef W3X
+		if (Flavor == ANIM_FLAVOR_TIMECODED && ExportStr->ForceKeyReduction)
 		{
-			LogDataDialogClass::WriteLogWindow(L"\nnode: %d ", i);
+			maxkeys = NumFrames - NumFrames * ExportStr->KeyReduction / 100;
 
-			if (HasData[i])
+			if (maxkeys < 2)
 			{
-				float defaultvector[4];
-				defaultvector[0] = 0.0f;
-				defaultvector[1] = 0.0f;
-				defaultvector[2] = 0.0f;
-				defaultvector[3] = 1.0f;
-				float defaultvis = 1.0;
-
-				AnimChannel xchannel(i, NumFrames, ANIM_CHANNEL_X, 1, defaultvector);
-				AnimChannel ychannel(i, NumFrames, ANIM_CHANNEL_Y, 1, defaultvector);
-				AnimChannel zchannel(i, NumFrames, ANIM_CHANNEL_Z, 1, defaultvector);
-				AnimChannel xrchannel(i, NumFrames, ANIM_CHANNEL_XR, 1, defaultvector);
-				AnimChannel yrchannel(i, NumFrames, ANIM_CHANNEL_YR, 1, defaultvector);
-				AnimChannel zrchannel(i, NumFrames, ANIM_CHANNEL_ZR, 1, defaultvector);
-				AnimChannel qchannel(i, NumFrames, ANIM_CHANNEL_Q, 4, defaultvector);
-				BitChannel vchannel(i, NumFrames, BIT_CHANNEL_VIS, true);
-				vchannel.Init(BitChannels[i]);
-				AnimChannel vfchannel(i, NumFrames, ANIM_CHANNEL_VIS, 1, &defaultvis);
-				BitChannel bmovechannel(i, NumFrames, BIT_CHANNEL_VIS, false);
-				bmovechannel.Init(BinaryMove[i]);
-
-				for (int j = 0; j < NumFrames; j++)
-				{
-					Matrix3 tm = GetTransform(i, j);
-					Point3 angles = Angles[i][j];
-					Quat q;
-					Point3 p;
-					Point3 s;
-					DecomposeMatrix(tm, p, q, s);
-					q.x = -q.x;
-					q.y = -q.y;
-					q.z = -q.z;
-
-					data[0] = p.x;
-					xchannel.SetData(j, data);
-					data[0] = p.y;
-					ychannel.SetData(j, data);
-					data[0] = p.z;
-					zchannel.SetData(j, data);
-					data[0] = angles.x;
-					xrchannel.SetData(j, data);
-					data[0] = angles.y;
-					yrchannel.SetData(j, data);
-					data[0] = angles.z;
-					zrchannel.SetData(j, data);
-
-					data[0] = q.x;
-					data[1] = q.y;
-					data[2] = q.z;
-					data[3] = q.w;
-					qchannel.SetData(j, data);
-					vchannel.SetData(j, BitChannels[i][j]);
-					float vis = VisibilityChannels[i][j];
-					vfchannel.SetData(j, &vis);
-					bmovechannel.SetData(j, BinaryMove[i][j]);
-				}
+				maxkeys = 2;
+			}
+		}
+#endif
 
-				if (!vchannel.HasNoData)
+		std::vector<BoneChannelStats> stats(BoneCount);
+#ifndef W3X
+		// NOTE: Every bone is encoded into its own buffer on a worker thread and the buffers are appended in bone order afterwards,
+		//       so the file is the same no matter how the bones were scheduled.
+		std::vector<std::vector<unsigned char>> buffers(BoneCount);
+		ParallelFor(BoneCount, [&](int i)
+		{
+			if (HasData[i])
+			{
+				SaveToBuffer(buffers[i], [&](ChunkSaveClass& bonesave)
 				{
-					if (!xchannel.HasNoData)
-					{
-						xchannel.ApplyVisibility(vchannel);
-					}
-
-					if (!ychannel.HasNoData)
-					{
-						ychannel.ApplyVisibility(vchannel);
-					}
-
-					if (!zchannel.HasNoData)
-					{
-						zchannel.ApplyVisibility(vchannel);
-					}
-
-					if (!qchannel.HasNoData)
-					{
-						qchannel.ApplyVisibility(vchannel);
-					}
+					WriteBoneChannels(bonesave, i, maxkeys, stats[i]);
+					return true;
+				});
+			}
+		});
 
-					if (!vfchannel.HasNoData)
-					{
-						vfchannel.ApplyVisibility(vchannel);
-					}
-				}
+		int totalkeys = 0;
+		int totalframes = 0;
+		int missedchannels = 0;
+		int shapes[3] = {};
 
-				if (!xchannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"x");
-					xchannel.WriteChannel(csave, &bmovechannel);
-				}
+		// NOTE: The channels are appended without going through Begin_Chunk, so the parent chunk has to be flagged here.
+		if (csave.Cur_Chunk_Depth())
+		{
+			csave.Set_Contains_Chunks();
+		}
+#endif
 
-				if (!ychannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"y");
-					ychannel.WriteChannel(csave, &bmovechannel);
-				}
+		for (int i = 0; i < BoneCount; i++)
+		{
+#ifdef W3X
+			if (HasData[i])
+			{
+				WriteBoneChannels(csave, i, maxkeys, stats[i]);
+			}
+#endif
 
-				if (!zchannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"z");
-					zchannel.WriteChannel(csave, &bmovechannel);
-				}
+			LogDataDialogClass::WriteLogWindow(L"\nnode: %d %s", i, stats[i].Log.Peek_Buffer());
+#ifndef W3X
+			if (!buffers[i].empty() && csave.Write(buffers[i].data(), (unsigned long)buffers[i].size()) != buffers[i].size())
+			{
+				return false;
+			}
 
-				if (!qchannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"q");
-					qchannel.WriteChannel(csave, &bmovechannel);
-				}
+			totalkeys += stats[i].Keys;
+			totalframes += stats[i].Frames;
+			missedchannels += stats[i].MissedChannels;
 
-#ifndef W3X
-				if (!vchannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"v");
-					vchannel.WriteChannel(csave);
-				}
-#endif
+			for (int j = 0; j < 3; j++)
+			{
+				shapes[j] += stats[i].Shapes[j];
+			}
 
-				if (!vfchannel.HasNoData)
-				{
-					LogDataDialogClass::WriteLogWindow(L"vf");
-					vfchannel.WriteChannel(csave, nullptr);
-				}
+			if (!stats[i].WithinTolerance)
+			{
+				WithinTolerance = false;
 			}
+#endif
 		}
 
 #ifdef W3X
@@ -10264,63 +12150,95 @@ namespace W3D::MaxTools
 		}
 #endif
 
+#ifndef W3X
+		if (Flavor == ANIM_FLAVOR_TIMECODED)
+		{
+			LogDataDialogClass::WriteLogWindow(L"\n\nTime-coded keys: %d of %d frames", totalkeys, totalframes);
+		}
+		else if (Flavor == ANIM_FLAVOR_ADAPTIVE_DELTA)
+		{
+			LogDataDialogClass::WriteLogWindow(L"\n\nAdaptive delta channels out of tolerance: %d", missedchannels);
+		}
+
+		if (Flavor < ANIM_FLAVOR_VALID)
+		{
+			LogDataDialogClass::WriteLogWindow(L"\nChannels: %d constant, %d linear, %d piecewise linear", shapes[AnimChannel::CHANNEL_CONSTANT], shapes[AnimChannel::CHANNEL_LINEAR], shapes[AnimChannel::CHANNEL_PIECEWISE_LINEAR]);
+		}
+#endif
+
 		LogDataDialogClass::WriteLogWindow(L"\n\nSave Channel Data Complete.\n");
 		return true;
 	}
 
 	AnimationSave::~AnimationSave()
 	{
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
+		LogDataDialogClass::WriteLogWindow(L"Destroy Log..%d,%d,%d,%d, %S..\n", 1, 2, 3, 4, "go");
+	}
+
+#ifndef W3X
+	bool AnimationSave::WriteAnimation(ChunkSaveClass& csave)
+	{
+		LogDataDialogClass::WriteLogWindow(L"\nBegin Save Motion Data\n");
+
+		if (!(ExportStr->CompressionTypes & 3))
 		{
-			if (Transforms[i])
+			Flavor = ANIM_FLAVOR_VALID;
+
+			if (csave.Begin_Chunk(W3DChunkType::ANIMATION) && AnimationSave::WriteAnimationHeader(csave) && AnimationSave::WriteAnimationChannels(csave))
 			{
-				delete[] Transforms[i];
+				return csave.End_Chunk();
 			}
-		}
 
-		if (Transforms)
-		{
-			delete[] Transforms;
+			return false;
 		}
 
-		for (int i = 0; i < Hierarchy->GetBoneCount(); i++)
+		// NOTE: Every allowed flavor is encoded up front so the header can name the smallest one that stays within tolerance.
+		//       Time-coded always meets its tolerances, so it is the fallback when adaptive delta can not.
+		std::vector<unsigned char> channels[ANIM_FLAVOR_VALID];
+		bool valid[ANIM_FLAVOR_VALID] = {};
+		int best = ANIM_FLAVOR_VALID;
+
+		for (int i = 0; i < ANIM_FLAVOR_VALID; i++)
 		{
-			if (Angles[i])
+			if (!(ExportStr->CompressionTypes & (1 << i)))
 			{
-				delete[] Angles[i];
+				continue;
 			}
-		}
 
-		if (Angles)
-		{
-			delete[] Angles;
-		}
+			Flavor = i;
+			WithinTolerance = true;
+			valid[i] = SaveToBuffer(channels[i], [this](ChunkSaveClass& save) { return WriteAnimationChannels(save); }) && WithinTolerance;
+			LogDataDialogClass::WriteLogWindow(L"\n%s channel data: %d bytes%s\n", i == ANIM_FLAVOR_TIMECODED ? L"Time-coded" : L"Adaptive delta", (int)channels[i].size(), valid[i] ? L"" : L" (exceeds the error budget)");
 
-		if (BitChannels)
-		{
-			delete[] BitChannels;
+			if (valid[i] && (best == ANIM_FLAVOR_VALID || channels[i].size() < channels[best].size()))
+			{
+				best = i;
+			}
 		}
 
-		if (VisibilityChannels)
+		if (best == ANIM_FLAVOR_VALID)
 		{
-			delete[] VisibilityChannels;
-		}
+			LogDataDialogClass::WriteLogWindow(L"Adaptive delta can not meet the error budget, falling back to time-coded.\n");
+			Flavor = ANIM_FLAVOR_TIMECODED;
+			WithinTolerance = true;
 
-		if (BinaryMove)
-		{
-			delete[] BinaryMove;
-		}
+			if (!SaveToBuffer(channels[ANIM_FLAVOR_TIMECODED], [this](ChunkSaveClass& save) { return WriteAnimationChannels(save); }))
+			{
+				return false;
+			}
 
-		LogDataDialogClass::WriteLogWindow(L"Destroy Log..%d,%d,%d,%d, %S..\n", 1, 2, 3, 4, "go");
-	}
+			best = ANIM_FLAVOR_TIMECODED;
+		}
 
-#ifndef W3X
-	bool AnimationSave::WriteAnimation(ChunkSaveClass& csave)
-	{
-		LogDataDialogClass::WriteLogWindow(L"\nBegin Save Motion Data\n");
+		Flavor = best;
 
-		if (csave.Begin_Chunk(W3DChunkType::ANIMATION) && AnimationSave::WriteAnimationHeader(csave) && AnimationSave::WriteAnimationChannels(csave))
+		if (csave.Begin_Chunk(W3DChunkType::COMPRESSED_ANIMATION) && AnimationSave::WriteAnimationHeader(csave))
 		{
+			if (csave.Write(channels[best].data(), (unsigned long)channels[best].size()) != channels[best].size())
+			{
+				return false;
+			}
+
 			return csave.End_Chunk();
 		}
 
@@ -10431,6 +12349,182 @@ namespace W3D::MaxTools
 		return false;
 	}
 
+#ifndef W3X
+	struct AnimationTakeStruct
+	{
+		StringClass Name;
+		int Start;
+		int End;
+	};
+
+	// Reads one "name start end" take per line, empty lines and lines starting with ; or # are skipped
+	void LoadTakeList(const wchar_t* filename, Interval range, std::vector<AnimationTakeStruct>& takes)
+	{
+		FILE* file = _wfopen(filename, L"rt");
+
+		if (!file)
+		{
+			throw ErrorClass(L"Unable to open take list: %s", filename);
+		}
+
+		char line[512];
+		int linenumber = 0;
+
+		while (fgets(line, sizeof(line), file))
+		{
+			linenumber++;
+			char name[256];
+			AnimationTakeStruct take;
+			int fields = sscanf(line, "%255s %d %d", name, &take.Start, &take.End);
+
+			if (fields <= 0 || name[0] == ';' || name[0] == '#')
+			{
+				continue;
+			}
+
+			if (fields != 3 || take.Start > take.End || take.Start < range.Start() / GetTicksPerFrame() || take.End > range.End() / GetTicksPerFrame())
+			{
+				fclose(file);
+				throw ErrorClass(L"Take list line %d needs a name and a frame range inside the animation range:\n%S", linenumber, line);
+			}
+
+			take.Name = name;
+			takes.push_back(take);
+		}
+
+		fclose(file);
+	}
+
+	bool W3DExport::ExportTakes(INode* node)
+	{
+		TT_PROFILER_SCOPE("W3DExport::ExportTakes");
+		HierarchySave* pose = GetHierarchy();
+
+		if (!node || !pose)
+		{
+			return false;
+		}
+
+		std::vector<AnimationTakeStruct> takes;
+
+		try
+		{
+			LoadTakeList(m_Settings.TakeListFileName, Int->GetAnimRange(), takes);
+		}
+		catch (ErrorClass& e)
+		{
+			MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
+			return false;
+		}
+
+		LogDataDialogClass::WriteLogWindow(L"\nExporting %d takes with hierarchy %S\n", (int)takes.size(), pose->GetHierarchyName());
+
+		// NOTE: Capturing evaluates the scene, which only works on the main thread.
+		//       Every take is captured while the previous one is encoded and saved on a worker thread.
+		std::vector<W3DExportSettings> settings(takes.size(), m_Settings);
+		std::vector<StringClass> failed;
+		std::vector<StringClass> skipped;
+		std::thread writer;
+		auto save = [&failed](AnimationSave* anim, StringClass filename)
+		{
+			bool result = false;
+
+			// NOTE: This runs on its own thread, an exception escaping it would take Max down.
+			try
+			{
+				AsyncWriteFileClass file(filename);
+
+				if (file.Open(2))
+				{
+					ChunkSaveClass csave(&file);
+					result = anim->WriteAnimation(csave) && file.Flush();
+					file.Close();
+					result = result && !file.Has_Failed();
+				}
+			}
+			catch (ErrorClass& e)
+			{
+				LogDataDialogClass::WriteLogWindow(L"\nError saving %S: %s\n", filename.Peek_Buffer(), e.GetError());
+			}
+
+			if (!result)
+			{
+				failed.push_back(filename);
+			}
+
+			delete anim;
+		};
+
+		for (size_t i = 0; i < takes.size(); i++)
+		{
+			settings[i].AnimFramesStart = takes[i].Start;
+			settings[i].AnimFramesEnd = takes[i].End;
+			LogDataDialogClass::WriteLogWindow(L"\nTake %S: frames %d to %d\n", takes[i].Name.Peek_Buffer(), takes[i].Start, takes[i].End);
+
+			if (takes[i].Name.Get_Length() >= W3D_NAME_LEN)
+			{
+				LogDataDialogClass::WriteLogWindow(L"Warning: W3D filenames should be %d characters or less!\n", W3D_NAME_LEN);
+			}
+
+			StringClass filename;
+			filename.Format("%s%s.w3d", ExportPath, takes[i].Name.Peek_Buffer());
+
+			if (!_stricmp(filename, ExportFileName))
+			{
+				LogDataDialogClass::WriteLogWindow(L"Warning: skipping take %S, its file is the one the hierarchy is being saved to\n", takes[i].Name.Peek_Buffer());
+				skipped.push_back(takes[i].Name);
+				continue;
+			}
+
+			Matrix3 mat;
+			AnimationSave* anim;
+
+			try
+			{
+				anim = new AnimationSave(ExpInt->theScene, node, pose, &settings[i], FrameRate, takes[i].Name, mat);
+			}
+			catch (ErrorClass& e)
+			{
+				if (writer.joinable())
+				{
+					writer.join();
+				}
+
+				MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
+				return false;
+			}
+
+			if (writer.joinable())
+			{
+				writer.join();
+			}
+
+			writer = std::thread(save, anim, filename);
+		}
+
+		if (writer.joinable())
+		{
+			writer.join();
+		}
+
+		for (size_t i = 0; i < failed.size(); i++)
+		{
+			WideStringClass str;
+			str.Format(L"Unable to save take: %S", failed[i].Peek_Buffer());
+			MessageBox(nullptr, str.Peek_Buffer(), L"Error", MB_SETFOREGROUND);
+		}
+
+		for (size_t i = 0; i < skipped.size(); i++)
+		{
+			WideStringClass str;
+			str.Format(L"Take %S was not saved, its file is the one the hierarchy is being saved to.", skipped[i].Peek_Buffer());
+			MessageBox(nullptr, str.Peek_Buffer(), L"Warning", MB_SETFOREGROUND);
+		}
+
+		return failed.empty();
+	}
+#endif
+
 	bool FindDuplicateNodes(INodeListClass* list)
 	{
 		TT_PROFILER_SCOPE("W3DExport::FindDuplicateNodes");
@@ -10518,59 +12612,76 @@ namespace W3D::MaxTools
 				}
 			}
 
-			if (v.Count() == 1)
+			if (v.Count() == 1 && !hierarchy)
 			{
-				if (!hierarchy)
-				{
-					strncpy((v[0])->Name, name, W3D_NAME_LEN);
-					strncpy((v[0])->ContainerName, "", W3D_NAME_LEN);
-					goto l1;
-				}
+				strncpy((v[0])->Name, name, W3D_NAME_LEN);
+				strncpy((v[0])->ContainerName, "", W3D_NAME_LEN);
 			}
-			else if (!hierarchy)
+
 			{
-			l1:
+				TT_PROFILER_SCOPE("Prepare Geo Export Tasks");
 				for (int i = 0; i < v.Count(); i++)
 				{
 					try
 					{
-						v[i]->Save(lod);
+						v[i]->Prepare(lod);
 					}
 					catch (ErrorClass& e)
 					{
 						MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
 					}
 				}
+			}
 
-				for (int i = 0; i < v.Count(); i++)
+			{
+				TT_PROFILER_SCOPE("Build Geo Export Tasks");
+				ParallelFor(v.Count(), [&v, &lod](int i) { v[i]->Build(lod); });
+			}
+
+			for (int i = 0; i < v.Count(); i++)
+			{
+				try
 				{
-					if (v[i])
-					{
-						delete v[i];
-					}
+					v[i]->Save(lod);
+				}
+				catch (ErrorClass& e)
+				{
+					MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
 				}
+			}
 
-				v.Delete_All();
+			bool result = true;
 
-				if (list)
+			// NOTE: The connection has to be built after saving since mesh deduplication can rename tasks.
+			if (hierarchy)
+			{
+				try
 				{
-					delete list;
+					*connection = new MeshConnection(v, lod);
+				}
+				catch (ErrorClass& e)
+				{
+					MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
+					result = false;
 				}
-
-				return true;
 			}
 
-			try
+			for (int i = 0; i < v.Count(); i++)
 			{
-				*connection = new MeshConnection(v, lod);
+				if (v[i])
+				{
+					delete v[i];
+				}
 			}
-			catch (ErrorClass& e)
+
+			v.Delete_All();
+
+			if (list)
 			{
-				MessageBox(nullptr, e.GetError(), L"Error", MB_SETFOREGROUND);
-				return false;
+				delete list;
 			}
 
-			goto l1;
+			return result;
 		}
 
 		return false;
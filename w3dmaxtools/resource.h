@@ -91,6 +91,7 @@
 #define IDS_SECONDARY_GRADIENT          168
 #define IDS_DEPTH_COMPARISON            169
 #define IDS_DETAIL_COLOUR               170
+#define IDD_W3D_COMPRESSION             170
 #define IDS_DETAIL_ALPHA                171
 #define IDS_PUBLISH                     172
 #define IDS_DISPLAY                     173
@@ -260,15 +261,37 @@
 #define IDC_SCREEN_EDIT                 1148
 #define IDC_SCREEN_SPIN                 1149
 #define IDC_SCREEN_LABEL                1150
+#define IDC_EXPORT_CACHE                1151
+#define IDC_BONE_PALETTE_EDIT           1152
+#define IDC_BONE_PALETTE_SPIN           1153
+#define IDC_QUANTIZE_VERTICES           1154
+#define IDC_COMPRESSIONSETTINGS         1155
+#define IDC_TIMECODED                   1156
+#define IDC_MAXTRANSLATION              1157
+#define IDC_MAXROTATION                 1158
+#define IDC_MAXVISIBILITY               1159
+#define IDC_KEYREDUCTION                1160
+#define IDC_FORCEKEYREDUCTION           1161
+#define IDC_DEFAULTSETTINGS             1162
+#define IDC_ADAPTIVEDELTA               1163
+#define IDC_MAXERROR                    1164
+#define IDC_REDUCEPRECISION             1165
+#define IDC_BATCH_TAKES                 1166
+#define IDC_TAKES_BROWSE                1167
+#define IDC_TARGETFRAMERATE             1168
+#define IDC_POSITION_ERROR_EDIT         1169
+#define IDC_POSITION_ERROR_SPIN         1170
+#define IDC_UNIT_ERROR_EDIT             1171
+#define IDC_UNIT_ERROR_SPIN             1172
 #define IDC_LOG                         1198
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        170
+#define _APS_NEXT_RESOURCE_VALUE        171
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1151
+#define _APS_NEXT_CONTROL_VALUE         1173
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,644 @@
+#include "General.h"
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include "MappedFileClass.h"
+#include "chunkclass.h"
+#include "ChunkIndexClass.h"
+#include "ParallelFor.h"
+#include "FindFiles.h"
+#include "w3d.h"
+#include "w3dobsolete.h"
+
+// Adds up where the bytes go in a set of W3D files, one file per thread. Directories are searched for *.w3d files
+// including all their subdirectories. Three tables come out, each sorted biggest first:
+//
+// chunks: count and bytes per chunk id. Bytes include the header and everything inside the chunk, own bytes leave out
+// the chunks inside it so they add up to the size of the files (with compressed chunks counted decompressed).
+// mesh channels: bytes per vertex attribute (and triangles, AABTrees etc.) over all meshes, with how many vertices or
+// triangles they cover. Anything in a mesh that isn't one of the channels is "other".
+// animation channels: bytes per channel encoding and type over all animations, with how many frames they cover.
+//
+// usage: w3dstats [-j stats.json] path...
+//
+// -j also writes the tables as JSON. The exit code is 0, or 2 when a file can't be read.
+
+struct ChunkStats
+{
+	uint64 Count = 0;
+	uint64 Bytes = 0;
+	uint64 Own = 0;
+};
+
+struct ChannelStats
+{
+	uint64 Count = 0;
+	uint64 Bytes = 0;
+	uint64 Elements = 0; // vertices or triangles for mesh channels, frames for animation channels
+};
+
+struct MeshChannel
+{
+	uint32 ID;
+	const char *Name;
+	bool PerTriangle;
+};
+
+const MeshChannel MeshChannels[] =
+{
+	{ W3D_CHUNK_VERTICES, "positions", false },
+	{ W3D_CHUNK_QUANTIZED_VERTICES, "quantized positions", false },
+	{ W3D_CHUNK_VERTEX_NORMALS, "normals", false },
+	{ W3D_CHUNK_QUANTIZED_VERTEX_NORMALS, "quantized normals", false },
+	{ W3D_CHUNK_TANGENTS, "tangents", false },
+	{ W3D_CHUNK_QUANTIZED_TANGENTS, "quantized tangents", false },
+	{ W3D_CHUNK_BINORMALS, "binormals", false },
+	{ W3D_CHUNK_QUANTIZED_BINORMALS, "quantized binormals", false },
+	{ W3D_CHUNK_STAGE_TEXCOORDS, "texcoords", false },
+	{ W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS, "quantized texcoords", false },
+	{ W3D_CHUNK_DCG, "diffuse colors", false },
+	{ W3D_CHUNK_DIG, "diffuse illumination", false },
+	{ W3D_CHUNK_SCG, "specular colors", false },
+	{ W3D_CHUNK_VERTEX_INFLUENCES, "influences", false },
+	{ W3D_CHUNK_VERTEX_SHADE_INDICES, "shade indices", false },
+	{ W3D_CHUNK_VERTEX_MATERIAL_IDS, "vertex material ids", false },
+	{ W3D_CHUNK_TRIANGLES, "triangles", true },
+	{ W3D_CHUNK_SHADER_IDS, "shader ids", true },
+	{ W3D_CHUNK_TEXTURE_IDS, "texture ids", true },
+	{ W3D_CHUNK_AABTREE, "aabtree", true },
+	{ W3D_CHUNK_BONE_PALETTES, "bone palettes", true },
+};
+
+const int MeshChannelCount = sizeof(MeshChannels) / sizeof(MeshChannels[0]);
+
+const char *ChannelTypes[] = { "x translation", "y translation", "z translation", "x rotation", "y rotation", "z rotation", "quaternion", "timecoded x translation", "timecoded y translation", "timecoded z translation", "timecoded quaternion", "adaptive delta x translation", "adaptive delta y translation", "adaptive delta z translation", "adaptive delta quaternion", "visibility" };
+const char *BitChannelTypes[] = { "visibility", "timecoded visibility" };
+
+struct FileStats
+{
+	bool Opened = false;
+	uint64 FileBytes = 0;
+	uint64 StoredBytes = 0; // of the top level chunks, less than FileBytes if the file is truncated or corrupt
+	uint64 ChunkBytes = 0;
+	uint64 CompressedChunks = 0;
+	std::unordered_map<uint32, ChunkStats> Chunks;
+	ChannelStats Mesh[MeshChannelCount + 1]; // the last one is everything else in the mesh
+	std::unordered_map<StringClass, ChannelStats, hash_istring, equals_istring> Anim;
+	// NOTE: the mesh and animation being walked, they are always top level chunks so there is only ever one of each
+	uint32 Vertices = 0;
+	uint32 Tris = 0;
+	uint64 MeshCount[MeshChannelCount] = {};
+	uint64 MeshBytes[MeshChannelCount] = {};
+	uint32 Frames = 0;
+	int Flavor = -1;
+};
+
+std::unordered_map<uint32, const char *> ChunkNames;
+
+#define CHUNK(id) ChunkNames.insert({ id, #id })
+
+void initnames()
+{
+	CHUNK(OBSOLETE_W3D_CHUNK_EMITTER_COLOR_KEYFRAME);
+	CHUNK(OBSOLETE_W3D_CHUNK_EMITTER_OPACITY_KEYFRAME);
+	CHUNK(OBSOLETE_W3D_CHUNK_EMITTER_SIZE_KEYFRAME);
+	CHUNK(OBSOLETE_W3D_CHUNK_HMODEL_AUX_DATA);
+	CHUNK(OBSOLETE_W3D_CHUNK_SHADOW_NODE);
+	CHUNK(O_W3D_CHUNK_MATERIALS);
+	CHUNK(O_W3D_CHUNK_MATERIALS2);
+	CHUNK(O_W3D_CHUNK_POV_QUADRANGLES);
+	CHUNK(O_W3D_CHUNK_POV_TRIANGLES);
+	CHUNK(O_W3D_CHUNK_QUADRANGLES);
+	CHUNK(O_W3D_CHUNK_SURRENDER_TRIANGLES);
+	CHUNK(O_W3D_CHUNK_TRIANGLES);
+	CHUNK(W3D_CHUNK_AABTREE);
+	CHUNK(W3D_CHUNK_AABTREE_HEADER);
+	CHUNK(W3D_CHUNK_AABTREE_NODES);
+	CHUNK(W3D_CHUNK_AABTREE_POLYINDICES);
+	CHUNK(W3D_CHUNK_AGGREGATE);
+	CHUNK(W3D_CHUNK_AGGREGATE_CLASS_INFO);
+	CHUNK(W3D_CHUNK_AGGREGATE_HEADER);
+	CHUNK(W3D_CHUNK_AGGREGATE_INFO);
+	CHUNK(W3D_CHUNK_ANIMATION);
+	CHUNK(W3D_CHUNK_ANIMATION_CHANNEL);
+	CHUNK(W3D_CHUNK_ANIMATION_HEADER);
+	CHUNK(W3D_CHUNK_BINORMALS);
+	CHUNK(W3D_CHUNK_BIT_CHANNEL);
+	CHUNK(W3D_CHUNK_BONE_PALETTE);
+	CHUNK(W3D_CHUNK_BONE_PALETTES);
+	CHUNK(W3D_CHUNK_BONE_PALETTE_HEADER);
+	CHUNK(W3D_CHUNK_BONE_PALETTE_IDS);
+	CHUNK(W3D_CHUNK_BOX);
+	CHUNK(W3D_CHUNK_COLLECTION);
+	CHUNK(W3D_CHUNK_COLLECTION_HEADER);
+	CHUNK(W3D_CHUNK_COLLECTION_OBJ_NAME);
+	CHUNK(W3D_CHUNK_COLLISION_NODE);
+	CHUNK(W3D_CHUNK_COMPRESSED_ANIMATION);
+	CHUNK(W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL);
+	CHUNK(W3D_CHUNK_COMPRESSED_ANIMATION_HEADER);
+	CHUNK(W3D_CHUNK_COMPRESSED_ANIMATION_MOTION_CHANNEL);
+	CHUNK(W3D_CHUNK_COMPRESSED_BIT_CHANNEL);
+	CHUNK(W3D_CHUNK_DAMAGE);
+	CHUNK(W3D_CHUNK_DAMAGE_COLORS);
+	CHUNK(W3D_CHUNK_DAMAGE_HEADER);
+	CHUNK(W3D_CHUNK_DAMAGE_MATERIALS);
+	CHUNK(W3D_CHUNK_DAMAGE_VERTICES);
+	CHUNK(W3D_CHUNK_DAZZLE);
+	CHUNK(W3D_CHUNK_DAZZLE_NAME);
+	CHUNK(W3D_CHUNK_DAZZLE_TYPENAME);
+	CHUNK(W3D_CHUNK_DCG);
+	CHUNK(W3D_CHUNK_DEFORM);
+	CHUNK(W3D_CHUNK_DEFORM_DATA);
+	CHUNK(W3D_CHUNK_DEFORM_KEYFRAME);
+	CHUNK(W3D_CHUNK_DEFORM_SET);
+	CHUNK(W3D_CHUNK_DIG);
+	CHUNK(W3D_CHUNK_EMITTER);
+	CHUNK(W3D_CHUNK_EMITTER_BLUR_TIME_KEYFRAMES);
+	CHUNK(W3D_CHUNK_EMITTER_EXTRA_INFO);
+	CHUNK(W3D_CHUNK_EMITTER_FRAME_KEYFRAMES);
+	CHUNK(W3D_CHUNK_EMITTER_HEADER);
+	CHUNK(W3D_CHUNK_EMITTER_INFO);
+	CHUNK(W3D_CHUNK_EMITTER_INFOV2);
+	CHUNK(W3D_CHUNK_EMITTER_LINE_PROPERTIES);
+	CHUNK(W3D_CHUNK_EMITTER_PROPS);
+	CHUNK(W3D_CHUNK_EMITTER_ROTATION_KEYFRAMES);
+	CHUNK(W3D_CHUNK_EMITTER_USER_DATA);
+	CHUNK(W3D_CHUNK_FAR_ATTENUATION);
+	CHUNK(W3D_CHUNK_FXSHADER_IDS);
+	CHUNK(W3D_CHUNK_FX_SHADER);
+	CHUNK(W3D_CHUNK_FX_SHADERS);
+	CHUNK(W3D_CHUNK_FX_SHADER_CONSTANT);
+	CHUNK(W3D_CHUNK_FX_SHADER_INFO);
+	CHUNK(W3D_CHUNK_HIERARCHY);
+	CHUNK(W3D_CHUNK_HIERARCHY_HEADER);
+	CHUNK(W3D_CHUNK_HLOD);
+	CHUNK(W3D_CHUNK_HLOD_AGGREGATE_ARRAY);
+	CHUNK(W3D_CHUNK_HLOD_HEADER);
+	CHUNK(W3D_CHUNK_HLOD_LOD_ARRAY);
+	CHUNK(W3D_CHUNK_HLOD_PROXY_ARRAY);
+	CHUNK(W3D_CHUNK_HLOD_SUB_OBJECT);
+	CHUNK(W3D_CHUNK_HLOD_SUB_OBJECT_ARRAY_HEADER);
+	CHUNK(W3D_CHUNK_HMODEL);
+	CHUNK(W3D_CHUNK_HMODEL_HEADER);
+	CHUNK(W3D_CHUNK_LIGHT);
+	CHUNK(W3D_CHUNK_LIGHTMAP_UV);
+	CHUNK(W3D_CHUNK_LIGHTSCAPE);
+	CHUNK(W3D_CHUNK_LIGHTSCAPE_LIGHT);
+	CHUNK(W3D_CHUNK_LIGHT_INFO);
+	CHUNK(W3D_CHUNK_LIGHT_TRANSFORM);
+	CHUNK(W3D_CHUNK_LOD);
+	CHUNK(W3D_CHUNK_LODMODEL);
+	CHUNK(W3D_CHUNK_LODMODEL_HEADER);
+	CHUNK(W3D_CHUNK_MAP3_FILENAME);
+	CHUNK(W3D_CHUNK_MAP3_INFO);
+	CHUNK(W3D_CHUNK_MATERIAL3);
+	CHUNK(W3D_CHUNK_MATERIAL3_DC_MAP);
+	CHUNK(W3D_CHUNK_MATERIAL3_DI_MAP);
+	CHUNK(W3D_CHUNK_MATERIAL3_INFO);
+	CHUNK(W3D_CHUNK_MATERIAL3_NAME);
+	CHUNK(W3D_CHUNK_MATERIAL3_SC_MAP);
+	CHUNK(W3D_CHUNK_MATERIAL3_SI_MAP);
+	CHUNK(W3D_CHUNK_MATERIALS3);
+	CHUNK(W3D_CHUNK_MATERIAL_INFO);
+	CHUNK(W3D_CHUNK_MATERIAL_PASS);
+	CHUNK(W3D_CHUNK_MESH);
+	CHUNK(W3D_CHUNK_MESH_HEADER);
+	CHUNK(W3D_CHUNK_MESH_HEADER3);
+	CHUNK(W3D_CHUNK_MESH_USER_TEXT);
+	CHUNK(W3D_CHUNK_MORPHANIM_CHANNEL);
+	CHUNK(W3D_CHUNK_MORPHANIM_HEADER);
+	CHUNK(W3D_CHUNK_MORPHANIM_KEYDATA);
+	CHUNK(W3D_CHUNK_MORPHANIM_PIVOTCHANNELDATA);
+	CHUNK(W3D_CHUNK_MORPHANIM_POSENAME);
+	CHUNK(W3D_CHUNK_MORPH_ANIMATION);
+	CHUNK(W3D_CHUNK_NEAR_ATTENUATION);
+	CHUNK(W3D_CHUNK_NODE);
+	CHUNK(W3D_CHUNK_NULL_OBJECT);
+	CHUNK(W3D_CHUNK_PER_FACE_TEXCOORD_IDS);
+	CHUNK(W3D_CHUNK_PER_TRI_MATERIALS);
+	CHUNK(W3D_CHUNK_PIVOTS);
+	CHUNK(W3D_CHUNK_PIVOT_FIXUPS);
+	CHUNK(W3D_CHUNK_PIVOT_UNKNOWN1);
+	CHUNK(W3D_CHUNK_PLACEHOLDER);
+	CHUNK(W3D_CHUNK_POINTS);
+	CHUNK(W3D_CHUNK_PRELIT_LIGHTMAP_MULTI_PASS);
+	CHUNK(W3D_CHUNK_PRELIT_LIGHTMAP_MULTI_TEXTURE);
+	CHUNK(W3D_CHUNK_PRELIT_UNLIT);
+	CHUNK(W3D_CHUNK_PRELIT_VERTEX);
+	CHUNK(W3D_CHUNK_PS2_SHADERS);
+	CHUNK(W3D_CHUNK_QUANTIZED_BINORMALS);
+	CHUNK(W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS);
+	CHUNK(W3D_CHUNK_QUANTIZED_TANGENTS);
+	CHUNK(W3D_CHUNK_QUANTIZED_VERTEX_NORMALS);
+	CHUNK(W3D_CHUNK_QUANTIZED_VERTICES);
+	CHUNK(W3D_CHUNK_RING);
+	CHUNK(W3D_CHUNK_SCG);
+	CHUNK(W3D_CHUNK_SECONDARY_VERTEX_NORMALS);
+	CHUNK(W3D_CHUNK_SECONDARY_VERTICES);
+	CHUNK(W3D_CHUNK_SHADERS);
+	CHUNK(W3D_CHUNK_SHADER_IDS);
+	CHUNK(W3D_CHUNK_SHDMESH);
+	CHUNK(W3D_CHUNK_SHDMESH_HEADER);
+	CHUNK(W3D_CHUNK_SHDMESH_NAME);
+	CHUNK(W3D_CHUNK_SHDMESH_USER_TEXT);
+	CHUNK(W3D_CHUNK_SHDSUBMESH);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_B4C);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_HEADER);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_SHADER);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_SHADER_DATA);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_SHADER_TYPE);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_S);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_SXT);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_T);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_TRIANGLES);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_UV0);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_UV1);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_VERTEX_INFLUENCES);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_VERTEX_NORMALS);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_VERTEX_SHADE_INDICES);
+	CHUNK(W3D_CHUNK_SHDSUBMESH_VERTICES);
+	CHUNK(W3D_CHUNK_SKIN_NODE);
+	CHUNK(W3D_CHUNK_SOUNDROBJ);
+	CHUNK(W3D_CHUNK_SOUNDROBJ_DEFINITION);
+	CHUNK(W3D_CHUNK_SOUNDROBJ_HEADER);
+	CHUNK(W3D_CHUNK_SPHERE);
+	CHUNK(W3D_CHUNK_SPOT_LIGHT_INFO);
+	CHUNK(W3D_CHUNK_SPOT_LIGHT_INFO_5_0);
+	CHUNK(W3D_CHUNK_STAGE_TEXCOORDS);
+	CHUNK(W3D_CHUNK_SURRENDER_NORMALS);
+	CHUNK(W3D_CHUNK_TANGENTS);
+	CHUNK(W3D_CHUNK_TEXCOORDS);
+	CHUNK(W3D_CHUNK_TEXTURE);
+	CHUNK(W3D_CHUNK_TEXTURES);
+	CHUNK(W3D_CHUNK_TEXTURE_IDS);
+	CHUNK(W3D_CHUNK_TEXTURE_INFO);
+	CHUNK(W3D_CHUNK_TEXTURE_NAME);
+	CHUNK(W3D_CHUNK_TEXTURE_REPLACER_INFO);
+	CHUNK(W3D_CHUNK_TEXTURE_STAGE);
+	CHUNK(W3D_CHUNK_TRANSFORM_NODE);
+	CHUNK(W3D_CHUNK_TRIANGLES);
+	CHUNK(W3D_CHUNK_VERTEX_COLORS);
+	CHUNK(W3D_CHUNK_VERTEX_INFLUENCES);
+	CHUNK(W3D_CHUNK_VERTEX_MAPPER_ARGS0);
+	CHUNK(W3D_CHUNK_VERTEX_MAPPER_ARGS1);
+	CHUNK(W3D_CHUNK_VERTEX_MATERIAL);
+	CHUNK(W3D_CHUNK_VERTEX_MATERIALS);
+	CHUNK(W3D_CHUNK_VERTEX_MATERIAL_IDS);
+	CHUNK(W3D_CHUNK_VERTEX_MATERIAL_INFO);
+	CHUNK(W3D_CHUNK_VERTEX_MATERIAL_NAME);
+	CHUNK(W3D_CHUNK_VERTEX_NORMALS);
+	CHUNK(W3D_CHUNK_VERTEX_SHADE_INDICES);
+	CHUNK(W3D_CHUNK_VERTICES);
+}
+
+void AddAnimChannel(FileStats &stats, const char *encoding, const char *const *types, int count, int type, uint64 bytes, uint64 frames)
+{
+	StringClass name;
+	if (type < count)
+	{
+		name.Format("%s %s", encoding, types[type]);
+	}
+	else
+	{
+		name.Format("%s type %d", encoding, type);
+	}
+	ChannelStats &channel = stats.Anim[name];
+	channel.Count++;
+	channel.Bytes += bytes;
+	channel.Elements += frames;
+}
+
+void AddAnimChunk(MappedChunkLoadClass &cload, FileStats &stats)
+{
+	const unsigned char *payload = (const unsigned char *)cload.Cur_Chunk_Data();
+	unsigned long length = cload.Cur_Chunk_Length();
+	uint64 bytes = length + 8;
+	switch (cload.Cur_Chunk_ID())
+	{
+	case W3D_CHUNK_ANIMATION_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dAnimHeaderStruct>(); header.Size())
+		{
+			stats.Frames = header[0].NumFrames;
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_ANIMATION_HEADER:
+		if (auto header = cload.Cur_Chunk_Span<W3dCompressedAnimHeaderStruct>(); header.Size())
+		{
+			stats.Frames = header[0].NumFrames;
+			stats.Flavor = header[0].Flavor;
+		}
+		break;
+	case W3D_CHUNK_ANIMATION_CHANNEL:
+		if (length >= offsetof(W3dAnimChannelStruct, Data))
+		{
+			auto channel = (const W3dAnimChannelStruct *)payload;
+			AddAnimChannel(stats, "uncompressed", ChannelTypes, _countof(ChannelTypes), channel->Flags, bytes, channel->LastFrame >= channel->FirstFrame ? channel->LastFrame - channel->FirstFrame + 1 : 0);
+		}
+		break;
+	case W3D_CHUNK_BIT_CHANNEL:
+		if (length >= offsetof(W3dBitChannelStruct, Data))
+		{
+			auto channel = (const W3dBitChannelStruct *)payload;
+			AddAnimChannel(stats, "bit", BitChannelTypes, _countof(BitChannelTypes), channel->Flags, bytes, channel->LastFrame >= channel->FirstFrame ? channel->LastFrame - channel->FirstFrame + 1 : 0);
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL:
+		if ((stats.Flavor == ANIM_FLAVOR_NEW_TIMECODED) && (length >= offsetof(W3dTimeCodedAnimChannelStruct, Data)))
+		{
+			AddAnimChannel(stats, "timecoded", ChannelTypes, _countof(ChannelTypes), ((const W3dTimeCodedAnimChannelStruct *)payload)->Flags, bytes, stats.Frames);
+		}
+		else if ((stats.Flavor > ANIM_FLAVOR_NEW_TIMECODED) && (length >= offsetof(W3dAdaptiveDeltaAnimChannelStruct, Data)))
+		{
+			AddAnimChannel(stats, "adaptive delta 4", ChannelTypes, _countof(ChannelTypes), ((const W3dAdaptiveDeltaAnimChannelStruct *)payload)->Flags, bytes, stats.Frames);
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_ANIMATION_MOTION_CHANNEL:
+		if (auto channel = cload.Cur_Chunk_Span<W3dCompressedMotionChannelStruct>(); channel.Size())
+		{
+			const char *encoding = channel[0].Flavor == ANIM_FLAVOR_NEW_TIMECODED ? "motion timecoded" : channel[0].Flavor == ANIM_FLAVOR_NEW_ADAPTIVE_DELTA_4 ? "motion adaptive delta 4" : channel[0].Flavor == ANIM_FLAVOR_NEW_ADAPTIVE_DELTA_8 ? "motion adaptive delta 8" : "motion unknown";
+			AddAnimChannel(stats, encoding, ChannelTypes, _countof(ChannelTypes), channel[0].Flags, bytes, stats.Frames);
+		}
+		break;
+	case W3D_CHUNK_COMPRESSED_BIT_CHANNEL:
+		if (length >= offsetof(W3dTimeCodedBitChannelStruct, Data))
+		{
+			AddAnimChannel(stats, "compressed bit", BitChannelTypes, _countof(BitChannelTypes), ((const W3dTimeCodedBitChannelStruct *)payload)->Flags, bytes, stats.Frames);
+		}
+		break;
+	}
+}
+
+void BeginMesh(FileStats &stats)
+{
+	stats.Vertices = 0;
+	stats.Tris = 0;
+	memset(stats.MeshCount, 0, sizeof(stats.MeshCount));
+	memset(stats.MeshBytes, 0, sizeof(stats.MeshBytes));
+}
+
+// NOTE: the header doesn't have to come first so nothing is added up until the whole mesh has been seen
+void EndMesh(FileStats &stats, uint64 bytes)
+{
+	uint64 other = bytes;
+	for (int i = 0; i < MeshChannelCount; i++)
+	{
+		ChannelStats &channel = stats.Mesh[i];
+		channel.Count += stats.MeshCount[i];
+		channel.Bytes += stats.MeshBytes[i];
+		channel.Elements += stats.MeshCount[i] * (MeshChannels[i].PerTriangle ? stats.Tris : stats.Vertices);
+		other -= stats.MeshBytes[i];
+	}
+	stats.Mesh[MeshChannelCount].Count++;
+	stats.Mesh[MeshChannelCount].Bytes += other;
+}
+
+void AddMeshChunk(MappedChunkLoadClass &cload, FileStats &stats, uint64 bytes)
+{
+	uint32 id = cload.Cur_Chunk_ID();
+	if (id == W3D_CHUNK_MESH_HEADER3)
+	{
+		if (auto header = cload.Cur_Chunk_Span<W3dMeshHeader3Struct>(); header.Size())
+		{
+			stats.Vertices = header[0].NumVertices;
+			stats.Tris = header[0].NumTris;
+		}
+		return;
+	}
+	for (int i = 0; i < MeshChannelCount; i++)
+	{
+		if (MeshChannels[i].ID == id)
+		{
+			stats.MeshCount[i]++;
+			stats.MeshBytes[i] += bytes;
+			return;
+		}
+	}
+}
+
+// Returns the bytes taken up by the chunks it went through
+uint64 AddChunks(MappedChunkLoadClass &cload, FileStats &stats, uint32 object)
+{
+	uint64 total = 0;
+	while (cload.Open_Chunk())
+	{
+		uint32 id = cload.Cur_Chunk_ID();
+		uint64 bytes = cload.Cur_Chunk_Length() + 8;
+		if (cload.Cur_Chunk_Depth() == 1)
+		{
+			stats.StoredBytes += cload.Cur_Chunk_Stored_Size();
+			stats.CompressedChunks += cload.Is_Compressed();
+			object = id;
+			if (id == W3D_CHUNK_MESH)
+			{
+				BeginMesh(stats);
+			}
+			else if ((id == W3D_CHUNK_ANIMATION) || (id == W3D_CHUNK_COMPRESSED_ANIMATION))
+			{
+				stats.Frames = 0;
+				stats.Flavor = -1;
+			}
+		}
+		else if (object == W3D_CHUNK_MESH)
+		{
+			AddMeshChunk(cload, stats, bytes);
+		}
+		else if ((object == W3D_CHUNK_ANIMATION) || (object == W3D_CHUNK_COMPRESSED_ANIMATION))
+		{
+			AddAnimChunk(cload, stats);
+		}
+		uint64 children = 0;
+		if (cload.Contains_Chunks() || ChunkIndexClass::Is_Container(id))
+		{
+			children = AddChunks(cload, stats, object);
+		}
+		ChunkStats &chunk = stats.Chunks[id];
+		chunk.Count++;
+		chunk.Bytes += bytes;
+		chunk.Own += bytes - children;
+		if ((cload.Cur_Chunk_Depth() == 1) && (id == W3D_CHUNK_MESH))
+		{
+			EndMesh(stats, bytes);
+		}
+		total += bytes;
+		cload.Close_Chunk();
+	}
+	return total;
+}
+
+const char *ChunkName(uint32 id)
+{
+	auto name = ChunkNames.find(id);
+	return name != ChunkNames.end() ? name->second : "unknown";
+}
+
+double Percent(uint64 bytes, uint64 total)
+{
+	return total ? 100.0 * bytes / total : 0.0;
+}
+
+double PerElement(const ChannelStats &channel)
+{
+	return channel.Elements ? (double)channel.Bytes / channel.Elements : 0.0;
+}
+
+typedef std::pair<StringClass, ChannelStats> NamedChannel;
+
+void PrintChannels(const char *title, const char *elements, const std::vector<NamedChannel> &channels)
+{
+	uint64 total = 0;
+	for (const NamedChannel &channel : channels)
+	{
+		total += channel.second.Bytes;
+	}
+	printf("\n%-32s %10s %14s %14s %12s %8s\n", title, "count", "bytes", elements, "bytes each", "bytes %");
+	for (const NamedChannel &channel : channels)
+	{
+		printf("%-32s %10llu %14llu %14llu %12.2f %7.2f%%\n", channel.first.Peek_Buffer(), channel.second.Count, channel.second.Bytes, channel.second.Elements, PerElement(channel.second), Percent(channel.second.Bytes, total));
+	}
+}
+
+void WriteChannels(FILE *file, const char *name, const char *elements, const std::vector<NamedChannel> &channels)
+{
+	fprintf(file, "  \"%s\": [\n", name);
+	for (size_t i = 0; i < channels.size(); i++)
+	{
+		const ChannelStats &channel = channels[i].second;
+		fprintf(file, "    { \"name\": \"%s\", \"count\": %llu, \"bytes\": %llu, \"%s\": %llu }%s\n", channels[i].first.Peek_Buffer(), channel.Count, channel.Bytes, elements, channel.Elements, i + 1 < channels.size() ? "," : "");
+	}
+	fprintf(file, "  ]");
+}
+
+int main(int argc, char **argv)
+{
+	const char *json = nullptr;
+	std::vector<StringClass> filenames;
+	bool missing = false;
+	int paths = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			json = argv[++i];
+			continue;
+		}
+		paths++;
+		if (!Find_Files(argv[i], "*.w3d", filenames))
+		{
+			fprintf(stderr, "unable to find %s\n", argv[i]);
+			missing = true;
+		}
+	}
+	if (!paths)
+	{
+		printf("usage: w3dstats [-j stats.json] path...\n");
+		return 2;
+	}
+	initnames();
+	auto start = std::chrono::steady_clock::now();
+	std::vector<FileStats> results(filenames.size());
+	ParallelFor((int)filenames.size(), [&](int i)
+	{
+		FileStats &stats = results[i];
+		MappedFileClass file;
+		if (!file.Open(filenames[i]))
+		{
+			return;
+		}
+		stats.Opened = true;
+		stats.FileBytes = file.Get_Size();
+		MappedChunkLoadClass cload(file.Get_Data(), file.Get_Size());
+		stats.ChunkBytes = AddChunks(cload, stats, 0);
+	});
+	FileStats total;
+	int corrupt = 0;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const FileStats &stats = results[i];
+		if (!stats.Opened)
+		{
+			fprintf(stderr, "unable to open %s\n", filenames[i].Peek_Buffer());
+			missing = true;
+			continue;
+		}
+		if (stats.StoredBytes != stats.FileBytes)
+		{
+			fprintf(stderr, "%s: only the first %llu of %llu bytes are whole chunks\n", filenames[i].Peek_Buffer(), stats.StoredBytes, stats.FileBytes);
+			corrupt++;
+		}
+		total.FileBytes += stats.FileBytes;
+		total.ChunkBytes += stats.ChunkBytes;
+		total.CompressedChunks += stats.CompressedChunks;
+		for (const auto &chunk : stats.Chunks)
+		{
+			ChunkStats &sum = total.Chunks[chunk.first];
+			sum.Count += chunk.second.Count;
+			sum.Bytes += chunk.second.Bytes;
+			sum.Own += chunk.second.Own;
+		}
+		for (int j = 0; j <= MeshChannelCount; j++)
+		{
+			total.Mesh[j].Count += stats.Mesh[j].Count;
+			total.Mesh[j].Bytes += stats.Mesh[j].Bytes;
+			total.Mesh[j].Elements += stats.Mesh[j].Elements;
+		}
+		for (const auto &channel : stats.Anim)
+		{
+			ChannelStats &sum = total.Anim[channel.first];
+			sum.Count += channel.second.Count;
+			sum.Bytes += channel.second.Bytes;
+			sum.Elements += channel.second.Elements;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<std::pair<uint32, ChunkStats>> chunks(total.Chunks.begin(), total.Chunks.end());
+	std::sort(chunks.begin(), chunks.end(), [](const std::pair<uint32, ChunkStats> &a, const std::pair<uint32, ChunkStats> &b) { return a.second.Own != b.second.Own ? a.second.Own > b.second.Own : a.first < b.first; });
+	std::vector<NamedChannel> mesh;
+	for (int i = 0; i <= MeshChannelCount; i++)
+	{
+		if (total.Mesh[i].Count)
+		{
+			mesh.push_back({ i < MeshChannelCount ? MeshChannels[i].Name : "other", total.Mesh[i] });
+		}
+	}
+	std::vector<NamedChannel> anim(total.Anim.begin(), total.Anim.end());
+	auto bigger = [](const NamedChannel &a, const NamedChannel &b) { return a.second.Bytes != b.second.Bytes ? a.second.Bytes > b.second.Bytes : strcmp(a.first, b.first) < 0; };
+	std::sort(mesh.begin(), mesh.end(), bigger);
+	std::sort(anim.begin(), anim.end(), bigger);
+
+	printf("%d files, %.1f MB (%.1f MB of chunks decompressed, %llu compressed chunks) in %.2f seconds, %d corrupt\n", (int)filenames.size(), total.FileBytes / (1024.0 * 1024.0), total.ChunkBytes / (1024.0 * 1024.0), total.CompressedChunks, seconds, corrupt);
+	printf("\n%-48s %10s %14s %14s %8s\n", "chunk", "count", "bytes", "own bytes", "own %");
+	for (const auto &chunk : chunks)
+	{
+		StringClass name;
+		name.Format("%s (%08X)", ChunkName(chunk.first), chunk.first);
+		printf("%-48s %10llu %14llu %14llu %7.2f%%\n", name.Peek_Buffer(), chunk.second.Count, chunk.second.Bytes, chunk.second.Own, Percent(chunk.second.Own, total.ChunkBytes));
+	}
+	PrintChannels("mesh channel", "elements", mesh);
+	PrintChannels("animation channel", "frames", anim);
+
+	if (json)
+	{
+		FILE *file = fopen(json, "w");
+		if (!file)
+		{
+			fprintf(stderr, "unable to write %s\n", json);
+			return 2;
+		}
+		fprintf(file, "{\n  \"files\": %d,\n  \"corrupt\": %d,\n  \"bytes\": %llu,\n  \"chunk_bytes\": %llu,\n  \"compressed_chunks\": %llu,\n", (int)filenames.size(), corrupt, total.FileBytes, total.ChunkBytes, total.CompressedChunks);
+		fprintf(file, "  \"chunks\": [\n");
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			const ChunkStats &chunk = chunks[i].second;
+			fprintf(file, "    { \"id\": %u, \"name\": \"%s\", \"count\": %llu, \"bytes\": %llu, \"own_bytes\": %llu }%s\n", chunks[i].first, ChunkName(chunks[i].first), chunk.Count, chunk.Bytes, chunk.Own, i + 1 < chunks.size() ? "," : "");
+		}
+		fprintf(file, "  ],\n");
+		WriteChannels(file, "mesh_channels", "elements", mesh);
+		fprintf(file, ",\n");
+		WriteChannels(file, "animation_channels", "frames", anim);
+		fprintf(file, "\n}\n");
+		fclose(file);
+	}
+	return missing ? 2 : 0;
+}
@@ -0,0 +1 @@
+#include "general.h"
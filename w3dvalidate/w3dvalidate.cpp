@@ -0,0 +1,114 @@
+#include "General.h"
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+#include "MappedFileClass.h"
+#include "W3DValidatorClass.h"
+#include "ParallelFor.h"
+#include "FindFiles.h"
+
+// Checks W3D files for internal consistency with W3DValidatorClass, one file per thread. Directories are searched for
+// *.w3d files including all their subdirectories. Each problem is printed as the file, the offset of the chunk it was
+// found in and what is wrong. Animations and HLODs are checked against the hierarchy they use once every file has been
+// looked at, a hierarchy that isn't in any of the files is only a warning.
+//
+// usage: w3dvalidate path...
+//
+// The exit code is 0 when nothing is wrong, 1 when there are errors and 2 when a file can't be read.
+
+struct FileResult
+{
+	bool Opened = false;
+	unsigned long Size = 0;
+	std::vector<StringClass> Errors;
+	std::vector<W3DHierarchyInfo> Hierarchies;
+	std::vector<W3DHierarchyReference> Unresolved;
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		printf("usage: w3dvalidate path...\n");
+		return 2;
+	}
+	std::vector<StringClass> filenames;
+	bool missing = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!Find_Files(argv[i], "*.w3d", filenames))
+		{
+			fprintf(stderr, "unable to find %s\n", argv[i]);
+			missing = true;
+		}
+	}
+	auto start = std::chrono::steady_clock::now();
+	std::vector<FileResult> results(filenames.size());
+	ParallelFor((int)filenames.size(), [&](int i)
+	{
+		FileResult &result = results[i];
+		MappedFileClass file;
+		if (!file.Open(filenames[i]))
+		{
+			return;
+		}
+		result.Opened = true;
+		result.Size = file.Get_Size();
+		W3DValidatorClass validator;
+		validator.Validate(file.Get_Data(), file.Get_Size());
+		result.Errors = validator.Get_Errors();
+		result.Hierarchies = validator.Get_Hierarchies();
+		result.Unresolved = validator.Get_Unresolved();
+	});
+	// NOTE: the first file (in the order they were found) with a hierarchy of a given name is the one that counts
+	std::unordered_map<StringClass, int, hash_istring, equals_istring> hierarchies;
+	for (const FileResult &result : results)
+	{
+		for (const W3DHierarchyInfo &hierarchy : result.Hierarchies)
+		{
+			hierarchies.insert({ hierarchy.Name, hierarchy.Pivots });
+		}
+	}
+	int errors = 0;
+	int warnings = 0;
+	double bytes = 0;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const FileResult &result = results[i];
+		if (!result.Opened)
+		{
+			fprintf(stderr, "unable to open %s\n", filenames[i].Peek_Buffer());
+			missing = true;
+			continue;
+		}
+		bytes += result.Size;
+		for (const StringClass &error : result.Errors)
+		{
+			printf("%s: %s\n", filenames[i].Peek_Buffer(), error.Peek_Buffer());
+			errors++;
+		}
+		for (const W3DHierarchyReference &reference : result.Unresolved)
+		{
+			auto hierarchy = hierarchies.find(reference.Hierarchy);
+			if (hierarchy == hierarchies.end())
+			{
+				printf("%s: warning: %s: hierarchy %s isn't in any of the files\n", filenames[i].Peek_Buffer(), reference.Object.Peek_Buffer(), reference.Hierarchy.Peek_Buffer());
+				warnings++;
+				continue;
+			}
+			StringClass error;
+			if (!W3DValidatorClass::Check_Reference(reference, hierarchy->second, error))
+			{
+				printf("%s: %s\n", filenames[i].Peek_Buffer(), error.Peek_Buffer());
+				errors++;
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%d files, %.1f MB in %.2f seconds (%.0f MB/s), %d errors, %d warnings\n", (int)filenames.size(), bytes / (1024 * 1024), seconds, seconds > 0 ? bytes / (1024 * 1024) / seconds : 0.0, errors, warnings);
+	if (missing)
+	{
+		return 2;
+	}
+	return errors ? 1 : 0;
+}
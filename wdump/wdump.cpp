@@ -2,7 +2,9 @@
 #include <commdlg.h>
 #include <unordered_map>
 #include <commctrl.h>
-#include "BufferedFileClass.h"
+#include "MappedFileClass.h"
+#include "ChunkIndexClass.h"
+#include "ParallelFor.h"
 #include "chunkclass.h"
 #include "w3d.h"
 #include "vector.h"
@@ -51,7 +53,7 @@ struct ChunkData
 struct ChunkDumper
 {
 	const char *name;
-	void(*function) (ChunkLoadClass &cload, ChunkData *data);
+	void(*function) (MappedChunkLoadClass &cload, ChunkData *data);
 };
 
 std::unordered_map<int, ChunkDumper> chunks;
@@ -141,7 +143,7 @@ void AddFloatArray(ChunkData *data, const char *name, float *values, int count)
 	AddString(data, name, str, c);
 }
 
-void AddVector(ChunkData *data, const char *name, W3dVectorStruct *value)
+void AddVector(ChunkData *data, const char *name, const W3dVectorStruct *value)
 {
 	char c[256];
 	sprintf(c, "%f %f %f", value->X, value->Y, value->Z);
@@ -379,19 +381,17 @@ void AddIJK16(ChunkData *data, const char *name, Vector3i16 *value)
 	AddString(data, name, c, "IJK");
 }
 
-char *ReadChunkData(ChunkLoadClass &cload)
+const char *ReadChunkData(MappedChunkLoadClass &cload)
 {
 	if (!cload.Cur_Chunk_Length())
 	{
 		return "";
 	}
-	char *c = new char[cload.Cur_Chunk_Length()];
-	cload.Read(c, cload.Cur_Chunk_Length());
-	return c;
+	return (const char *)cload.Read_Data(cload.Cur_Chunk_Length());
 }
 
 char table[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-void ParseSubchunks(ChunkLoadClass &cload, ChunkData *data)
+void ParseSubchunks(MappedChunkLoadClass &cload, ChunkData *data)
 {
 	while (cload.Open_Chunk())
 	{
@@ -406,7 +406,7 @@ void ParseSubchunks(ChunkLoadClass &cload, ChunkData *data)
 			StringClass str2;
 			str2.Format("%x", cload.Cur_Chunk_ID());
 			d->name = str2;
-			char *chunkdata = ReadChunkData(cload);
+			const char *chunkdata = ReadChunkData(cload);
 			StringClass str3;
 			for (unsigned int i = 0; i < cload.Cur_Chunk_Length(); i++)
 			{
@@ -428,10 +428,10 @@ void ParseSubchunks(ChunkLoadClass &cload, ChunkData *data)
 	}
 }
 
-#define FUNC(id) void dump##id (ChunkLoadClass &cload, ChunkData *data)
+#define FUNC(id) void dump##id (MappedChunkLoadClass &cload, ChunkData *data)
 FUNC(O_W3D_CHUNK_MATERIALS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMaterialStruct *materials = (W3dMaterialStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dMaterialStruct); i++)
 	{
@@ -451,11 +451,10 @@ FUNC(O_W3D_CHUNK_MATERIALS)
 		sprintf(c, "Material[%d].Blue", i);
 		AddInt8(data, c, materials[i].Blue);
 	}
-	delete[] chunkdata;
 }
 FUNC(O_W3D_CHUNK_MATERIALS2)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMaterial2Struct *materials = (W3dMaterial2Struct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dMaterial2Struct); i++)
 	{
@@ -481,7 +480,6 @@ FUNC(O_W3D_CHUNK_MATERIALS2)
 		sprintf(c, "Material[%d].SecondaryNumFrames", i);
 		AddInt16(data, c, materials[i].SecondaryNumFrames);
 	}
-	delete[] chunkdata;
 }
 FUNC(O_W3D_CHUNK_POV_QUADRANGLES)
 {
@@ -493,13 +491,12 @@ FUNC(O_W3D_CHUNK_POV_TRIANGLES)
 }
 FUNC(O_W3D_CHUNK_QUADRANGLES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Outdated structure", "", "string");
-	delete[] chunkdata;
 }
 FUNC(O_W3D_CHUNK_SURRENDER_TRIANGLES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dSurrenderTriangleStruct *triangles = (W3dSurrenderTriangleStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dSurrenderTriangleStruct); i++)
 	{
@@ -517,45 +514,39 @@ FUNC(O_W3D_CHUNK_SURRENDER_TRIANGLES)
 		sprintf(c, "Triangle[%d].TexCoord", i);
 		AddTexCoordArray(data, c, triangles[i].TexCoord, 3);
 	}
-	delete[] chunkdata;
 }
 FUNC(O_W3D_CHUNK_TRIANGLES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Obsolete structure", "", "string");
-	delete[] chunkdata;
 }
 FUNC(OBSOLETE_W3D_CHUNK_EMITTER_COLOR_KEYFRAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterColorKeyframeStruct *frame = (W3dEmitterColorKeyframeStruct *)chunkdata;
 	AddFloat(data, "Time", frame->Time);
 	AddRGBA(data, "Color", &frame->Color);
-	delete[] chunkdata;
 }
 FUNC(OBSOLETE_W3D_CHUNK_EMITTER_OPACITY_KEYFRAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterOpacityKeyframeStruct *frame = (W3dEmitterOpacityKeyframeStruct *)chunkdata;
 	AddFloat(data, "Time", frame->Time);
 	AddFloat(data, "Opacity", frame->Opacity);
-	delete[] chunkdata;
 }
 FUNC(OBSOLETE_W3D_CHUNK_EMITTER_SIZE_KEYFRAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterSizeKeyframeStruct *frame = (W3dEmitterSizeKeyframeStruct *)chunkdata;
 	AddFloat(data, "Time", frame->Time);
 	AddFloat(data, "Size", frame->Size);
-	delete[] chunkdata;
 }
 FUNC(OBSOLETE_W3D_CHUNK_SHADOW_NODE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelNodeStruct *node = (W3dHModelNodeStruct *)chunkdata;
 	AddString(data, "ShadowMeshName", node->RenderObjName, "string");
 	AddInt16(data, "PivotIdx", node->PivotIdx);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AABTREE)
 {
@@ -563,17 +554,15 @@ FUNC(W3D_CHUNK_AABTREE)
 }
 FUNC(W3D_CHUNK_AABTREE_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMeshAABTreeHeader *header = (W3dMeshAABTreeHeader *)chunkdata;
 	AddInt32(data, "NodeCount", header->NodeCount);
 	AddInt32(data, "PolyCount", header->PolyCount);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AABTREE_NODES)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dMeshAABTreeNode *nodes = (W3dMeshAABTreeNode *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dMeshAABTreeNode); i++)
+	ChunkSpan<W3dMeshAABTreeNode> nodes = cload.Cur_Chunk_Span<W3dMeshAABTreeNode>();
+	for (int i = 0; i < nodes.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Node[%d].Min", i);
@@ -594,11 +583,10 @@ FUNC(W3D_CHUNK_AABTREE_NODES)
 		}
 		AddInt32(data, c, nodes[i].BackOrPolyCount);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AABTREE_POLYINDICES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *indices = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -606,7 +594,6 @@ FUNC(W3D_CHUNK_AABTREE_POLYINDICES)
 		sprintf(c, "Polygon Index[%d]", i);
 		AddInt32(data, c, indices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AGGREGATE)
 {
@@ -614,23 +601,21 @@ FUNC(W3D_CHUNK_AGGREGATE)
 }
 FUNC(W3D_CHUNK_AGGREGATE_CLASS_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dAggregateMiscInfo *info = (W3dAggregateMiscInfo *)chunkdata;
 	AddInt32(data, "OriginalClassID", info->OriginalClassID);
 	AddInt32(data, "Flags", info->Flags);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AGGREGATE_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dAggregateHeaderStruct *header = (W3dAggregateHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_AGGREGATE_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dAggregateInfoStruct *info = (W3dAggregateInfoStruct *)chunkdata;
 	AddString(data, "BaseModelName", info->BaseModelName, "string");
 	AddInt32(data, "SubobjectCount", info->SubobjectCount);
@@ -643,7 +628,6 @@ FUNC(W3D_CHUNK_AGGREGATE_INFO)
 		sprintf(c, "SubObject[%u].BoneName", i);
 		AddString(data, c, subobj[i].BoneName, "string");
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_ANIMATION)
 {
@@ -653,7 +637,7 @@ FUNC(W3D_CHUNK_ANIMATION)
 const char *ChannelTypes[] = { "X Translation", "Y Translation", "Z Translation", "X Rotation", "Y Rotation", "Z Rotation", "Quaternion", "Timecoded X Translation", "Timecoded Y Translation", "Timecoded Z Translation", "Timecoded Quaternion", "Adaptive Delta X Translation", "Adaptive Delta Y Translation", "Adaptive Delta Z Translation", "Adaptive Delta Quaternion", "Vis" };
 FUNC(W3D_CHUNK_ANIMATION_CHANNEL)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dAnimChannelStruct *channel = (W3dAnimChannelStruct *)chunkdata;
 	AddInt16(data, "FirstFrame", channel->FirstFrame);
 	AddInt16(data, "LastFrame", channel->LastFrame);
@@ -679,18 +663,16 @@ FUNC(W3D_CHUNK_ANIMATION_CHANNEL)
 			AddFloat(data, str, channel->Data[j + i * channel->VectorLen]);
 		}
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_ANIMATION_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dAnimHeaderStruct *header = (W3dAnimHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddString(data, "HierarchyName", header->HierarchyName, "string");
 	AddInt32(data, "NumFrames", header->NumFrames);
 	AddInt32(data, "FrameRate", header->FrameRate);
-	delete[] chunkdata;
 }
 
 const char *BitChannelTypes[] = { "Visibility", "Timecoded Visibility" };
@@ -700,7 +682,7 @@ bool UnpackBitChannel(uint8 *data, uint32 bit)
 }
 FUNC(W3D_CHUNK_BIT_CHANNEL)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dBitChannelStruct *channel = (W3dBitChannelStruct *)chunkdata;
 	AddInt16(data, "FirstFrame", channel->FirstFrame);
 	AddInt16(data, "LastFrame", channel->LastFrame);
@@ -717,18 +699,51 @@ FUNC(W3D_CHUNK_BIT_CHANNEL)
 	}
 	AddInt16(data, "Pivot", channel->Pivot);
 	AddInt8(data, "Default Value", channel->DefaultVal);
-	for (int i = 0; i < channel->LastFrame - channel->FirstFrame; i++)
+	for (int i = 0; i <= channel->LastFrame - channel->FirstFrame; i++)
 	{
 		StringClass str;
 		str.Format("Data[%d]", i + channel->FirstFrame);
 		bool b = UnpackBitChannel(channel->Data, i);
 		AddInt8(data, str, b);
 	}
-	delete[] chunkdata;
+}
+FUNC(W3D_CHUNK_BONE_PALETTES)
+{
+	ParseSubchunks(cload, data);
+}
+FUNC(W3D_CHUNK_BONE_PALETTE_HEADER)
+{
+	const char *chunkdata = ReadChunkData(cload);
+	W3dBonePaletteHeaderStruct *header = (W3dBonePaletteHeaderStruct *)chunkdata;
+	AddInt32(data, "PaletteSize", header->PaletteSize);
+	AddInt32(data, "PaletteCount", header->PaletteCount);
+	AddInt32(data, "SplitVertexCount", header->SplitVertexCount);
+}
+FUNC(W3D_CHUNK_BONE_PALETTE)
+{
+	const char *chunkdata = ReadChunkData(cload);
+	uint16 *bones = (uint16 *)chunkdata;
+	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint16); i++)
+	{
+		char c[256];
+		sprintf(c, "Bone[%d]", i);
+		AddInt16(data, c, bones[i]);
+	}
+}
+FUNC(W3D_CHUNK_BONE_PALETTE_IDS)
+{
+	const char *chunkdata = ReadChunkData(cload);
+	uint16 *ids = (uint16 *)chunkdata;
+	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint16); i++)
+	{
+		char c[256];
+		sprintf(c, "Triangle[%d].Palette", i);
+		AddInt16(data, c, ids[i]);
+	}
 }
 FUNC(W3D_CHUNK_BOX)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dBoxStruct *box = (W3dBoxStruct *)chunkdata;
 	AddVersion(data, box->Version);
 	AddInt32(data, "Attributes", box->Attributes);
@@ -785,7 +800,6 @@ FUNC(W3D_CHUNK_BOX)
 	AddRGB(data, "Color", &box->Color);
 	AddVector(data, "Center", &box->Center);
 	AddVector(data, "Extent", &box->Extent);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_COLLECTION)
 {
@@ -793,26 +807,23 @@ FUNC(W3D_CHUNK_COLLECTION)
 }
 FUNC(W3D_CHUNK_COLLECTION_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dCollectionHeaderStruct *header = (W3dCollectionHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddInt32(data, "RenderObjectCount", header->RenderObjectCount);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_COLLECTION_OBJ_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Render Object Name", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_COLLISION_NODE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelNodeStruct *node = (W3dHModelNodeStruct *)chunkdata;
 	AddString(data, "CollisionMeshName", node->RenderObjName, "string");
 	AddInt16(data, "PivotIdx", node->PivotIdx);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DAMAGE)
 {
@@ -820,7 +831,7 @@ FUNC(W3D_CHUNK_DAMAGE)
 }
 FUNC(W3D_CHUNK_DAMAGE_COLORS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dDamageColorStruct *colors = (W3dDamageColorStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dDamageColorStruct); i++)
 	{
@@ -830,11 +841,10 @@ FUNC(W3D_CHUNK_DAMAGE_COLORS)
 		sprintf(c, "DamageColorStruct[%d].NewColor",i);
 		AddRGB(data, c, &colors[i].NewColor);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DAMAGE_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dDamageStruct *damage = (W3dDamageStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dDamageStruct); i++)
 	{
@@ -848,11 +858,10 @@ FUNC(W3D_CHUNK_DAMAGE_HEADER)
 		sprintf(c, "DamageStruct[%d].DamageIndex", i);
 		AddInt32(data, c, damage[i].DamageIndex);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DAMAGE_VERTICES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dDamageVertexStruct *vertices = (W3dDamageVertexStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dDamageVertexStruct); i++)
 	{
@@ -862,7 +871,6 @@ FUNC(W3D_CHUNK_DAMAGE_VERTICES)
 		sprintf(c, "DamageVertexStruct[%d].NewVertex", i);
 		AddInt32(data, c, vertices[i].VertexIndex);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DAZZLE)
 {
@@ -870,19 +878,17 @@ FUNC(W3D_CHUNK_DAZZLE)
 }
 FUNC(W3D_CHUNK_DAZZLE_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Dazzle Name", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DAZZLE_TYPENAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Dazzle Type Name", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DCG)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dRGBAStruct *colors = (W3dRGBAStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dRGBAStruct); i++)
 	{
@@ -890,11 +896,10 @@ FUNC(W3D_CHUNK_DCG)
 		sprintf(c, "Vertex[%d].DCG", i);
 		AddRGBA(data, c, &colors[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_DIG)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dRGBStruct *colors = (W3dRGBStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dRGBStruct); i++)
 	{
@@ -902,7 +907,6 @@ FUNC(W3D_CHUNK_DIG)
 		sprintf(c, "Vertex[%d].DIG", i);
 		AddRGB(data, c, &colors[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER)
 {
@@ -910,7 +914,7 @@ FUNC(W3D_CHUNK_EMITTER)
 }
 FUNC(W3D_CHUNK_EMITTER_BLUR_TIME_KEYFRAMES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterBlurTimeHeaderStruct *header = (W3dEmitterBlurTimeHeaderStruct *)chunkdata;
 	AddInt32(data, "KeyframeCount", header->KeyframeCount);
 	AddFloat(data, "Random", header->Random);
@@ -923,11 +927,10 @@ FUNC(W3D_CHUNK_EMITTER_BLUR_TIME_KEYFRAMES)
 		sprintf(c, "BlurTime[%u]", i);
 		AddFloat(data, c, blurtime[i].BlurTime);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_FRAME_KEYFRAMES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterFrameHeaderStruct *header = (W3dEmitterFrameHeaderStruct *)chunkdata;
 	AddInt32(data, "KeyframeCount", header->KeyframeCount);
 	AddFloat(data, "Random", header->Random);
@@ -940,19 +943,17 @@ FUNC(W3D_CHUNK_EMITTER_FRAME_KEYFRAMES)
 		sprintf(c, "Frame[%u]", i);
 		AddFloat(data, c, frame[i].Frame);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterHeaderStruct *header = (W3dEmitterHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterInfoStruct *info = (W3dEmitterInfoStruct *)chunkdata;
 	AddString(data, "Texture Name", info->TextureFilename, "string");
 	AddFloat(data, "StartSize", info->StartSize);
@@ -969,11 +970,10 @@ FUNC(W3D_CHUNK_EMITTER_INFO)
 	AddVector(data, "Acceleration", &info->Acceleration);
 	AddRGBA(data, "StartColor", &info->StartColor);
 	AddRGBA(data, "EndColor", &info->EndColor);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_INFOV2)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterInfoStructV2 *info = (W3dEmitterInfoStructV2 *)chunkdata;
 	AddInt32(data, "BurstSize", info->BurstSize);
 	AddInt32(data, "CreationVolume.ClassID", info->CreationVolume.ClassID);
@@ -988,11 +988,10 @@ FUNC(W3D_CHUNK_EMITTER_INFOV2)
 	AddFloat(data, "VelInherit", info->VelInherit);
 	AddShader(data, "Shader", &info->Shader);
 	AddInt32(data, "RenderMode", info->RenderMode);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_PROPS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterPropertyStruct *props = (W3dEmitterPropertyStruct *)chunkdata;
 	AddInt32(data, "ColorKeyframes", props->ColorKeyframes);
 	AddInt32(data, "OpacityKeyframes", props->OpacityKeyframes);
@@ -1027,11 +1026,10 @@ FUNC(W3D_CHUNK_EMITTER_PROPS)
 		sprintf(c, "Size[%u]", i);
 		AddFloat(data, c, size[i].Size);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_ROTATION_KEYFRAMES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterRotationHeaderStruct *header = (W3dEmitterRotationHeaderStruct *)chunkdata;
 	AddInt32(data, "KeyframeCount", header->KeyframeCount);
 	AddFloat(data, "Random", header->Random);
@@ -1045,21 +1043,18 @@ FUNC(W3D_CHUNK_EMITTER_ROTATION_KEYFRAMES)
 		sprintf(c, "Rotation[%u]", i);
 		AddFloat(data, c, frame[i].Rotation);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_USER_DATA)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "User Data", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_FAR_ATTENUATION)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLightAttenuationStruct *atten = (W3dLightAttenuationStruct *)chunkdata;
 	AddFloat(data, "Far Atten Start", atten->Start);
 	AddFloat(data, "Far Atten End", atten->End);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HIERARCHY)
 {
@@ -1067,13 +1062,12 @@ FUNC(W3D_CHUNK_HIERARCHY)
 }
 FUNC(W3D_CHUNK_HIERARCHY_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHierarchyStruct *header = (W3dHierarchyStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddInt32(data, "NumPivots", header->NumPivots);
 	AddVector(data, "Center", &header->Center);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HLOD)
 {
@@ -1085,13 +1079,12 @@ FUNC(W3D_CHUNK_HLOD_AGGREGATE_ARRAY)
 }
 FUNC(W3D_CHUNK_HLOD_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHLodHeaderStruct *header = (W3dHLodHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddInt32(data, "LodCount", header->LodCount);
 	AddString(data, "Name", header->Name, "string");
 	AddString(data, "HTree Name", header->HierarchyName, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HLOD_LOD_ARRAY)
 {
@@ -1099,11 +1092,10 @@ FUNC(W3D_CHUNK_HLOD_LOD_ARRAY)
 }
 FUNC(W3D_CHUNK_HLOD_SUB_OBJECT_ARRAY_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHLodArrayHeaderStruct *header = (W3dHLodArrayHeaderStruct *)chunkdata;
 	AddInt32(data, "ModelCount", header->ModelCount);
 	AddFloat(data, "MaxScreenSize", header->MaxScreenSize);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HLOD_PROXY_ARRAY)
 {
@@ -1111,11 +1103,10 @@ FUNC(W3D_CHUNK_HLOD_PROXY_ARRAY)
 }
 FUNC(W3D_CHUNK_HLOD_SUB_OBJECT)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHLodSubObjectStruct *obj = (W3dHLodSubObjectStruct *)chunkdata;
 	AddString(data, "Name", obj->Name, "string");
 	AddInt32(data, "BoneIndex", obj->BoneIndex);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HMODEL)
 {
@@ -1123,7 +1114,7 @@ FUNC(W3D_CHUNK_HMODEL)
 }
 FUNC(OBSOLETE_W3D_CHUNK_HMODEL_AUX_DATA)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelAuxDataStruct *auxdata = (W3dHModelAuxDataStruct *)chunkdata;
 	AddInt32(data, "Attributes", auxdata->Attributes);
 	AddInt32(data, "MeshCount", auxdata->MeshCount);
@@ -1133,17 +1124,15 @@ FUNC(OBSOLETE_W3D_CHUNK_HMODEL_AUX_DATA)
 	AddFloat(data, "LODMin", auxdata->LODMin);
 	AddFloat(data, "LODMax", auxdata->LODMax);
 	AddInt32Array(data, "FutureUse", auxdata->FutureUse, 32);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_HMODEL_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelHeaderStruct *header = (W3dHModelHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddString(data, "HierarchyName", header->HierarchyName, "string");
 	AddInt16(data, "NumConnections", header->NumConnections);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_LIGHT)
 {
@@ -1151,7 +1140,7 @@ FUNC(W3D_CHUNK_LIGHT)
 }
 FUNC(W3D_CHUNK_LIGHT_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLightStruct *light = (W3dLightStruct *)chunkdata;
 	int type = light->Attributes & W3D_LIGHT_ATTRIBUTE_TYPE_MASK;
 	if (type == W3D_LIGHT_ATTRIBUTE_POINT)
@@ -1188,16 +1177,14 @@ FUNC(W3D_CHUNK_LIGHT_INFO)
 	AddRGBArray(data, "Diffuse", &light->Diffuse, 1);
 	AddRGBArray(data, "Specular", &light->Specular, 1);
 	AddFloat(data, "Intensity", light->Intensity);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_LIGHT_TRANSFORM)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLightTransformStruct *transform = (W3dLightTransformStruct *)chunkdata;
 	AddFloatArray(data, "Transform", transform->Transform[0], 4);
 	AddFloatArray(data, "Transform", transform->Transform[1], 4);
 	AddFloatArray(data, "Transform", transform->Transform[2], 4);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_LIGHTSCAPE)
 {
@@ -1209,12 +1196,11 @@ FUNC(W3D_CHUNK_LIGHTSCAPE_LIGHT)
 }
 FUNC(W3D_CHUNK_LOD)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLODStruct *lod = (W3dLODStruct *)chunkdata;
 	AddString(data, "Render Object Name", lod->RenderObjName, "string");
 	AddFloat(data, "LOD Min Distance", lod->LODMin);
 	AddFloat(data, "LOD Max Distance", lod->LODMax);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_LODMODEL)
 {
@@ -1222,37 +1208,33 @@ FUNC(W3D_CHUNK_LODMODEL)
 }
 FUNC(W3D_CHUNK_LODMODEL_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLODModelHeaderStruct *header = (W3dLODModelHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddInt16(data, "NumLODs", header->NumLODs);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MAP3_FILENAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Texture Filename:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MAP3_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMap3Struct *map = (W3dMap3Struct *)chunkdata;
 	AddInt16(data, "Mapping Type", map->MappingType);
 	AddInt16(data, "Frame Count", map->FrameCount);
 	AddFloat(data, "Frame Rate", map->FrameRate);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MATERIAL_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMaterialInfoStruct *info = (W3dMaterialInfoStruct *)chunkdata;
 	AddInt32(data, "PassCount", info->PassCount);
 	AddInt32(data, "VertexMaterialCount", info->VertexMaterialCount);
 	AddInt32(data, "ShaderCount", info->ShaderCount);
 	AddInt32(data, "TextureCount", info->TextureCount);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MATERIAL_PASS)
 {
@@ -1272,7 +1254,7 @@ FUNC(W3D_CHUNK_MATERIAL3_DI_MAP)
 }
 FUNC(W3D_CHUNK_MATERIAL3_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMaterial3Struct *material = (W3dMaterial3Struct *)chunkdata;
 	AddInt32(data, "Attributes", material->Attributes);
 	if (material->Attributes & W3DMATERIAL_USE_ALPHA)
@@ -1333,13 +1315,11 @@ FUNC(W3D_CHUNK_MATERIAL3_INFO)
 	AddFloat(data, "Opacity", material->Opacity);
 	AddFloat(data, "Translucency", material->Translucency);
 	AddFloat(data, "Fog Coefficient", material->FogCoeff);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MATERIAL3_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Material Name:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MATERIAL3_SC_MAP)
 {
@@ -1359,7 +1339,7 @@ FUNC(W3D_CHUNK_MESH)
 }
 FUNC(W3D_CHUNK_MESH_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMeshHeaderStruct *header = (W3dMeshHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "MeshName", header->MeshName, "string");
@@ -1415,11 +1395,10 @@ FUNC(W3D_CHUNK_MESH_HEADER)
 	AddString(data, "HierarchyTreeName", header->HierarchyTreeName, "string");
 	AddString(data, "HierarchyModelName", header->HierarchyModelName, "string");
 	AddInt32Array(data, "FutureUse", header->FutureUse, 24);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MESH_HEADER3)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMeshHeader3Struct *header = (W3dMeshHeader3Struct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "MeshName", header->MeshName, "string");
@@ -1647,42 +1626,37 @@ FUNC(W3D_CHUNK_MESH_HEADER3)
 	AddVector(data, "Max", &header->Max);
 	AddVector(data, "SphCenter", &header->SphCenter);
 	AddFloat(data, "SphRadius", header->SphRadius);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MESH_USER_TEXT)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "UserText", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_NEAR_ATTENUATION)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dLightAttenuationStruct *atten = (W3dLightAttenuationStruct *)chunkdata;
 	AddFloat(data, "Near Atten Start", atten->Start);
 	AddFloat(data, "Near Atten End", atten->End);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_NODE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelNodeStruct *node = (W3dHModelNodeStruct *)chunkdata;
 	AddString(data, "RenderObjName", node->RenderObjName, "string");
 	AddInt16(data, "PivotIdx", node->PivotIdx);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_NULL_OBJECT)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dNullObjectStruct *obj = (W3dNullObjectStruct *)chunkdata;
 	AddVersion(data, obj->Version);
 	AddInt32(data, "Attributes", obj->Attributes);
 	AddString(data, "Name", obj->Name, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PER_FACE_TEXCOORD_IDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	Vector3i *ids = (Vector3i *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(Vector3i); i++)
 	{
@@ -1690,11 +1664,10 @@ FUNC(W3D_CHUNK_PER_FACE_TEXCOORD_IDS)
 		sprintf(c, "Face[%d] UV Indices", i);
 		AddIJK(data, c, &ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PER_TRI_MATERIALS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint16 *materials = (uint16 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint16); i++)
 	{
@@ -1702,11 +1675,10 @@ FUNC(W3D_CHUNK_PER_TRI_MATERIALS)
 		sprintf(c, "Triangle[%d].MaterialIdx", i);
 		AddInt16(data, c, materials[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PIVOT_FIXUPS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dPivotFixupStruct *pivots = (W3dPivotFixupStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dPivotFixupStruct); i++)
 	{
@@ -1717,11 +1689,10 @@ FUNC(W3D_CHUNK_PIVOT_FIXUPS)
 			AddFloatArray(data, c, pivots[i].TM[j], 3);
 		}
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PIVOTS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dPivotStruct *pivots = (W3dPivotStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dPivotStruct); i++)
 	{
@@ -1737,11 +1708,10 @@ FUNC(W3D_CHUNK_PIVOTS)
 		sprintf(c, "Pivot[%d].Rotation", i);
 		AddQuaternion(data, c, &pivots[i].Rotation);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PLACEHOLDER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dPlaceholderStruct *placeholder = (W3dPlaceholderStruct *)chunkdata;
 	AddVersion(data, placeholder->Version);
 	AddFloatArray(data, "Transform", placeholder->Transform[0], 3);
@@ -1749,19 +1719,16 @@ FUNC(W3D_CHUNK_PLACEHOLDER)
 	AddFloatArray(data, "Transform", placeholder->Transform[2], 3);
 	AddFloatArray(data, "Transform", placeholder->Transform[3], 3);
 	AddString(data, "Name", placeholder->Name, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_POINTS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *points = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> points = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < points.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Point[%d]", i);
 		AddVector(data, c, &points[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_PRELIT_LIGHTMAP_MULTI_PASS)
 {
@@ -1781,7 +1748,7 @@ FUNC(W3D_CHUNK_PRELIT_VERTEX)
 }
 FUNC(W3D_CHUNK_PS2_SHADERS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dPS2ShaderStruct *shaders = (W3dPS2ShaderStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dPS2ShaderStruct); i++)
 	{
@@ -1789,11 +1756,80 @@ FUNC(W3D_CHUNK_PS2_SHADERS)
 		sprintf(c, "shader[%d]", i);
 		AddPS2Shader(data, c, &shaders[i]);
 	}
-	delete[] chunkdata;
+}
+void DumpQuantizedUnitVectors(MappedChunkLoadClass &cload, ChunkData *data, const char *name)
+{
+	const char *chunkdata = ReadChunkData(cload);
+	sint16 *values = (sint16 *)chunkdata;
+	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / (2 * sizeof(sint16)); i++)
+	{
+		char c[256];
+		sprintf(c, "Vertex[%d].%s", i, name);
+		W3dVectorStruct v;
+		W3d_Octahedral_Decode(&values[i * 2], v);
+		AddVector(data, c, &v);
+	}
+}
+FUNC(W3D_CHUNK_QUANTIZED_BINORMALS)
+{
+	DumpQuantizedUnitVectors(cload, data, "Binormal");
+}
+FUNC(W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS)
+{
+	if (cload.Cur_Chunk_Length() < sizeof(W3dQuantizedTexCoordHeaderStruct))
+	{
+		data->unknowndata.Add("W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS too short for its header");
+		return;
+	}
+	const char *chunkdata = ReadChunkData(cload);
+	W3dQuantizedTexCoordHeaderStruct *header = (W3dQuantizedTexCoordHeaderStruct *)chunkdata;
+	uint16 *values = (uint16 *)(chunkdata + sizeof(W3dQuantizedTexCoordHeaderStruct));
+	AddTexCoord(data, "Min", &header->Min);
+	AddTexCoord(data, "Scale", &header->Scale);
+	for (unsigned int i = 0; i < (cload.Cur_Chunk_Length() - sizeof(W3dQuantizedTexCoordHeaderStruct)) / (2 * sizeof(uint16)); i++)
+	{
+		char c[256];
+		sprintf(c, "Vertex[%d].UV", i);
+		W3dTexCoordStruct uv;
+		uv.U = header->Min.U + values[i * 2] * header->Scale.U;
+		uv.V = header->Min.V + values[i * 2 + 1] * header->Scale.V;
+		AddTexCoord(data, c, &uv);
+	}
+}
+FUNC(W3D_CHUNK_QUANTIZED_TANGENTS)
+{
+	DumpQuantizedUnitVectors(cload, data, "Tangent");
+}
+FUNC(W3D_CHUNK_QUANTIZED_VERTEX_NORMALS)
+{
+	DumpQuantizedUnitVectors(cload, data, "Normal");
+}
+FUNC(W3D_CHUNK_QUANTIZED_VERTICES)
+{
+	if (cload.Cur_Chunk_Length() < sizeof(W3dQuantizedVectorHeaderStruct))
+	{
+		data->unknowndata.Add("W3D_CHUNK_QUANTIZED_VERTICES too short for its header");
+		return;
+	}
+	const char *chunkdata = ReadChunkData(cload);
+	W3dQuantizedVectorHeaderStruct *header = (W3dQuantizedVectorHeaderStruct *)chunkdata;
+	uint16 *values = (uint16 *)(chunkdata + sizeof(W3dQuantizedVectorHeaderStruct));
+	AddVector(data, "Min", &header->Min);
+	AddVector(data, "Scale", &header->Scale);
+	for (unsigned int i = 0; i < (cload.Cur_Chunk_Length() - sizeof(W3dQuantizedVectorHeaderStruct)) / (3 * sizeof(uint16)); i++)
+	{
+		char c[256];
+		sprintf(c, "Vertex[%d]", i);
+		W3dVectorStruct v;
+		v.X = header->Min.X + values[i * 3] * header->Scale.X;
+		v.Y = header->Min.Y + values[i * 3 + 1] * header->Scale.Y;
+		v.Z = header->Min.Z + values[i * 3 + 2] * header->Scale.Z;
+		AddVector(data, c, &v);
+	}
 }
 FUNC(W3D_CHUNK_SCG)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dRGBStruct *colors = (W3dRGBStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dRGBStruct); i++)
 	{
@@ -1801,11 +1837,10 @@ FUNC(W3D_CHUNK_SCG)
 		sprintf(c, "Vertex[%d].SCG", i);
 		AddRGB(data, c, &colors[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHADER_IDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *ids = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -1813,11 +1848,10 @@ FUNC(W3D_CHUNK_SHADER_IDS)
 		sprintf(c, "Face[%d] Shader Index", i);
 		AddInt32(data, c, ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHADERS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dShaderStruct *shaders = (W3dShaderStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dShaderStruct); i++)
 	{
@@ -1825,36 +1859,32 @@ FUNC(W3D_CHUNK_SHADERS)
 		sprintf(c, "shader[%d]", i);
 		AddShader(data, c, &shaders[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SKIN_NODE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dHModelNodeStruct *node = (W3dHModelNodeStruct *)chunkdata;
 	AddString(data, "SkinMeshName", node->RenderObjName, "string");
 	AddInt16(data, "PivotIdx", node->PivotIdx);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SPOT_LIGHT_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dSpotLightStruct *light = (W3dSpotLightStruct *)chunkdata;
 	AddVector(data, "SpotDirection", &light->SpotDirection);
 	AddFloat(data, "SpotAngle", light->SpotAngle);
 	AddFloat(data, "SpotExponent", light->SpotExponent);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SPOT_LIGHT_INFO_5_0)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dSpotLightStruct_v5_0 *light = (W3dSpotLightStruct_v5_0*)chunkdata;
 	AddFloat(data, "SpotOuterAngle", light->SpotOuterAngle);
 	AddFloat(data, "SpotInnerAngle", light->SpotInnerAngle);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_STAGE_TEXCOORDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTexCoordStruct *coords = (W3dTexCoordStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dTexCoordStruct); i++)
 	{
@@ -1862,23 +1892,20 @@ FUNC(W3D_CHUNK_STAGE_TEXCOORDS)
 		sprintf(c, "Vertex[%d].UV", i);
 		AddTexCoord(data, c, &coords[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SURRENDER_NORMALS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *normals = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> normals = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < normals.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "SRNormal[%d]", i);
 		AddVector(data, c, &normals[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXCOORDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTexCoordStruct *texcoords = (W3dTexCoordStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dTexCoordStruct); i++)
 	{
@@ -1886,7 +1913,6 @@ FUNC(W3D_CHUNK_TEXCOORDS)
 		sprintf(c, "TexCoord[%d]", i);
 		AddTexCoord(data, c, &texcoords[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXTURE)
 {
@@ -1894,7 +1920,7 @@ FUNC(W3D_CHUNK_TEXTURE)
 }
 FUNC(W3D_CHUNK_TEXTURE_IDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *ids = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -1902,11 +1928,10 @@ FUNC(W3D_CHUNK_TEXTURE_IDS)
 		sprintf(c, "Face[%d] Texture Index", i);
 		AddInt32(data, c, ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXTURE_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTextureInfoStruct *info = (W3dTextureInfoStruct *)chunkdata;
 	AddInt16(data, "Texture.Attributes", info->Attributes);
 	if (info->Attributes & W3DTEXTURE_PUBLISH)
@@ -2015,17 +2040,15 @@ FUNC(W3D_CHUNK_TEXTURE_INFO)
 	}
 	AddInt32(data, "Texture.FrameCount", info->FrameCount);
 	AddFloat(data, "Texture.FrameRate", info->FrameRate);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXTURE_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Texture Name:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXTURE_REPLACER_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTextureReplacerHeaderStruct *header = (W3dTextureReplacerHeaderStruct *)chunkdata;
 	AddInt32(data, "ReplacedTexturesCount", header->ReplacedTexturesCount);
 	W3dTextureReplacerStruct *replacer = (W3dTextureReplacerStruct *)(chunkdata + sizeof(W3dTextureReplacerHeaderStruct));
@@ -2049,7 +2072,6 @@ FUNC(W3D_CHUNK_TEXTURE_REPLACER_INFO)
 		AddInt32(data, "TextureParams.FrameCount", replacer[i].TextureParams.FrameCount);
 		AddFloat(data, "TextureParams.FrameRate", replacer[i].TextureParams.FrameRate);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TEXTURE_STAGE)
 {
@@ -2061,7 +2083,7 @@ FUNC(W3D_CHUNK_TEXTURES)
 }
 FUNC(W3D_CHUNK_TRANSFORM_NODE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dPlaceholderStruct *placeholder = (W3dPlaceholderStruct *)chunkdata;
 	AddVersion(data, placeholder->Version);
 	AddFloatArray(data, "Transform", placeholder->Transform[0], 3);
@@ -2069,11 +2091,10 @@ FUNC(W3D_CHUNK_TRANSFORM_NODE)
 	AddFloatArray(data, "Transform", placeholder->Transform[2], 3);
 	AddFloatArray(data, "Transform", placeholder->Transform[3], 3);
 	AddString(data, "Name", placeholder->Name, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TRIANGLES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTriStruct *triangles = (W3dTriStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dTriStruct); i++)
 	{
@@ -2087,11 +2108,10 @@ FUNC(W3D_CHUNK_TRIANGLES)
 		sprintf(c, "Triangle[%d].Dist", i);
 		AddFloat(data, c, triangles[i].Dist);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_COLORS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dRGBStruct *colors = (W3dRGBStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dRGBStruct); i++)
 	{
@@ -2099,11 +2119,10 @@ FUNC(W3D_CHUNK_VERTEX_COLORS)
 		sprintf(c, "Vertex[%d].RGB", i);
 		AddRGB(data, c, &colors[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_INFLUENCES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dVertInfStruct *vertinf = (W3dVertInfStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVertInfStruct); i++)
 	{
@@ -2117,19 +2136,16 @@ FUNC(W3D_CHUNK_VERTEX_INFLUENCES)
 		sprintf(c, "VertexInfluence[%d].Weight[1]", i);
 		AddInt16(data, c, vertinf[i].Weight[1]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MAPPER_ARGS0)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Stage0 Mapper Args:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MAPPER_ARGS1)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Stage1 Mapper Args:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MATERIAL)
 {
@@ -2137,7 +2153,7 @@ FUNC(W3D_CHUNK_VERTEX_MATERIAL)
 }
 FUNC(W3D_CHUNK_VERTEX_MATERIAL_IDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *ids = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -2145,11 +2161,10 @@ FUNC(W3D_CHUNK_VERTEX_MATERIAL_IDS)
 		sprintf(c, "Vertex[%d] Vertex Material Index", i);
 		AddInt32(data, c, ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MATERIAL_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dVertexMaterialStruct *material = (W3dVertexMaterialStruct *)chunkdata;
 	if (material->Attributes & W3DVERTMAT_USE_DEPTH_CUE)
 	{
@@ -2412,13 +2427,11 @@ FUNC(W3D_CHUNK_VERTEX_MATERIAL_INFO)
 	AddFloat(data, "Material.Shininess", material->Shininess);
 	AddFloat(data, "Material.Opacity", material->Opacity);
 	AddFloat(data, "Material.Translucency", material->Translucency);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MATERIAL_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Material Name:", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_MATERIALS)
 {
@@ -2426,19 +2439,17 @@ FUNC(W3D_CHUNK_VERTEX_MATERIALS)
 }
 FUNC(W3D_CHUNK_VERTEX_NORMALS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *normals = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> normals = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < normals.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Normal[%d]", i);
 		AddVector(data, c, &normals[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTEX_SHADE_INDICES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *indices = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -2446,23 +2457,20 @@ FUNC(W3D_CHUNK_VERTEX_SHADE_INDICES)
 		sprintf(c, "Index[%d]", i);
 		AddInt32(data, c, indices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_VERTICES)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *vertices = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> vertices = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < vertices.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Vertex[%d]", i);
 		AddVector(data, c, &vertices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_LINE_PROPERTIES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterLinePropertiesStruct *props = (W3dEmitterLinePropertiesStruct *)chunkdata;
 	AddInt32(data, "Flags", props->Flags);
 	if ((props->Flags & W3D_ELINE_MERGE_INTERSECTIONS) == W3D_ELINE_MERGE_INTERSECTIONS)
@@ -2514,66 +2522,57 @@ FUNC(W3D_CHUNK_EMITTER_LINE_PROPERTIES)
 	AddFloat(data, "TextureTileFactor", props->TextureTileFactor);
 	AddFloat(data, "UPerSec", props->UPerSec);
 	AddFloat(data, "VPerSec", props->VPerSec);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SECONDARY_VERTICES)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *vertices = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> vertices = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < vertices.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Vertex[%d]", i);
 		AddVector(data, c, &vertices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SECONDARY_VERTEX_NORMALS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *normals = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> normals = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < normals.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Normal[%d]", i);
 		AddVector(data, c, &normals[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_TANGENTS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *tangents = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> tangents = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < tangents.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Tangent[%d]", i);
 		AddVector(data, c, &tangents[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_BINORMALS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *binormals = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> binormals = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < binormals.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Binormal[%d]", i);
 		AddVector(data, c, &binormals[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_COMPRESSED_ANIMATION)
 {
 	ParseSubchunks(cload, data);
 }
 
-int flavor = ANIM_FLAVOR_TIMECODED;
+thread_local int flavor = ANIM_FLAVOR_TIMECODED;
 const char *FlavorTypes[] = { "Timecoded", "Adaptive Delta" };
 FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dCompressedAnimHeaderStruct *header = (W3dCompressedAnimHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
@@ -2592,11 +2591,10 @@ FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_HEADER)
 		AddString(data, "Flavor", "Unknown", "string");
 	}
 	flavor = header->Flavor;
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	if (flavor == ANIM_FLAVOR_TIMECODED)
 	{
 		W3dTimeCodedAnimChannelStruct *channel = (W3dTimeCodedAnimChannelStruct *)chunkdata;
@@ -2622,7 +2620,6 @@ FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL)
 			str.Format("Data[%d]", i);
 			AddInt32(data, str, channel->Data[i]);
 		}
-		delete[] chunkdata;
 	}
 	else
 	{
@@ -2650,12 +2647,11 @@ FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_CHANNEL)
 			str.Format("Data[%d]", i);
 			AddInt32(data, str, channel->Data[i]);
 		}
-		delete[] chunkdata;
 	}
 }
 FUNC(W3D_CHUNK_COMPRESSED_BIT_CHANNEL)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTimeCodedBitChannelStruct *channel = (W3dTimeCodedBitChannelStruct *)chunkdata;
 	AddInt32(data, "NumTimeCodes", channel->NumTimeCodes);
 	AddInt16(data, "Pivot", channel->Pivot);
@@ -2675,10 +2671,17 @@ FUNC(W3D_CHUNK_COMPRESSED_BIT_CHANNEL)
 	for (int i = 0; i < datalen; i++)
 	{
 		StringClass str;
-		str.Format("Data[%d]", i);
-		AddInt32(data, str, channel->Data[i]);
+		uint32 frame = channel->Data[i] & ~W3D_TIMECODED_BIT_MASK;
+		if (i + 1 < datalen)
+		{
+			str.Format("Frames[%u-%u]", frame, (channel->Data[i + 1] & ~W3D_TIMECODED_BIT_MASK) - 1);
+		}
+		else
+		{
+			str.Format("Frames[%u-]", frame);
+		}
+		AddInt8(data, str, (channel->Data[i] & W3D_TIMECODED_BIT_MASK) != 0);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MORPH_ANIMATION)
 {
@@ -2686,7 +2689,7 @@ FUNC(W3D_CHUNK_MORPH_ANIMATION)
 }
 FUNC(W3D_CHUNK_MORPHANIM_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMorphAnimHeaderStruct *header = (W3dMorphAnimHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
@@ -2694,7 +2697,6 @@ FUNC(W3D_CHUNK_MORPHANIM_HEADER)
 	AddInt32(data, "FrameCount", header->FrameCount);
 	AddFloat(data, "FrameRate", header->FrameRate);
 	AddInt32(data, "ChannelCount", header->ChannelCount);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MORPHANIM_CHANNEL)
 {
@@ -2702,13 +2704,12 @@ FUNC(W3D_CHUNK_MORPHANIM_CHANNEL)
 }
 FUNC(W3D_CHUNK_MORPHANIM_POSENAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Pose Name", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MORPHANIM_KEYDATA)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dMorphAnimKeyStruct *key = (W3dMorphAnimKeyStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dMorphAnimKeyStruct); i++)
 	{
@@ -2718,11 +2719,10 @@ FUNC(W3D_CHUNK_MORPHANIM_KEYDATA)
 		sprintf(c, "MorphKeys[%d].PoseFrame", i);
 		AddInt32(data, c, key[i].PoseFrame);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_MORPHANIM_PIVOTCHANNELDATA)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *pivot = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -2730,7 +2730,6 @@ FUNC(W3D_CHUNK_MORPHANIM_PIVOTCHANNELDATA)
 		sprintf(c, "PivotChannel[%d]", i);
 		AddInt32(data, c, pivot[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SOUNDROBJ)
 {
@@ -2738,12 +2737,11 @@ FUNC(W3D_CHUNK_SOUNDROBJ)
 }
 FUNC(W3D_CHUNK_SOUNDROBJ_HEADER)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dSoundRObjHeaderStruct *header = (W3dSoundRObjHeaderStruct *)chunkdata;
 	AddVersion(data, header->Version);
 	AddString(data, "Name", header->Name, "string");
 	AddInt32(data, "Flags", header->Flags);
-	delete[] chunkdata;
 }
 #define READ_FLOAT(id, name) \
 	case id: \
@@ -2850,7 +2848,7 @@ FUNC(W3D_CHUNK_SOUNDROBJ_DEFINITION)
 	}
 }
 
-void DoVector3Channel(ChunkLoadClass &cload, ChunkData *data, const char *name)
+void DoVector3Channel(MappedChunkLoadClass &cload, ChunkData *data, const char *name)
 {
 	int i = 0;
 	for (; cload.Open_Chunk(); cload.Close_Chunk())
@@ -2881,7 +2879,7 @@ void DoVector3Channel(ChunkLoadClass &cload, ChunkData *data, const char *name)
 	}
 }
 
-void DoVector2Channel(ChunkLoadClass &cload, ChunkData *data, const char *name)
+void DoVector2Channel(MappedChunkLoadClass &cload, ChunkData *data, const char *name)
 {
 	int i = 0;
 	for (; cload.Open_Chunk(); cload.Close_Chunk())
@@ -2910,7 +2908,7 @@ void DoVector2Channel(ChunkLoadClass &cload, ChunkData *data, const char *name)
 	}
 }
 
-void DofloatChannel(ChunkLoadClass &cload, ChunkData *data, const char *name)
+void DofloatChannel(MappedChunkLoadClass &cload, ChunkData *data, const char *name)
 {
 	int i = 0;
 	for (; cload.Open_Chunk(); cload.Close_Chunk())
@@ -2937,7 +2935,7 @@ void DofloatChannel(ChunkLoadClass &cload, ChunkData *data, const char *name)
 	}
 }
 
-void DoAlphaVectorStructChannel(ChunkLoadClass &cload, ChunkData *data, const char *name)
+void DoAlphaVectorStructChannel(MappedChunkLoadClass &cload, ChunkData *data, const char *name)
 {
 	int i = 0;
 	for (; cload.Open_Chunk(); cload.Close_Chunk())
@@ -3107,9 +3105,8 @@ FUNC(W3D_CHUNK_SHDMESH)
 }
 FUNC(W3D_CHUNK_SHDMESH_NAME)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "Name", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH)
 {
@@ -3121,38 +3118,33 @@ FUNC(W3D_CHUNK_SHDSUBMESH_SHADER)
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_SHADER_TYPE)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *type = (uint32 *)chunkdata;
 	AddInt32(data, "Shader Type", *type);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_VERTICES)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *vertices = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> vertices = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < vertices.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Vertex[%d]", i);
 		AddVector(data, c, &vertices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_VERTEX_NORMALS)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *normals = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> normals = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < normals.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Normal[%d]", i);
 		AddVector(data, c, &normals[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_TRIANGLES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	Vector3i16 *ids = (Vector3i16 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(Vector3i16); i++)
 	{
@@ -3160,11 +3152,10 @@ FUNC(W3D_CHUNK_SHDSUBMESH_TRIANGLES)
 		sprintf(c, "Triangle[%d]", i);
 		AddIJK16(data, c, &ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_VERTEX_SHADE_INDICES)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *indices = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -3172,11 +3163,10 @@ FUNC(W3D_CHUNK_SHDSUBMESH_VERTEX_SHADE_INDICES)
 		sprintf(c, "Index[%d]", i);
 		AddInt32(data, c, indices[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_UV0)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTexCoordStruct *coords = (W3dTexCoordStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dTexCoordStruct); i++)
 	{
@@ -3184,11 +3174,10 @@ FUNC(W3D_CHUNK_SHDSUBMESH_UV0)
 		sprintf(c, "UV0[%d]", i);
 		AddTexCoord(data, c, &coords[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_UV1)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dTexCoordStruct *coords = (W3dTexCoordStruct *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dTexCoordStruct); i++)
 	{
@@ -3196,61 +3185,52 @@ FUNC(W3D_CHUNK_SHDSUBMESH_UV1)
 		sprintf(c, "UV1[%d]", i);
 		AddTexCoord(data, c, &coords[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_S)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *tangents = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> tangents = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < tangents.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Tangent Basis S[%d]", i);
 		AddVector(data, c, &tangents[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_T)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *tangents = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> tangents = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < tangents.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Tangent Basis T[%d]", i);
 		AddVector(data, c, &tangents[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDSUBMESH_TANGENT_BASIS_SXT)
 {
-	char *chunkdata = ReadChunkData(cload);
-	W3dVectorStruct *tangents = (W3dVectorStruct *)chunkdata;
-	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(W3dVectorStruct); i++)
+	ChunkSpan<W3dVectorStruct> tangents = cload.Cur_Chunk_Span<W3dVectorStruct>();
+	for (int i = 0; i < tangents.Size(); i++)
 	{
 		char c[256];
 		sprintf(c, "Tangent Basis SXT[%d]", i);
 		AddVector(data, c, &tangents[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_EMITTER_EXTRA_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dEmitterExtraInfoStruct *info = (W3dEmitterExtraInfoStruct *)chunkdata;
 	AddFloat(data, "FutureStartTime", info->FutureStartTime);
 	AddInt8(data, "unk1", info->unk1);
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_SHDMESH_USER_TEXT)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	AddString(data, "UserText", chunkdata, "string");
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_FXSHADER_IDS)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 *ids = (uint32 *)chunkdata;
 	for (unsigned int i = 0; i < cload.Cur_Chunk_Length() / sizeof(uint32); i++)
 	{
@@ -3258,7 +3238,6 @@ FUNC(W3D_CHUNK_FXSHADER_IDS)
 		sprintf(c, "Face[%d] FX Shader Index", i);
 		AddInt32(data, c, ids[i]);
 	}
-	delete[] chunkdata;
 }
 FUNC(W3D_CHUNK_FX_SHADERS)
 {
@@ -3270,18 +3249,17 @@ FUNC(W3D_CHUNK_FX_SHADER)
 }
 FUNC(W3D_CHUNK_FX_SHADER_INFO)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint8 *version = (uint8 *)chunkdata;
 	AddInt8(data, "Version", *version);
 	W3dFXShaderStruct *shader = (W3dFXShaderStruct *)(chunkdata + 1);
 	AddString(data, "ShaderName", shader->shadername, "string");
 	AddInt8(data, "Technique", shader->technique);
-	delete[] chunkdata;
 }
 const char *Types[] = { "Texture", "Float", "Vector2" ,"Vector3", "Vector4", "Int", "Bool" };
 FUNC(W3D_CHUNK_FX_SHADER_CONSTANT)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	uint32 type = *(uint32 *)chunkdata;
 	uint32 strlen = *(uint32 *)(chunkdata + 4);
 	char *constantname = (char *)(chunkdata + 4 + 4);
@@ -3315,12 +3293,11 @@ FUNC(W3D_CHUNK_FX_SHADER_CONSTANT)
 		data->unknowndata.Add(str);
 		AddString(data, "Unknown", "Unknown", "string");
 	}
-	delete[] chunkdata;
 }
 const char *NewFlavorTypes[] = { "Timecoded", "Adaptive Delta 4", "Adaptive Delta 8" };
 FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_MOTION_CHANNEL)
 {
-	char *chunkdata = ReadChunkData(cload);
+	const char *chunkdata = ReadChunkData(cload);
 	W3dCompressedMotionChannelStruct *channel = (W3dCompressedMotionChannelStruct *)chunkdata;
 	if (channel->Flavor < ANIM_FLAVOR_NEW_VALID)
 	{
@@ -3391,7 +3368,6 @@ FUNC(W3D_CHUNK_COMPRESSED_ANIMATION_MOTION_CHANNEL)
 			AddInt32(data, str, values[i]);
 		}
 	}
-	delete[] chunkdata;
 }
 
 #define CHUNK(id) \
@@ -3427,6 +3403,10 @@ void initmap()
 	CHUNK(W3D_CHUNK_ANIMATION_CHANNEL);
 	CHUNK(W3D_CHUNK_ANIMATION_HEADER);
 	CHUNK(W3D_CHUNK_BIT_CHANNEL);
+	CHUNK(W3D_CHUNK_BONE_PALETTES);
+	CHUNK(W3D_CHUNK_BONE_PALETTE_HEADER);
+	CHUNK(W3D_CHUNK_BONE_PALETTE);
+	CHUNK(W3D_CHUNK_BONE_PALETTE_IDS);
 	CHUNK(W3D_CHUNK_BOX);
 	CHUNK(W3D_CHUNK_COLLECTION);
 	CHUNK(W3D_CHUNK_COLLECTION_HEADER);
@@ -3501,6 +3481,11 @@ void initmap()
 	CHUNK(W3D_CHUNK_PRELIT_UNLIT);
 	CHUNK(W3D_CHUNK_PRELIT_VERTEX);
 	CHUNK(W3D_CHUNK_PS2_SHADERS);
+	CHUNK(W3D_CHUNK_QUANTIZED_BINORMALS);
+	CHUNK(W3D_CHUNK_QUANTIZED_STAGE_TEXCOORDS);
+	CHUNK(W3D_CHUNK_QUANTIZED_TANGENTS);
+	CHUNK(W3D_CHUNK_QUANTIZED_VERTEX_NORMALS);
+	CHUNK(W3D_CHUNK_QUANTIZED_VERTICES);
 	CHUNK(W3D_CHUNK_SCG);
 	CHUNK(W3D_CHUNK_SHADER_IDS);
 	CHUNK(W3D_CHUNK_SHADERS);
@@ -3693,6 +3678,49 @@ void AddItems(ChunkData *data, HTREEITEM item)
 	}
 }
 
+// Top level chunks don't depend on each other, so find them all from their headers and parse each one on its own thread.
+// The results go into data in file order, the same as ParseSubchunks on the whole file would give.
+void ParseFile(const unsigned char *file, unsigned long size, ChunkData *data)
+{
+	std::vector<unsigned long> offsets;
+	std::vector<unsigned long> sizes;
+	unsigned long pos = 0;
+	while (size - pos >= sizeof(ChunkHeader))
+	{
+		ChunkHeader header;
+		memcpy(&header, file + pos, sizeof(header));
+		unsigned long length = (header.ChunkSize & 0x7FFFFFFF) + sizeof(header);
+		if (length > size - pos)
+		{
+			break;
+		}
+		offsets.push_back(pos);
+		sizes.push_back(length);
+		pos += length;
+	}
+	std::vector<ChunkData *> parts(offsets.size());
+	ParallelFor((int)offsets.size(), [&](int i)
+	{
+		MappedChunkLoadClass cload(file + offsets[i], sizes[i]);
+		parts[i] = new ChunkData;
+		flavor = ANIM_FLAVOR_TIMECODED;
+		ParseSubchunks(cload, parts[i]);
+	});
+	for (ChunkData *part : parts)
+	{
+		for (int i = 0; i < part->subchunks.Count(); i++)
+		{
+			data->subchunks.Add(part->subchunks[i]);
+		}
+		for (int i = 0; i < part->unknowndata.Count(); i++)
+		{
+			data->unknowndata.Add(part->unknowndata[i]);
+		}
+		part->subchunks.Delete_All();
+		delete part;
+	}
+}
+
 ChunkData *master = nullptr;
 LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
@@ -3722,15 +3750,13 @@ LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPar
 				{
 					TreeView_SetItemState(treewnd, TreeView_GetSelection(treewnd), 0, TVIS_SELECTED);
 					TreeView_DeleteAllItems(treewnd);
-					BufferedFileClass file(fname);
-					file.Open(1);
-					ChunkLoadClass cload(&file);
+					MappedFileClass file(fname);
 					if (master)
 					{
 						delete master;
 					}
 					master = new ChunkData;
-					ParseSubchunks(cload, master);
+					ParseFile(file.Get_Data(), file.Get_Size(), master);
 					for (int i = 0; i < master->subchunks.Count(); i++)
 					{
 						AddItems(master->subchunks[i], TVI_ROOT);
@@ -3796,11 +3822,32 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
 	initmap();
 	if (__argc > 1)
 	{
-		BufferedFileClass file(__argv[1]);
-		file.Open(1);
-		ChunkLoadClass cload(&file);
+		MappedFileClass file(__argv[1]);
 		master = new ChunkData;
-		ParseSubchunks(cload, master);
+		if (__argc > 2)
+		{
+			// NOTE: only dump the named object, the chunk index finds it without parsing the rest of the file
+			ChunkIndexClass index;
+			index.Load_Or_Build(__argv[1], file.Get_Data(), file.Get_Size());
+			int object = index.Find_Name(__argv[2]);
+			if (object < 0)
+			{
+				delete master;
+				return 1;
+			}
+			// NOTE: an object inside a compressed chunk can only be reached by decompressing the whole top level chunk
+			if (index.Is_Compressed(object))
+			{
+				object = index.Get_Top_Level(object);
+			}
+			const ChunkIndexEntry &entry = index.Get(object);
+			MappedChunkLoadClass cload(file.Get_Data() + entry.Offset, entry.Stored);
+			ParseSubchunks(cload, master);
+		}
+		else
+		{
+			ParseFile(file.Get_Data(), file.Get_Size(), master);
+		}
 		StringClass of = __argv[1];
 		of += ".txt";
 		StringClass uf = __argv[1];